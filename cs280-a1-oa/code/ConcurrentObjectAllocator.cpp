@@ -0,0 +1,551 @@
+/******************************************************************************/
+/*!
+\file   ConcurrentObjectAllocator.cpp
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the implementation for the Concurrent Object Allocator.
+*/
+/******************************************************************************/
+#include "ConcurrentObjectAllocator.h"
+#include <unordered_map>
+#include <utility> //<! std::swap
+
+namespace
+{
+  /*!
+    The allocators alive, by id. A thread that exits hands its caches back
+    under the lock, so an allocator can't be destroyed in the meantime.
+  */
+  struct Registry
+  {
+    std::mutex Lock;                                                     //!< Guards Live
+    std::unordered_map<unsigned long, ConcurrentObjectAllocator *> Live; //!< The allocators alive
+  };
+
+  //! The registry, never destroyed, since threads may exit after static destruction
+  Registry &Allocators()
+  {
+    static Registry *registry = new Registry;
+    return *registry;
+  }
+
+  constexpr size_t MAX_FULL_MAGAZINES = 16; //!< Full magazines kept in the depot before flushing to the back-end
+
+  std::atomic<unsigned long> NextAllocatorId{1}; //!< Ids are never reused, so stale slots never match
+
+  //! The cache used most recently by this thread (Owner, then Cache)
+  thread_local std::pair<unsigned long, void *> LastCache = {0, nullptr};
+
+  /*!
+    Adds to a counter that only the calling thread writes to. A plain load
+    and store is enough and avoids a locked instruction on the fast path.
+  */
+  inline void Bump(std::atomic<unsigned> &counter, int delta)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+  }
+}
+
+thread_local ConcurrentObjectAllocator::ThreadExit ConcurrentObjectAllocator::Exit_;
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor of a Concurrent Object Allocator.
+
+\par ObjectSize The size of the object that this allocator stores.
+\par config A client specified Allocator configuration
+\par MagazineSize The number of blocks each per-thread magazine holds.
+*/
+/******************************************************************************/
+ConcurrentObjectAllocator::ConcurrentObjectAllocator(size_t ObjectSize, const OAConfig &config, unsigned MagazineSize)
+    : Backend_{ObjectSize, config}, MagazineSize_{MagazineSize ? MagazineSize : 1},
+      Id_{NextAllocatorId.fetch_add(1)}, Caches_{nullptr}, MagazineCount_{0}, Allocations_{0},
+      Deallocations_{0}, MostObjects_{0}
+{
+  UseMagazines_ = !config.UseCPPMemManager_ && !config.DebugOn_ &&
+                  config.HBlockInfo_.type_ == OAConfig::hbNone;
+
+  if (UseMagazines_)
+  {
+    Registry &registry = Allocators();
+    try
+    {
+      std::lock_guard<std::mutex> lock(registry.Lock);
+      registry.Live[Id_] = this;
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "ConcurrentObjectAllocator: No system memory available!");
+    }
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor of a Concurrent Object Allocator. Blocks still held
+  in magazines go away together with the pages of the back-end. Threads
+  that exit from now on leave the caches they had of it alone.
+*/
+/******************************************************************************/
+ConcurrentObjectAllocator::~ConcurrentObjectAllocator()
+{
+  if (UseMagazines_)
+  {
+    Registry &registry = Allocators();
+    std::lock_guard<std::mutex> lock(registry.Lock);
+    registry.Live.erase(Id_);
+  }
+
+  while (Caches_)
+  {
+    ThreadCache *next = Caches_->Next;
+    DeleteMagazine(Caches_->Loaded);
+    DeleteMagazine(Caches_->Previous);
+    delete Caches_;
+    Caches_ = next;
+  }
+
+  for (Magazine *magazine : FullMagazines_)
+    DeleteMagazine(magazine);
+  for (Magazine *magazine : EmptyMagazines_)
+    DeleteMagazine(magazine);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function provides block of memory to store an object. It only locks
+  when both of the calling thread's magazines are empty.
+
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory.
+*/
+/******************************************************************************/
+void *ConcurrentObjectAllocator::Allocate(const char *label)
+{
+  if (!UseMagazines_)
+  {
+    std::lock_guard<std::mutex> lock(DepotLock_);
+    return Backend_.Allocate(label);
+  }
+
+  ThreadCache *cache = GetThreadCache();
+
+  if (cache->Loaded->Rounds == 0)
+  {
+    if (cache->Previous->Rounds)
+    {
+      std::swap(cache->Loaded, cache->Previous);
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock(DepotLock_);
+
+      if (!FullMagazines_.empty())
+      {
+        EmptyMagazines_.push_back(cache->Previous);
+        cache->Previous = cache->Loaded;
+        cache->Loaded = FullMagazines_.back();
+        FullMagazines_.pop_back();
+      }
+      else
+      {
+        FillMagazine(cache->Loaded);
+      }
+      cache->Cached.store(cache->Loaded->Rounds + cache->Previous->Rounds, std::memory_order_relaxed);
+    }
+  }
+
+  void *object = cache->Loaded->Objects[--cache->Loaded->Rounds];
+  Bump(cache->Cached, -1);
+  Bump(cache->Allocations, 1);
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees block of memory used by an object. It only locks when
+  both of the calling thread's magazines are full. It never fails for lack
+  of memory (e.g. in a thread whose first call is a free): the object goes
+  straight to the back-end when the thread has no cache and none can be
+  made, and a full magazine is emptied into the back-end when there is no
+  room for it in the depot.
+
+\par Object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::Free(void *Object)
+{
+  if (!UseMagazines_)
+  {
+    std::lock_guard<std::mutex> lock(DepotLock_);
+    Backend_.Free(Object);
+    return;
+  }
+
+  ThreadCache *cache = nullptr;
+  try
+  {
+    cache = GetThreadCache();
+  }
+  catch (const OAException &)
+  {
+    std::lock_guard<std::mutex> lock(DepotLock_);
+    Backend_.Free(Object);
+    ++Deallocations_;
+    return;
+  }
+
+  if (cache->Loaded->Rounds == MagazineSize_)
+  {
+    if (cache->Previous->Rounds == 0)
+    {
+      std::swap(cache->Loaded, cache->Previous);
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock(DepotLock_);
+
+      Magazine *empty = nullptr;
+      if (FullMagazines_.size() < MAX_FULL_MAGAZINES)
+      {
+        if (EmptyMagazines_.empty())
+        {
+          try
+          {
+            empty = NewMagazine();
+          }
+          catch (std::bad_alloc &)
+          {
+            // No new magazine: the full one is emptied below instead
+          }
+        }
+        else
+        {
+          empty = EmptyMagazines_.back();
+          EmptyMagazines_.pop_back();
+        }
+      }
+
+      if (empty)
+        FullMagazines_.push_back(cache->Previous);
+      else
+      {
+        DrainMagazine(cache->Previous);
+        empty = cache->Previous;
+      }
+
+      cache->Previous = cache->Loaded;
+      cache->Loaded = empty;
+      cache->Cached.store(cache->Loaded->Rounds + cache->Previous->Rounds, std::memory_order_relaxed);
+    }
+  }
+
+  cache->Loaded->Objects[cache->Loaded->Rounds++] = Object;
+  Bump(cache->Cached, 1);
+  Bump(cache->Deallocations, 1);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns every block in the calling thread's magazines to the
+  back-end, so that they can be reused by other threads or released by the
+  back-end. It is done for every thread when it exits.
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::Flush()
+{
+  if (!UseMagazines_)
+    return;
+
+  ThreadCache *cache = GetThreadCache();
+
+  std::lock_guard<std::mutex> lock(DepotLock_);
+  DrainMagazine(cache->Loaded);
+  DrainMagazine(cache->Previous);
+  cache->Cached.store(0, std::memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the configuration of the back-end allocator.
+
+\return A copy of the configuration.
+*/
+/******************************************************************************/
+OAConfig ConcurrentObjectAllocator::GetConfig() const
+{
+  std::lock_guard<std::mutex> lock(DepotLock_);
+  return Backend_.GetConfig();
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function combines the statistics of the back-end with the blocks
+  held in magazines and the per-thread counters (and those of the threads
+  that exited). Blocks in magazines count as free objects. MostObjects_ is the highest in-use count seen by a call
+  to this function.
+
+\return The combined statistics.
+*/
+/******************************************************************************/
+OAStats ConcurrentObjectAllocator::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(DepotLock_);
+  OAStats stats = Backend_.GetStats();
+
+  if (!UseMagazines_)
+    return stats;
+
+  unsigned cached = 0;
+  unsigned allocations = Allocations_;
+  unsigned deallocations = Deallocations_;
+
+  for (const Magazine *magazine : FullMagazines_)
+    cached += magazine->Rounds;
+
+  for (const ThreadCache *cache = Caches_; cache; cache = cache->Next)
+  {
+    cached += cache->Cached.load(std::memory_order_relaxed);
+    allocations += cache->Allocations.load(std::memory_order_relaxed);
+    deallocations += cache->Deallocations.load(std::memory_order_relaxed);
+  }
+
+  stats.FreeObjects_ += cached;
+  stats.ObjectsInUse_ -= cached;
+  stats.Allocations_ = allocations;
+  stats.Deallocations_ = deallocations;
+
+  if (stats.ObjectsInUse_ > MostObjects_)
+    MostObjects_ = stats.ObjectsInUse_;
+  stats.MostObjects_ = MostObjects_;
+
+  return stats;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the calling thread's cache for this allocator, and
+  creates it on the first call from a thread, with magazines left in the
+  depot by threads that exited when there are any.
+
+\return The calling thread's cache.
+*/
+/******************************************************************************/
+ConcurrentObjectAllocator::ThreadCache *ConcurrentObjectAllocator::GetThreadCache()
+{
+  if (LastCache.first == Id_)
+    return static_cast<ThreadCache *>(LastCache.second);
+
+  for (const CacheSlot &slot : Exit_.Slots)
+  {
+    if (slot.Owner == Id_)
+    {
+      LastCache = {slot.Owner, slot.Cache};
+      return static_cast<ThreadCache *>(slot.Cache);
+    }
+  }
+
+  ThreadCache *cache = nullptr;
+  try
+  {
+    Exit_.Slots.reserve(Exit_.Slots.size() + 1);
+
+    std::lock_guard<std::mutex> lock(DepotLock_);
+    cache = new ThreadCache{nullptr, nullptr, {0}, {0}, {0}, Caches_};
+    try
+    {
+      for (Magazine **magazine : {&cache->Loaded, &cache->Previous})
+      {
+        if (EmptyMagazines_.empty())
+          *magazine = NewMagazine();
+        else
+        {
+          *magazine = EmptyMagazines_.back();
+          EmptyMagazines_.pop_back();
+        }
+      }
+    }
+    catch (...)
+    {
+      if (cache->Loaded)
+        EmptyMagazines_.push_back(cache->Loaded);
+      delete cache;
+      throw;
+    }
+    Caches_ = cache;
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "GetThreadCache: No system memory available!");
+  }
+
+  LastCache = {Id_, cache};
+  Exit_.Slots.push_back(CacheSlot{Id_, cache});
+
+  return cache;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes back the cache of a thread that exited: the blocks of
+  its magazines go back to the back-end, the magazines go to the depot for
+  the next thread, and its counters are added to those of exited threads.
+
+\par cache The cache of the thread, which no other thread uses.
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::ReleaseThreadCache(ThreadCache *cache)
+{
+  std::lock_guard<std::mutex> lock(DepotLock_);
+
+  ThreadCache **link = &Caches_;
+  while (*link != cache)
+    link = &(*link)->Next;
+  *link = cache->Next;
+
+  // the depot has room for every magazine, so this never allocates
+  for (Magazine *magazine : {cache->Loaded, cache->Previous})
+  {
+    DrainMagazine(magazine);
+    EmptyMagazines_.push_back(magazine);
+  }
+
+  Allocations_ += cache->Allocations.load(std::memory_order_relaxed);
+  Deallocations_ += cache->Deallocations.load(std::memory_order_relaxed);
+  delete cache;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor of the caches of a thread, run when the thread
+  exits. Each cache whose allocator is still alive is handed back to it.
+*/
+/******************************************************************************/
+ConcurrentObjectAllocator::ThreadExit::~ThreadExit()
+{
+  if (Slots.empty())
+    return;
+
+  Registry &registry = Allocators();
+  std::lock_guard<std::mutex> lock(registry.Lock);
+  for (const CacheSlot &slot : Slots)
+  {
+    auto allocator = registry.Live.find(slot.Owner);
+    if (allocator != registry.Live.end())
+      allocator->second->ReleaseThreadCache(static_cast<ThreadCache *>(slot.Cache));
+  }
+  LastCache = {0, nullptr};
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function creates an empty magazine. The depot vectors are grown to
+  hold every magazine at the same time, so moving magazines into the depot
+  never allocates. Must be called with the depot lock held.
+
+\return The new magazine.
+*/
+/******************************************************************************/
+ConcurrentObjectAllocator::Magazine *ConcurrentObjectAllocator::NewMagazine()
+{
+  Magazine *magazine = new Magazine{0, nullptr};
+  try
+  {
+    magazine->Objects = new void *[MagazineSize_];
+    FullMagazines_.reserve(MagazineCount_ + 1);
+    EmptyMagazines_.reserve(MagazineCount_ + 1);
+  }
+  catch (std::bad_alloc &)
+  {
+    DeleteMagazine(magazine);
+    throw;
+  }
+  ++MagazineCount_;
+  return magazine;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function destroys a magazine. The blocks it holds are not freed.
+
+\par magazine The magazine to destroy (may be null).
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::DeleteMagazine(Magazine *magazine)
+{
+  if (!magazine)
+    return;
+
+  delete[] magazine->Objects;
+  delete magazine;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function fills an empty magazine from the back-end with one batch. A
+  partly filled magazine is returned when the back-end cannot provide the
+  whole batch. Must be called with the depot lock held.
+
+\par magazine The magazine to fill.
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::FillMagazine(Magazine *magazine)
+{
+  try
+  {
+    Backend_.AllocateBatch(MagazineSize_ - magazine->Rounds, magazine->Objects + magazine->Rounds);
+    magazine->Rounds = MagazineSize_;
+    return;
+  }
+  catch (const OAException &)
+  {
+  }
+
+  while (magazine->Rounds < MagazineSize_)
+  {
+    try
+    {
+      magazine->Objects[magazine->Rounds] = Backend_.Allocate();
+      ++magazine->Rounds;
+    }
+    catch (const OAException &)
+    {
+      if (magazine->Rounds == 0)
+        throw;
+      break;
+    }
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns every block in a magazine to the back-end with one
+  batch. Must be called with the depot lock held.
+
+\par magazine The magazine to empty.
+*/
+/******************************************************************************/
+void ConcurrentObjectAllocator::DrainMagazine(Magazine *magazine)
+{
+  Backend_.FreeBatch(magazine->Objects, magazine->Rounds);
+  magazine->Rounds = 0;
+}
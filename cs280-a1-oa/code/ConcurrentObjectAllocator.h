@@ -0,0 +1,144 @@
+/******************************************************************************/
+/*!
+\file   ConcurrentObjectAllocator.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the declaration for the Concurrent Object Allocator, a
+  thread-safe front-end that puts per-thread magazines of free blocks in
+  front of an ObjectAllocator.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef CONCURRENTOBJECTALLOCATORH
+#define CONCURRENTOBJECTALLOCATORH
+//---------------------------------------------------------------------------
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "ObjectAllocator.h"
+
+// If the client doesn't specify it:
+static const unsigned DEFAULT_MAGAZINE_SIZE = 64;
+
+/*!
+  Thread-safe front-end for an ObjectAllocator.
+
+  Every thread that uses the allocator gets two magazines (small stacks of
+  free blocks). Allocate and Free only touch the calling thread's magazines,
+  so they take no lock while a magazine has room. When both magazines are
+  empty (or full), a whole magazine is exchanged with the shared depot under
+  a lock, and the depot refills from (or flushes to) the ObjectAllocator in
+  batches.
+
+  Blocks sitting in magazines are free as far as the client is concerned,
+  but in use as far as the ObjectAllocator is concerned. GetStats() combines
+  both views on demand. When a thread exits, its magazines are emptied into
+  the ObjectAllocator and its cache is freed, so threads that come and go
+  leave nothing behind.
+
+  Magazines only make sense when blocks carry no per-allocation state, so
+  allocators with debugging, header blocks or the C++ memory manager enabled
+  forward every call to the ObjectAllocator under the lock instead.
+*/
+class ConcurrentObjectAllocator
+{
+public:
+  // Creates the back-end ObjectAllocator per the specified values
+  // Throws an exception if the construction fails. (Memory allocation problem)
+  ConcurrentObjectAllocator(size_t ObjectSize, const OAConfig &config,
+                            unsigned MagazineSize = DEFAULT_MAGAZINE_SIZE);
+
+  // Destroys the allocator and every magazine (never throws)
+  ~ConcurrentObjectAllocator();
+
+  // Take an object from the calling thread's magazine (simulates new)
+  // Throws an exception if the object can't be allocated. (Memory allocation problem)
+  void *Allocate(const char *label = 0);
+
+  // Returns an object to the calling thread's magazine (simulates delete)
+  // Throws an exception if the the object can't be freed. (Invalid object)
+  // Never throws for lack of memory: the object goes to the ObjectAllocator instead.
+  void Free(void *Object);
+
+  // Returns the calling thread's magazines to the ObjectAllocator (done for it when it exits)
+  void Flush();
+
+  OAConfig GetConfig() const; // returns the configuration parameters
+  OAStats GetStats() const;   // returns the statistics, combined over every thread
+
+  // Prevent copy construction and assignment
+  ConcurrentObjectAllocator(const ConcurrentObjectAllocator &oa) = delete;            //!< Do not implement!
+  ConcurrentObjectAllocator &operator=(const ConcurrentObjectAllocator &oa) = delete; //!< Do not implement!
+
+private:
+  /*!
+    A fixed-capacity stack of free blocks
+  */
+  struct Magazine
+  {
+    unsigned Rounds; //!< Number of blocks in the magazine
+    void **Objects;  //!< The blocks
+  };
+
+  /*!
+    Remembers which cache the current thread uses for one allocator
+  */
+  struct CacheSlot
+  {
+    unsigned long Owner; //!< Id of the allocator
+    void *Cache;         //!< The thread's cache for that allocator
+  };
+
+  /*!
+    Every cache of one thread. Its destructor runs when the thread exits and
+    hands the caches of the allocators still alive back to them.
+  */
+  struct ThreadExit
+  {
+    std::vector<CacheSlot> Slots; //!< Every cache of this thread
+    ~ThreadExit();
+  };
+
+  /*!
+    The magazines and counters owned by one thread. Only the owning thread
+    writes to it; the counters are atomic so GetStats() can read them.
+  */
+  struct ThreadCache
+  {
+    Magazine *Loaded;                      //!< Magazine used first
+    Magazine *Previous;                    //!< Magazine used when the loaded one runs out
+    std::atomic<unsigned> Cached;          //!< Blocks held in both magazines
+    std::atomic<unsigned> Allocations;     //!< Allocations made by the thread
+    std::atomic<unsigned> Deallocations;   //!< Deallocations made by the thread
+    ThreadCache *Next;                     //!< Next cache of this allocator
+  };
+
+  ObjectAllocator Backend_;               //!< Where the blocks come from
+  unsigned MagazineSize_;                 //!< Capacity of each magazine
+  bool UseMagazines_;                     //!< false: every call goes to the back-end
+  unsigned long Id_;                      //!< Identifies this allocator in thread-local storage
+  mutable std::mutex DepotLock_;          //!< Guards everything below and the back-end
+  std::vector<Magazine *> FullMagazines_;  //!< Depot of full magazines
+  std::vector<Magazine *> EmptyMagazines_; //!< Depot of empty magazines
+  ThreadCache *Caches_;                   //!< Every thread cache of this allocator
+  unsigned MagazineCount_;                //!< Number of magazines created
+  unsigned Allocations_;                  //!< Allocations of threads that exited
+  unsigned Deallocations_;                //!< Deallocations of exited threads, or not made through a cache
+  mutable unsigned MostObjects_;          //!< Highest in-use count seen by GetStats()
+
+  static thread_local ThreadExit Exit_;   //!< The caches of the calling thread
+
+  ThreadCache *GetThreadCache();               //!< Finds or creates the calling thread's cache
+  void ReleaseThreadCache(ThreadCache *cache); //!< Empties and frees the cache of a thread that exited
+  Magazine *NewMagazine();                     //!< Creates an empty magazine
+  void DeleteMagazine(Magazine *magazine);     //!< Destroys a magazine
+  void FillMagazine(Magazine *magazine);       //!< Fills a magazine from the back-end
+  void DrainMagazine(Magazine *magazine);      //!< Returns a magazine's blocks to the back-end
+};
+
+#endif
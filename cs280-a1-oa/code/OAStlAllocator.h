@@ -0,0 +1,177 @@
+/******************************************************************************/
+/*!
+\file   OAStlAllocator.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the STL allocator adapter, which lets node-based
+  standard containers take their nodes from ObjectAllocator pages.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef OASTLALLOCATORH
+#define OASTLALLOCATORH
+//---------------------------------------------------------------------------
+
+#include <cstddef>     // std::size_t, std::ptrdiff_t
+#include <limits>      // std::numeric_limits
+#include <new>         // std::bad_alloc, std::bad_array_new_length
+#include <type_traits> // std::true_type
+#include "ConcurrentObjectAllocator.h"
+
+// Objects per page of the pools of OAStlAllocator
+static const unsigned DEFAULT_STL_OBJECTS_PER_PAGE = 256;
+
+/*!
+  A standard allocator that serves single objects from an ObjectAllocator.
+
+  Node-based containers (std::list, std::map, std::set, std::unordered_map,
+  ...) rebind the allocator to their node type and allocate one node at a
+  time, so every node type gets its own pool, shared by every container
+  that uses that node type. Requests for more than one object, such as the
+  bucket arrays of unordered containers, go to operator new.
+
+  The allocator holds no state, so any two of them compare equal and nodes
+  can move freely between containers. Since unrelated containers share a
+  pool, each pool is a ConcurrentObjectAllocator: containers on different
+  threads may allocate and free at the same time (a container itself is
+  no more thread-safe than with std::allocator), and a node may be freed
+  on another thread than the one that allocated it.
+*/
+template <typename T>
+class OAStlAllocator
+{
+public:
+  typedef T value_type;                             //!< Type of the objects allocated
+  typedef std::size_t size_type;                    //!< Type of the counts
+  typedef std::ptrdiff_t difference_type;           //!< Type of the pointer differences
+  typedef std::true_type is_always_equal;           //!< Every instance can free the objects of every other one
+  typedef std::true_type propagate_on_container_move_assignment; //!< Moving the allocator is free
+
+  /*!
+    Creates the allocator. The pool is only created on the first allocation.
+  */
+  OAStlAllocator() noexcept
+  {
+  }
+
+  /*!
+    Creates the allocator of another type from an allocator, as containers
+    do when they rebind it to their node type.
+  */
+  template <typename U>
+  OAStlAllocator(const OAStlAllocator<U> &) noexcept
+  {
+  }
+
+  // Takes n objects: one from the pool of T, more from operator new
+  // Throws std::bad_alloc if the objects can't be allocated.
+  T *allocate(size_type n);
+
+  // Returns n objects taken by allocate (never throws, whatever the thread)
+  void deallocate(T *p, size_type n) noexcept;
+
+  // Returns the pool the single objects of type T come from (thread-safe)
+  static ConcurrentObjectAllocator &Pool();
+
+private:
+  static constexpr size_t OBJECT_SIZE = sizeof(T) < sizeof(GenericObject) ? sizeof(GenericObject) : sizeof(T); //!< Blocks must hold a free list link
+  static constexpr unsigned ALIGNMENT = alignof(T) > alignof(GenericObject) ? alignof(T) : 0; //!< Block alignment beyond that of a pointer
+
+  static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "OAStlAllocator: over-aligned types are not supported");
+};
+
+/*!
+  Any two allocators free each other's objects.
+*/
+template <typename T, typename U>
+bool operator==(const OAStlAllocator<T> &, const OAStlAllocator<U> &) noexcept
+{
+  return true;
+}
+
+/*!
+  Any two allocators free each other's objects.
+*/
+template <typename T, typename U>
+bool operator!=(const OAStlAllocator<T> &, const OAStlAllocator<U> &) noexcept
+{
+  return false;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates storage for n objects. A single object comes from
+  the pool of T; an array comes from operator new.
+
+\par n The number of objects.
+\return The storage, not yet constructed.
+*/
+/******************************************************************************/
+template <typename T>
+T *OAStlAllocator<T>::allocate(size_type n)
+{
+  if (n == 1)
+  {
+    try
+    {
+      return static_cast<T *>(Pool().Allocate());
+    }
+    catch (const OAException &)
+    {
+      throw std::bad_alloc();
+    }
+  }
+
+  if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+    throw std::bad_array_new_length();
+
+  return static_cast<T *>(::operator new(n * sizeof(T)));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees storage taken by allocate with the same n. It may
+  run on any thread, even one that never allocated from the pool (e.g. a
+  container destroyed on another thread): the pool never fails a free for
+  lack of memory, so nothing can escape the noexcept.
+
+\par p The storage.
+\par n The number of objects given to allocate.
+*/
+/******************************************************************************/
+template <typename T>
+void OAStlAllocator<T>::deallocate(T *p, size_type n) noexcept
+{
+  if (n == 1)
+    Pool().Free(p);
+  else
+    ::operator delete(p);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the pool of T, creating it on the first call (the
+  creation is thread-safe, as for any local static). The pool is never
+  destroyed, so containers with static storage can still free their nodes
+  after it would have been.
+
+\return The pool of T.
+*/
+/******************************************************************************/
+template <typename T>
+ConcurrentObjectAllocator &OAStlAllocator<T>::Pool()
+{
+  static ConcurrentObjectAllocator *pool =
+      new ConcurrentObjectAllocator(OBJECT_SIZE, OAConfig(false, DEFAULT_STL_OBJECTS_PER_PAGE, 0, false, 0,
+                                                          OAConfig::HeaderBlockInfo(), ALIGNMENT));
+  return *pool;
+}
+
+#endif
@@ -11,10 +11,95 @@
 */
 /******************************************************************************/
 #include "ObjectAllocator.h"
-#include <cstring> //<! std::memset, std::strcpy, std::strlen
+#include <cstring>   //<! std::memset, std::strcmp
+#include <algorithm> //<! std::upper_bound, std::lower_bound, std::max, std::rotate, std::remove_if, std::fill, std::sort
+#include <bitset>    //<! std::bitset
+#include <cstdint>   //<! uint32_t, uint64_t
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h> //<! _mm256_cmpeq_epi8, _mm_cmpeq_epi8
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h> //<! mmap, munmap, madvise, mprotect
+#include <unistd.h>   //<! sysconf, write
+#include <signal.h>   //<! sigaction
+#include <mutex>      //<! std::mutex
+#define OA_MAPPED_PAGES 1
+#else
+#define OA_MAPPED_PAGES 0
+#endif
 
 using BYTE = unsigned char;                   //!< Type of byte
 constexpr size_t PTR_SIZE = sizeof(intptr_t); //!< Size of a pointer
+constexpr size_t WORD_BITS = sizeof(unsigned) * 8; //!< Bits in an occupancy word
+constexpr size_t INFOS_PER_CHUNK = 256;            //!< MemBlockInfo records allocated at a time
+constexpr size_t PAGE_CHUNK_SIZE = 2 * 1024 * 1024; //!< Bytes mapped at a time for pages (one huge page)
+constexpr unsigned OCCUPANCY_BUCKETS = 32;          //!< Most buckets of pages for fullest-page-first
+
+namespace
+{
+  //! Allocators with guarded slots, looked up by the fault handler
+  std::atomic<const ObjectAllocator *> GuardRegistry[OA_MAX_GUARDED_ALLOCATORS];
+
+#if OA_MAPPED_PAGES
+  struct sigaction PreviousSegv;             //!< SIGSEGV handler the guard fault handler forwards to
+  struct sigaction PreviousBus;              //!< SIGBUS handler the guard fault handler forwards to
+  std::atomic<bool> HandlerInstalled{false}; //!< Set once the handler has been installed
+  std::mutex HandlerLock;                    //!< Guards the installation of the handler
+
+  /*!
+    Describes a fault on a guarded slot, if it is one, then forwards every
+    fault to the handler that was in place before. A handler function is
+    called and the guard handler stays installed. The default action is
+    put back and the handler returns, so the access faults again and the
+    process stops as it would have without the guards.
+  */
+  void GuardFaultHandler(int signal, siginfo_t *info, void *context)
+  {
+    ObjectAllocator::ReportGuardFault(info->si_addr);
+
+    const struct sigaction &previous = signal == SIGBUS ? PreviousBus : PreviousSegv;
+    if (previous.sa_flags & SA_SIGINFO)
+      previous.sa_sigaction(signal, info, context);
+    else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+      previous.sa_handler(signal);
+    else
+      sigaction(signal, &previous, nullptr);
+  }
+#endif
+
+  /*!
+    A message built without allocating, for the fault handler
+  */
+  struct FaultMessage
+  {
+    char Text[256];    //!< The message so far
+    size_t Length = 0; //!< Characters in Text
+
+    //! Appends a string
+    void Append(const char *text)
+    {
+      while (*text && Length < sizeof(Text))
+        Text[Length++] = *text++;
+    }
+
+    //! Appends a number in base 10 or 16
+    void Append(uint64_t value, unsigned base)
+    {
+      char digits[20];
+      unsigned count = 0;
+      do
+      {
+        digits[count++] = "0123456789abcdef"[value % base];
+        value /= base;
+      } while (value);
+
+      while (count && Length < sizeof(Text))
+        Text[Length++] = digits[--count];
+    }
+  };
+}
 
 /******************************************************************************/
 /*!
@@ -36,6 +121,68 @@ inline size_t Align(size_t n, size_t alignment)
   return alignment * ((n / alignment) + rem);
 }
 
+/******************************************************************************/
+/*!
+\brief
+  This function checks that every byte of a range holds \p pattern. The
+  bytes are compared 32 or 16 at a time where AVX2 or SSE2 is available,
+  then 8 and 4 at a time, and the rest one at a time.
+
+\par address The start of the range.
+\par size The number of bytes in the range.
+\par pattern The byte expected everywhere in the range.
+
+\return Whether every byte holds the pattern.
+*/
+/******************************************************************************/
+bool ObjectAllocator::MatchesPattern(const unsigned char *address, size_t size, unsigned char pattern)
+{
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i wide32 = _mm256_set1_epi8(static_cast<char>(pattern));
+  for (; i + 32 <= size; i += 32)
+  {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(address + i));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, wide32)) != -1)
+      return false;
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i wide16 = _mm_set1_epi8(static_cast<char>(pattern));
+  for (; i + 16 <= size; i += 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(address + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, wide16)) != 0xFFFF)
+      return false;
+  }
+#endif
+
+  // pads are not aligned, so words are read with memcpy
+  const uint64_t wide8 = 0x0101010101010101ULL * pattern;
+  for (; i + 8 <= size; i += 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, address + i, sizeof(word));
+    if (word != wide8)
+      return false;
+  }
+  if (i + 4 <= size)
+  {
+    uint32_t word;
+    std::memcpy(&word, address + i, sizeof(word));
+    if (word != static_cast<uint32_t>(wide8))
+      return false;
+    i += 4;
+  }
+  for (; i < size; ++i)
+  {
+    if (address[i] != pattern)
+      return false;
+  }
+  return true;
+}
+
 /******************************************************************************/
 /*!
 \brief
@@ -46,7 +193,12 @@ inline size_t Align(size_t n, size_t alignment)
 */
 /******************************************************************************/
 ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig &config)
-    : PageList_{nullptr}, FreeList_{nullptr}, Config_{config}, Stats_{}
+    : PageList_{nullptr}, FreeList_{nullptr}, FirstBucket_{0}, CarvePage_{nullptr}, RemoteFreeList_{nullptr},
+      Owner_{std::this_thread::get_id()}, Config_{config}, Stats_{}, FreeInfos_{nullptr},
+      LastLabel_{nullptr}, LastInterned_{nullptr}, NextSlot_{nullptr}, ChunkEnd_{nullptr}, SlotSize_{0},
+      ChunkSize_{0}, Profile_{nullptr}, Refill_{nullptr}, ValidatePage_{nullptr}, ValidateBlock_{0},
+      GuardBase_{nullptr}, GuardEnd_{nullptr}, GuardStride_{0}, GuardDataSize_{0}, GuardCountdown_{0}, GuardFrees_{0},
+      PageBlocks_{0}, FastAllocate_{false}, FastFree_{false}, SlotBits_{0}
 {
   size_t leftHeaderSize = PTR_SIZE + config.HBlockInfo_.size_ + static_cast<size_t>(config.PadBytes_);
   HeaderSize_ = Align(leftHeaderSize, config.Alignment_);
@@ -58,7 +210,96 @@ ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig &config)
   Config_.LeftAlignSize_ = static_cast<unsigned int>(HeaderSize_ - leftHeaderSize);
   Stats_.PageSize_ = PTR_SIZE + Config_.LeftAlignSize_ + Config_.ObjectsPerPage_ * MidBlockSize_ - Config_.InterAlignSize_;
 
-  AllocateNewPage(PageList_);
+#if OA_MAPPED_PAGES
+  if (Config_.MappedPages_)
+  {
+    // whole OS pages per slot, so a slot can be given back on its own
+    SlotSize_ = Align(Stats_.PageSize_, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    ChunkSize_ = Align(std::max(SlotSize_, PAGE_CHUNK_SIZE), PAGE_CHUNK_SIZE);
+  }
+#else
+  Config_.MappedPages_ = false;
+  Config_.HugePages_ = false;
+  Config_.GuardSampleRate_ = 0;
+#endif
+  if (!Config_.GuardSlots_ || Config_.UseCPPMemManager_)
+    Config_.GuardSampleRate_ = 0;
+
+  // the helper thread can't take mapped page slots, and makes pages of one size
+  if (Config_.UseCPPMemManager_ || Config_.MappedPages_)
+    Config_.BackgroundRefill_ = false;
+
+  // mapped page slots all have the size of the first page
+  if (!Config_.GrowthFactor_ || Config_.MappedPages_ || Config_.BackgroundRefill_)
+    Config_.GrowthFactor_ = 1;
+  if (Config_.GrowthFactor_ == 1 || Config_.MaxObjectsPerPage_ < Config_.ObjectsPerPage_)
+    Config_.MaxObjectsPerPage_ = Config_.ObjectsPerPage_;
+
+  if (Config_.FullestPageFirst_)
+    Config_.PerPageFreeLists_ = true;
+
+  // a block from new or from a guarded slot is not on a page, so a handle can't name it
+  if (Config_.UseCPPMemManager_)
+    Config_.Handles_ = false;
+  if (Config_.Handles_)
+  {
+    Config_.GuardSampleRate_ = 0;
+    while ((1ULL << SlotBits_) < Config_.MaxObjectsPerPage_)
+      ++SlotBits_;
+
+    // the page number takes the bits left, and every page in use needs one
+    unsigned numbers = static_cast<unsigned>((1ULL << (32 - SlotBits_)) - 1);
+    if (!Config_.MaxPages_ || Config_.MaxPages_ > numbers)
+      Config_.MaxPages_ = numbers;
+  }
+
+  try
+  {
+    PageTable_.assign(1, nullptr);
+
+    // a single bucket keeps the pages with free blocks in one LIFO list
+    if (Config_.PerPageFreeLists_)
+      PartialPages_.assign(Config_.FullestPageFirst_ ? std::min(Config_.MaxObjectsPerPage_, OCCUPANCY_BUCKETS) : 1, nullptr);
+    FirstBucket_ = static_cast<unsigned>(PartialPages_.size());
+
+    if (Config_.Profiling_)
+    {
+      Profile_ = new ProfileState{};
+      Profile_->Profile.Labels_.emplace_back();
+      Profile_->Profile.PageEvents_.reserve(OA_PAGE_EVENTS);
+      Profile_->Ids[""] = 0;
+      Profile_->Countdown = Config_.ProfileSampleRate_;
+      Profile_->Start = std::chrono::steady_clock::now();
+    }
+
+    if (Config_.GuardSampleRate_)
+      MapGuardSlots();
+
+    if (Config_.BackgroundRefill_)
+    {
+      Refill_ = new RefillState{};
+      Refill_->Watermark = Config_.RefillWatermark_ ? Config_.RefillWatermark_ : Config_.ObjectsPerPage_;
+      Refill_->Thread = std::thread(&ObjectAllocator::RefillLoop, this);
+    }
+
+    AllocateNewPage(PageList_);
+    UpdateFastPaths();
+  }
+  catch (std::bad_alloc &)
+  {
+    StopRefill();
+    UnmapGuardSlots();
+    delete Profile_;
+    throw OAException(OAException::E_NO_MEMORY, "ObjectAllocator: No system memory available!");
+  }
+  catch (...)
+  {
+    StopRefill();
+    UnmapChunks();
+    UnmapGuardSlots();
+    delete Profile_;
+    throw;
+  }
 }
 
 /******************************************************************************/
@@ -69,22 +310,30 @@ ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig &config)
 /******************************************************************************/
 ObjectAllocator::~ObjectAllocator() noexcept
 {
+  StopRefill();
+
   GenericObject *page = PageList_;
-  while (page)
+  while (page && !Config_.MappedPages_)
   {
     GenericObject *next = page->Next;
-
-    if (Config_.HBlockInfo_.type_ == OAConfig::hbExternal)
-    {
-      BYTE *objectAddress = reinterpret_cast<BYTE *>(page) + HeaderSize_;
-      for (size_t i = 0; i < Config_.ObjectsPerPage_; ++i)
-      {
-        FreeHeader(reinterpret_cast<GenericObject *>(objectAddress), Config_.HBlockInfo_.type_);
-      }
-    }
     delete[] reinterpret_cast<BYTE *>(page);
     page = next;
   }
+  UnmapChunks();
+  UnmapGuardSlots();
+
+  // the records of external headers still in use go with their chunks
+  for (MemBlockInfo *chunk : InfoChunks_)
+    delete[] chunk;
+
+  for (PageInfo *info : PageIndex_)
+  {
+    delete[] info->Occupancy;
+    delete[] info->Labels;
+    delete info;
+  }
+
+  delete Profile_;
 }
 
 /******************************************************************************/
@@ -98,6 +347,39 @@ ObjectAllocator::~ObjectAllocator() noexcept
 /******************************************************************************/
 void *ObjectAllocator::Allocate(const char *label)
 {
+  if (Profile_)
+    return ProfileAllocate(label);
+
+  return AllocateBlock(label);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes a block for Allocate, from the free list(s) or from a
+  new page.
+
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory.
+*/
+/******************************************************************************/
+void *ObjectAllocator::AllocateBlock(const char *label)
+{
+  if (GuardBase_ && --GuardCountdown_ == 0)
+  {
+    GuardCountdown_ = Config_.GuardSampleRate_;
+    if (void *object = AllocateGuarded(label))
+      return object;
+  }
+
+  if (Config_.RemoteFrees_)
+  {
+    bool outOfBlocks = Config_.PerPageFreeLists_ ? nullptr == FullestPartialPage()
+                                                 : nullptr == FreeList_ && nullptr == CarvePage_;
+    if (outOfBlocks || Config_.UseCPPMemManager_)
+      CollectRemoteFrees();
+  }
+
   if (Config_.UseCPPMemManager_)
   {
     try
@@ -118,13 +400,37 @@ void *ObjectAllocator::Allocate(const char *label)
     }
   }
 
-  if (nullptr == FreeList_)
+  GenericObject *AllocatedObject = nullptr;
+
+  if (Config_.PerPageFreeLists_)
   {
-    AllocateNewPage(PageList_);
+    PageInfo *page = FullestPartialPage();
+    if (nullptr == page)
+    {
+      GrowPages();
+      page = FullestPartialPage();
+    }
+    AllocatedObject = PopFromPageFreeList(page);
+
+    if (page->Occupancy)
+      SetOccupied(page, AllocatedObject, true);
   }
-  GenericObject *AllocatedObject = FreeList_;
+  else
+  {
+    if (nullptr == FreeList_ && nullptr == CarvePage_)
+    {
+      GrowPages();
+    }
 
-  FreeList_ = FreeList_->Next;
+    if (FreeList_)
+    {
+      AllocatedObject = FreeList_;
+
+      FreeList_ = FreeList_->Next;
+    }
+    else
+      AllocatedObject = CarveBlock(CarvePage_);
+  }
 
   if (Config_.DebugOn_)
   {
@@ -137,7 +443,10 @@ void *ObjectAllocator::Allocate(const char *label)
   --Stats_.FreeObjects_;
   ++Stats_.Allocations_;
 
-  InitHeader(AllocatedObject, Config_.HBlockInfo_.type_, label);
+  InitHeader(AllocatedObject, Config_.HBlockInfo_.type_, label, Stats_.Allocations_);
+
+  if (Refill_)
+    RequestRefill();
 
   return AllocatedObject;
 }
@@ -145,26 +454,90 @@ void *ObjectAllocator::Allocate(const char *label)
 /******************************************************************************/
 /*!
 \brief
-  This function frees block of memory used by an object.
+  This function frees block of memory used by an object. With remote frees
+  enabled, a block freed by a thread other than the owner is only handed
+  over; the owner frees it the next time it runs out of free blocks.
 
 \par Object The objects address that needs to be freed.
 */
 /******************************************************************************/
 void ObjectAllocator::Free(void *Object)
+{
+  if (Config_.RemoteFrees_ && std::this_thread::get_id() != Owner_)
+  {
+    GenericObject *object = reinterpret_cast<GenericObject *>(Object);
+    PushToRemoteFreeList(object, object);
+    return;
+  }
+
+  if (Profile_)
+    ProfileFree(reinterpret_cast<GenericObject *>(Object));
+  else
+    FreeLocal(reinterpret_cast<GenericObject *>(Object));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees block of memory used by an object. Must be called on
+  the owning thread.
+
+\par object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+void ObjectAllocator::FreeLocal(GenericObject *object)
 {
   ++Stats_.Deallocations_;
 
+  if (GuardBase_ && IsGuarded(object))
+  {
+    FreeGuarded(object);
+    if (Profile_)
+      RecordFree(object);
+    --Stats_.ObjectsInUse_;
+    return;
+  }
+
   if (Config_.UseCPPMemManager_)
   {
-    delete[] reinterpret_cast<BYTE *>(Object);
+    if (Profile_)
+      RecordFree(object);
+    delete[] reinterpret_cast<BYTE *>(object);
     return;
   }
 
-  GenericObject *object = reinterpret_cast<GenericObject *>(Object);
+  ReleaseBlock(object);
+  if (Profile_)
+    RecordFree(object);
+
+  if (Config_.PerPageFreeLists_)
+  {
+    PageInfo *page = FindPage(reinterpret_cast<BYTE *>(object));
+
+    if (page->Occupancy)
+      SetOccupied(page, object, false);
+    PushToPageFreeList(page, object);
+  }
+  else
+    PushToFreeList(object);
+
+  --Stats_.ObjectsInUse_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function runs the debug checks on a block being freed and resets its
+  header, but does not put it on a free list yet.
 
+\par object The block being freed.
+*/
+/******************************************************************************/
+void ObjectAllocator::ReleaseBlock(GenericObject *object)
+{
   if (Config_.DebugOn_)
   {
-    CheckBoundaries(reinterpret_cast<BYTE *>(Object));
+    CheckBoundaries(reinterpret_cast<BYTE *>(object));
     {
       if (!ValidatePadding(GetLeftPadAdrress(object), Config_.PadBytes_))
       {
@@ -184,438 +557,2756 @@ void ObjectAllocator::Free(void *Object)
     std::memset(object, FREED_PATTERN, Stats_.ObjectSize_);
   }
   object->Next = nullptr;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a block like Allocate and names it by a handle:
+  the number of its page and its slot on the page, in 32 bits. Nodes that
+  link to each other by handle take half the room of pointers on 64-bit
+  builds, and ToPointer turns a handle back into the block with one look-up.
 
-  PushToFreeList(object);
+\par label A label for the block of memory requested.
+\return The handle of the allocated block.
+*/
+/******************************************************************************/
+OAHandle ObjectAllocator::AllocateHandle(const char *label)
+{
+  if (!Config_.Handles_)
+    throw OAException(OAException::E_NO_PAGES, "AllocateHandle: Handles are off!");
 
-  --Stats_.ObjectsInUse_;
+  return ToHandle(Allocate(label));
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function calls a callback \p fn on any active object in the allocator.
+  This function frees the block named by a handle. The page number is
+  checked against the page table, so a handle of a freed page is caught
+  here; the block itself is checked by Free.
 
-\par fn The callback function.
-\return The amount of bytes currently in use by the allocator.
+\par Handle The handle of the block to free.
 */
 /******************************************************************************/
-unsigned ObjectAllocator::DumpMemoryInUse(DUMPCALLBACK fn) const
+void ObjectAllocator::FreeHandle(OAHandle Handle)
 {
-  if (!PageList_)
+  size_t number = Handle >> SlotBits_;
+  if (number >= PageTable_.size() || !PageTable_[number])
+    throw OAException(OAException::E_BAD_BOUNDARY, "FreeHandle: Handle names no page!");
+
+  Free(ToPointer(Handle));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the handle of a block, found through the page
+  index. The handle stays the same until the block is freed, unless
+  Compact moves the block.
+
+\par Object The block.
+\return The handle of the block, or 0 if handles are off or the block is
+  not on a page.
+*/
+/******************************************************************************/
+OAHandle ObjectAllocator::ToHandle(const void *Object) const
+{
+  if (!Config_.Handles_ || !Object)
     return 0;
-  else
+
+  GenericObject *object = reinterpret_cast<GenericObject *>(const_cast<void *>(Object));
+  PageInfo *page = FindPage(reinterpret_cast<BYTE *>(object));
+  if (!page)
+    return 0;
+
+  return page->Number << SlotBits_ | BlockIndex(page, object);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function provides \p Count blocks at once. Whole runs of blocks are
+  taken off the free list(s) in the same order as \p Count calls to Allocate
+  would take them, pages are added as needed, and the statistics are
+  updated once. Headers and signatures are the same as with
+  single calls. Either every block is allocated or, when an exception is
+  thrown, none is.
+
+\par Count The number of blocks requested.
+\par Objects Receives the \p Count blocks.
+\par label A label for every block of memory requested.
+*/
+/******************************************************************************/
+void ObjectAllocator::AllocateBatch(unsigned Count, void **Objects, const char *label)
+{
+  if (Config_.UseCPPMemManager_)
   {
-    unsigned bytesUsed = 0;
-    GenericObject *page = PageList_;
+    unsigned allocated = 0;
+    try
+    {
+      for (; allocated < Count; ++allocated)
+        Objects[allocated] = Allocate(label);
+    }
+    catch (const OAException &)
+    {
+      while (allocated)
+        Free(Objects[--allocated]);
+      throw;
+    }
+    return;
+  }
 
-    while (page)
+  if (Config_.RemoteFrees_ && Stats_.FreeObjects_ < Count)
+    CollectRemoteFrees();
+
+  if (Profile_)
+    Profile_->Label = ProfileLabel(label);
+
+  unsigned taken = 0;
+  try
+  {
+    while (taken < Count)
     {
-      BYTE *pageData = reinterpret_cast<BYTE *>(page) + HeaderSize_;
-      for (size_t i = 0; i < Config_.ObjectsPerPage_; ++i)
+      if (Config_.PerPageFreeLists_)
       {
-        GenericObject *objectData = reinterpret_cast<GenericObject *>(pageData + i * MidBlockSize_);
+        if (nullptr == FullestPartialPage())
+          GrowPages();
 
-        if (IsObjectUsed(objectData))
+        PageInfo *page = FullestPartialPage();
+        while (page->FreeCount && taken < Count)
         {
-          fn(objectData, Stats_.ObjectSize_);
-          ++bytesUsed;
+          GenericObject *object = page->FreeList;
+          if (object)
+            page->FreeList = object->Next;
+          else
+            object = CarveBlock(page);
+          --page->FreeCount;
+          if (page->Occupancy)
+            SetOccupied(page, object, true);
+          Objects[taken++] = object;
         }
+        if (page->FreeCount == 0)
+          UnlinkPartialPage(page);
+        else
+          UpdateBucket(page);
+      }
+      else
+      {
+        if (nullptr == FreeList_ && nullptr == CarvePage_)
+          GrowPages();
+
+        GenericObject *object = FreeList_;
+        while (object && taken < Count)
+        {
+          Objects[taken++] = object;
+          object = object->Next;
+        }
+        FreeList_ = object;
+
+        while (CarvePage_ && taken < Count)
+          Objects[taken++] = CarveBlock(CarvePage_);
       }
-      page = page->Next;
     }
-    return bytesUsed;
   }
+  catch (const OAException &)
+  {
+    // out of pages part way: put back what was taken
+    while (taken)
+      PushBlock(reinterpret_cast<GenericObject *>(Objects[--taken]));
+    throw;
+  }
+
+  if (Config_.DebugOn_ || Config_.HBlockInfo_.type_ != OAConfig::hbNone)
+  {
+    unsigned initialized = 0;
+    try
+    {
+      for (; initialized < Count; ++initialized)
+      {
+        GenericObject *object = reinterpret_cast<GenericObject *>(Objects[initialized]);
+        if (Config_.DebugOn_)
+          std::memset(object, ALLOCATED_PATTERN, Stats_.ObjectSize_);
+        InitHeader(object, Config_.HBlockInfo_.type_, label, Stats_.Allocations_ + initialized + 1);
+      }
+    }
+    catch (const OAException &)
+    {
+      // put everything back the way it was taken
+      for (unsigned i = 0; i < initialized; ++i)
+        FreeHeader(reinterpret_cast<GenericObject *>(Objects[i]), Config_.HBlockInfo_.type_);
+      for (unsigned i = Count; i > 0; --i)
+        PushBlock(reinterpret_cast<GenericObject *>(Objects[i - 1]));
+      throw;
+    }
+  }
+
+  Stats_.ObjectsInUse_ += Count;
+  if (Stats_.ObjectsInUse_ > Stats_.MostObjects_)
+    Stats_.MostObjects_ = Stats_.ObjectsInUse_;
+  Stats_.FreeObjects_ -= Count;
+  Stats_.Allocations_ += Count;
+
+  if (Profile_)
+  {
+    for (unsigned i = 0; i < Count; ++i)
+      RecordAllocation(Objects[i], Profile_->Label);
+  }
+
+  if (Refill_)
+    RequestRefill();
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function calls a callback \p fn on any corrupted object in the allocator.
-
-\par fn The callback function.
-\par The number of blocks/objects that are corrupted.
+  This function frees \p Count blocks at once. Every block gets the same
+  checks as with Free, in order, and the statistics are updated once. If a
+  block fails a check, the blocks before it stay freed and the exception is
+  thrown as Free would have thrown it. With remote frees enabled, a thread
+  other than the owner hands the whole batch over with one
+  compare-and-swap.
+
+\par Objects The blocks to free.
+\par Count The number of blocks.
 */
 /******************************************************************************/
-unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK fn) const
+void ObjectAllocator::FreeBatch(void **Objects, unsigned Count)
 {
-  if (!Config_.DebugOn_ || Config_.PadBytes_ == 0)
-    return 0;
+  if (!Count)
+    return;
 
-  unsigned numBlocksCorrupted = 0;
-  GenericObject *page = PageList_;
+  if (Config_.RemoteFrees_ && std::this_thread::get_id() != Owner_)
+  {
+    // linked so that the owner collects them in the same order as single frees
+    for (unsigned i = Count - 1; i > 0; --i)
+      reinterpret_cast<GenericObject *>(Objects[i])->Next = reinterpret_cast<GenericObject *>(Objects[i - 1]);
+    PushToRemoteFreeList(reinterpret_cast<GenericObject *>(Objects[Count - 1]),
+                         reinterpret_cast<GenericObject *>(Objects[0]));
+    return;
+  }
 
-  while (page)
+  if (Config_.UseCPPMemManager_)
   {
-    BYTE *pageData = reinterpret_cast<BYTE *>(page) + HeaderSize_;
-    for (size_t i = 0; i < Config_.ObjectsPerPage_; ++i)
-    {
-      GenericObject *objectData = reinterpret_cast<GenericObject *>(pageData + i * MidBlockSize_);
+    for (unsigned i = 0; i < Count; ++i)
+      Free(Objects[i]);
+    return;
+  }
 
-      if (!ValidatePadding(GetLeftPadAdrress(objectData), Config_.PadBytes_) || !ValidatePadding(GetRightPadAdrress(objectData), Config_.PadBytes_))
+  unsigned freed = 0;
+  unsigned guarded = 0;
+  try
+  {
+    for (; freed < Count; ++freed)
+    {
+      GenericObject *object = reinterpret_cast<GenericObject *>(Objects[freed]);
+      if (GuardBase_ && IsGuarded(object))
       {
-        fn(objectData, Stats_.ObjectSize_);
-        ++numBlocksCorrupted;
+        FreeGuarded(object);
+        if (Profile_)
+          RecordFree(object);
+        ++guarded;
         continue;
       }
+
+      ReleaseBlock(object);
+      if (Profile_)
+        RecordFree(object);
+      PushBlock(object);
     }
-    page = page->Next;
   }
-  return numBlocksCorrupted;
+  catch (const OAException &)
+  {
+    Stats_.Deallocations_ += freed + 1;
+    Stats_.ObjectsInUse_ -= freed;
+    Stats_.FreeObjects_ += freed - guarded;
+    throw;
+  }
+
+  Stats_.Deallocations_ += Count;
+  Stats_.ObjectsInUse_ -= Count;
+  Stats_.FreeObjects_ += Count - guarded;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function puts a block at the front of its free list. Unlike
+  PushToFreeList and PushToPageFreeList, the statistics are left to the
+  caller.
+
+\par object The block to put on the free list.
+*/
+/******************************************************************************/
+void ObjectAllocator::PushBlock(GenericObject *object)
+{
+  if (Config_.PerPageFreeLists_)
+  {
+    PageInfo *page = FindPage(reinterpret_cast<BYTE *>(object));
+
+    if (page->Occupancy)
+      SetOccupied(page, object, false);
+
+    object->Next = page->FreeList;
+    page->FreeList = object;
+    if (page->FreeCount++ == 0)
+      LinkPartialPage(page);
+    else
+      UpdateBucket(page);
+  }
+  else
+  {
+    object->Next = FreeList_;
+    FreeList_ = object;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a block for TryAllocate when it can't be taken
+  off the free list inline.
+
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory, or null if there is none.
+*/
+/******************************************************************************/
+void *ObjectAllocator::TryAllocateSlow(const char *label) noexcept
+{
+  try
+  {
+    return Allocate(label);
+  }
+  catch (const OAException &)
+  {
+    return nullptr;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a block for TryFree when it can't be pushed onto the
+  free list inline.
+
+\par object The objects address that needs to be freed.
+\return Whether the object was freed.
+*/
+/******************************************************************************/
+bool ObjectAllocator::TryFreeSlow(void *object) noexcept
+{
+  try
+  {
+    Free(object);
+    return true;
+  }
+  catch (const OAException &)
+  {
+    return false;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function decides if TryAllocate and TryFree can take their inline
+  paths: blocks are on the global free list, no header or pattern has to
+  be written, no allocation is profiled or sampled, and no watermark is
+  watched for the background refill. TryFree also needs
+  every free to come from the owner.
+*/
+/******************************************************************************/
+void ObjectAllocator::UpdateFastPaths()
+{
+  FastAllocate_ = !Config_.UseCPPMemManager_ && !Config_.DebugOn_ && !Config_.PerPageFreeLists_ &&
+                  Config_.HBlockInfo_.type_ == OAConfig::hbNone && !Profile_ && !GuardBase_ && !Refill_;
+  FastFree_ = FastAllocate_ && !Config_.RemoteFrees_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a block like Allocate and adds it to the profile
+  under its label. One in ProfileSampleRate_ calls is timed.
+
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory.
+*/
+/******************************************************************************/
+void *ObjectAllocator::ProfileAllocate(const char *label)
+{
+  // page growth events are charged to this label
+  Profile_->Label = ProfileLabel(label);
+
+  void *object;
+  if (SampleLatency())
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    object = AllocateBlock(label);
+    RecordLatency(Profile_->Profile.AllocateLatency_, start);
+  }
+  else
+    object = AllocateBlock(label);
+
+  RecordAllocation(object, Profile_->Label);
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a block on the owning thread like FreeLocal, timing
+  one in ProfileSampleRate_ calls.
+
+\par object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+void ObjectAllocator::ProfileFree(GenericObject *object)
+{
+  if (!SampleLatency())
+  {
+    FreeLocal(object);
+    return;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  FreeLocal(object);
+  RecordLatency(Profile_->Profile.FreeLatency_, start);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the index of a label in the profile, adding the
+  label the first time it is seen. Like InternLabel, a label passed again
+  at the same address is found without a lookup.
+
+\par label The label given to Allocate (may be null).
+\return The index of the label in OAProfile::Labels_ (0 for no label).
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::ProfileLabel(const char *label)
+{
+  if (!label)
+    return 0;
+
+  ProfileState &state = *Profile_;
+  if (label == state.LastLabel && state.Profile.Labels_[state.LastId].Label_ == label)
+    return state.LastId;
+
+  try
+  {
+    std::string key(label);
+    auto it = state.Ids.find(key);
+    if (it == state.Ids.end())
+    {
+      // nothing changes if a step throws
+      OALabelProfile entry(key);
+      state.Profile.Labels_.reserve(state.Profile.Labels_.size() + 1);
+      it = state.Ids.emplace(key, static_cast<unsigned>(state.Profile.Labels_.size())).first;
+      state.Profile.Labels_.push_back(std::move(entry));
+    }
+
+    state.LastLabel = label;
+    state.LastId = it->second;
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "ProfileLabel: No system memory available!");
+  }
+
+  return state.LastId;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function counts down to the next call to time.
+
+\return Whether the current call should be timed.
+*/
+/******************************************************************************/
+bool ObjectAllocator::SampleLatency()
+{
+  if (!Config_.ProfileSampleRate_ || --Profile_->Countdown)
+    return false;
+
+  Profile_->Countdown = Config_.ProfileSampleRate_;
+  return true;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds an allocated block to the profile, and remembers its
+  label in the slot of the block so that Free can find it again.
+
+\par object The block allocated.
+\par label The index of the label of the block.
+*/
+/******************************************************************************/
+void ObjectAllocator::RecordAllocation(void *object, unsigned label)
+{
+  OAProfile &profile = Profile_->Profile;
+  ++profile.Allocations_;
+  if (++profile.ObjectsInUse_ > profile.MostObjects_)
+    profile.MostObjects_ = profile.ObjectsInUse_;
+
+  OALabelProfile &labelProfile = profile.Labels_[label];
+  ++labelProfile.Allocations_;
+
+  if (Config_.UseCPPMemManager_)
+    return;
+
+  // guarded blocks have no page
+  PageInfo *page = ProfilePage(reinterpret_cast<GenericObject *>(object));
+  if (!page)
+    return;
+
+  page->Labels[BlockIndex(page, reinterpret_cast<GenericObject *>(object))] = label;
+  ++labelProfile.ObjectsInUse_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function removes a freed block from the profile.
+
+\par object The block freed.
+*/
+/******************************************************************************/
+void ObjectAllocator::RecordFree(GenericObject *object)
+{
+  OAProfile &profile = Profile_->Profile;
+  ++profile.Deallocations_;
+  --profile.ObjectsInUse_;
+
+  if (Config_.UseCPPMemManager_)
+    return;
+
+  PageInfo *page = ProfilePage(object);
+  if (!page)
+    return;
+
+  OALabelProfile &labelProfile = profile.Labels_[page->Labels[BlockIndex(page, object)]];
+  ++labelProfile.Deallocations_;
+  --labelProfile.ObjectsInUse_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the page of a block for the profile. Blocks allocated
+  or freed one after the other are mostly on the same page, so that page is
+  tried before the page index is searched.
+
+\par object The block.
+\return The page of the block (or null).
+*/
+/******************************************************************************/
+ObjectAllocator::PageInfo *ObjectAllocator::ProfilePage(GenericObject *object)
+{
+  PageInfo *page = Profile_->LastPage;
+  if (page && IsObjectInPage(page, reinterpret_cast<BYTE *>(object)))
+    return page;
+
+  page = FindPage(reinterpret_cast<BYTE *>(object));
+  if (page)
+    Profile_->LastPage = page;
+  return page;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds the page just allocated to the profile. The event log
+  keeps the last OA_PAGE_EVENTS pages, in a ring that was reserved up front.
+*/
+/******************************************************************************/
+void ObjectAllocator::RecordPageGrowth()
+{
+  ProfileState &state = *Profile_;
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - state.Start;
+  OAPageEvent event{static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                    state.Label, Stats_.PagesInUse_};
+
+  ++state.Profile.PagesAllocated_;
+  ++state.Profile.Labels_[state.Label].PageGrowths_;
+
+  std::vector<OAPageEvent> &events = state.Profile.PageEvents_;
+  if (events.size() < OA_PAGE_EVENTS)
+    events.push_back(event);
+  else
+  {
+    events[state.NextEvent] = event;
+    state.NextEvent = (state.NextEvent + 1) % OA_PAGE_EVENTS;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds the time since \p start to a latency histogram.
+
+\par histogram The histogram, with OA_LATENCY_BUCKETS buckets.
+\par start When the call being timed started.
+*/
+/******************************************************************************/
+void ObjectAllocator::RecordLatency(uint64_t *histogram, std::chrono::steady_clock::time_point start)
+{
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+  uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+  unsigned bucket = 0;
+  while ((ns >>= 1) && bucket + 1 < OA_LATENCY_BUCKETS)
+    ++bucket;
+
+  ++histogram[bucket];
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds pages when the free blocks run out: the pages staged
+  by the helper thread if there are any, or else a page allocated now.
+*/
+/******************************************************************************/
+void ObjectAllocator::GrowPages()
+{
+  if (!AdoptStagedPages())
+    AllocateNewPage(PageList_);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds the pages staged by the helper thread, taking them
+  all with one exchange. Their blocks are already linked, so a page costs
+  only its place in the page index and a splice of its blocks into the
+  free list(s). Pages beyond MaxPages_ are freed instead.
+
+\return Whether any page was added.
+*/
+/******************************************************************************/
+bool ObjectAllocator::AdoptStagedPages()
+{
+  if (!Refill_)
+    return false;
+
+  Refill_->Pending -= Refill_->Shortfall.exchange(0, std::memory_order_relaxed);
+  PageInfo *staged = Refill_->Staged.exchange(nullptr, std::memory_order_acquire);
+  if (!staged)
+    return false;
+
+  size_t count = 0;
+  PageInfo *last = staged;
+  for (PageInfo *info = staged; info; info = info->NextPartial, ++count)
+    last = info;
+
+  try
+  {
+    if (PageIndex_.capacity() < PageIndex_.size() + count)
+      PageIndex_.reserve(std::max(PageIndex_.size() + count, 2 * PageIndex_.capacity()));
+    if (Config_.Handles_)
+      ReservePageNumbers(count);
+  }
+  catch (std::bad_alloc &)
+  {
+    // hand the pages back for the next try
+    last->NextPartial = Refill_->Staged.load(std::memory_order_relaxed);
+    while (!Refill_->Staged.compare_exchange_weak(last->NextPartial, staged, std::memory_order_release,
+                                                  std::memory_order_relaxed))
+      ;
+    throw OAException(OAException::E_NO_MEMORY, "AdoptStagedPages: No system memory available!");
+  }
+
+  bool adopted = false;
+  while (staged)
+  {
+    PageInfo *info = staged;
+    staged = info->NextPartial;
+    info->NextPartial = nullptr;
+    --Refill_->Pending;
+
+    if (Config_.MaxPages_ && Stats_.PagesInUse_ == Config_.MaxPages_)
+    {
+      DeleteStagedPage(info);
+      continue;
+    }
+
+    auto position = std::lower_bound(PageIndex_.begin(), PageIndex_.end(), info->Page,
+                                     [](const PageInfo *lhs, const GenericObject *rhs) { return lhs->Page < rhs; });
+    PageIndex_.insert(position, info);
+    if (Config_.Handles_)
+      NumberPage(info);
+    ++Stats_.PagesInUse_;
+    PageBlocks_ += info->Capacity;
+    Stats_.FreeObjects_ += info->Capacity;
+    Stats_.ReservedBytes_ += info->Size;
+    Stats_.ResidentBytes_ += info->Size;
+
+    info->Page->Next = PageList_;
+    PageList_ = info->Page;
+
+    if (Profile_)
+      RecordPageGrowth();
+
+    if (Config_.PerPageFreeLists_)
+      LinkPartialPage(info);
+    else
+    {
+      // the blocks were linked from the first one up, so the first one ends the chain
+      GenericObject *first = reinterpret_cast<GenericObject *>(reinterpret_cast<BYTE *>(info->Page) + HeaderSize_);
+      first->Next = FreeList_;
+      FreeList_ = info->FreeList;
+      info->FreeList = nullptr;
+    }
+    adopted = true;
+  }
+
+  return adopted;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function asks the helper thread for pages once the free blocks,
+  with the pages already asked for, fall below the watermark: enough
+  pages to get back to twice the watermark, within MaxPages_. Only the
+  call that crosses the watermark takes the lock.
+*/
+/******************************************************************************/
+void ObjectAllocator::RequestRefill()
+{
+  size_t perPage = Config_.ObjectsPerPage_;
+  size_t coming = Stats_.FreeObjects_ + Refill_->Pending * perPage;
+  if (coming >= Refill_->Watermark)
+    return;
+
+  unsigned pages = static_cast<unsigned>((2ULL * Refill_->Watermark - coming + perPage - 1) / perPage);
+  if (Config_.MaxPages_)
+    pages = std::min(pages, Config_.MaxPages_ - std::min(Config_.MaxPages_, Stats_.PagesInUse_ + Refill_->Pending));
+  if (!pages)
+    return;
+
+  Refill_->Pending += pages;
+  {
+    std::lock_guard<std::mutex> lock(Refill_->Mutex);
+    Refill_->Requested += pages;
+    Refill_->Debug = Config_.DebugOn_;
+  }
+  Refill_->Wake.notify_one();
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function is the body of the helper thread: it sleeps until pages
+  are requested, stages them one at a time, and stops when told to. Pages
+  it has no memory for are reported back as a shortfall, so the owner can
+  ask again.
+*/
+/******************************************************************************/
+void ObjectAllocator::RefillLoop()
+{
+  std::unique_lock<std::mutex> lock(Refill_->Mutex);
+  for (;;)
+  {
+    Refill_->Wake.wait(lock, [this] { return Refill_->Stop || Refill_->Requested; });
+    if (Refill_->Stop)
+      return;
+
+    unsigned pages = Refill_->Requested;
+    bool debug = Refill_->Debug;
+    Refill_->Requested = 0;
+    lock.unlock();
+
+    for (unsigned i = 0; i < pages; ++i)
+    {
+      PageInfo *info = StagePage(debug);
+      if (!info)
+      {
+        Refill_->Shortfall.fetch_add(pages - i, std::memory_order_relaxed);
+        break;
+      }
+
+      info->NextPartial = Refill_->Staged.load(std::memory_order_relaxed);
+      while (!Refill_->Staged.compare_exchange_weak(info->NextPartial, info, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+        ;
+    }
+
+    lock.lock();
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates and formats a page on the helper thread, with
+  its blocks linked the way AllocateNewPage links them. Only settings that
+  never change after construction are read; the debug state is the one
+  taken when the pages were requested, like AllocateNewPage would have
+  used at that point.
+
+\par debug Write the debug patterns?
+
+\return The page, or null if there is no memory for it.
+*/
+/******************************************************************************/
+ObjectAllocator::PageInfo *ObjectAllocator::StagePage(bool debug)
+{
+  unsigned capacity = Config_.ObjectsPerPage_;
+  size_t pageSize = Stats_.PageSize_;
+  BYTE *page = nullptr;
+  PageInfo *info = nullptr;
+  try
+  {
+    page = new BYTE[pageSize];
+    info = new PageInfo{reinterpret_cast<GenericObject *>(page), nullptr, capacity, nullptr, nullptr, nullptr,
+                        capacity, 0, nullptr, capacity, pageSize, 0};
+    if (Config_.HBlockInfo_.type_ == OAConfig::hbNone)
+      info->Occupancy = new unsigned[(capacity + WORD_BITS - 1) / WORD_BITS]();
+    if (Profile_)
+      info->Labels = new unsigned[capacity];
+  }
+  catch (std::bad_alloc &)
+  {
+    if (info)
+      delete[] info->Occupancy;
+    delete info;
+    delete[] page;
+    return nullptr;
+  }
+
+  if (debug)
+    std::memset(page, ALIGN_PATTERN, pageSize);
+  for (unsigned i = 0; i < capacity; ++i)
+  {
+    GenericObject *object = reinterpret_cast<GenericObject *>(page + HeaderSize_ + i * MidBlockSize_);
+    object->Next = info->FreeList;
+    info->FreeList = object;
+
+    if (debug)
+    {
+      std::memset(reinterpret_cast<BYTE *>(object) + PTR_SIZE, UNALLOCATED_PATTERN, Stats_.ObjectSize_ - PTR_SIZE);
+      std::memset(GetLeftPadAdrress(object), PAD_PATTERN, Config_.PadBytes_);
+      std::memset(GetRightPadAdrress(object), PAD_PATTERN, Config_.PadBytes_);
+    }
+    std::memset(GetHeaderAddress(object), 0, Config_.HBlockInfo_.size_);
+  }
+
+  return info;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a page staged by the helper thread that was never
+  added to the allocator.
+
+\par info The staged page.
+*/
+/******************************************************************************/
+void ObjectAllocator::DeleteStagedPage(PageInfo *info)
+{
+  delete[] reinterpret_cast<BYTE *>(info->Page);
+  delete[] info->Occupancy;
+  delete[] info->Labels;
+  delete info;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function stops the helper thread, waiting for the page it is
+  staging, then frees the pages that were never adopted.
+*/
+/******************************************************************************/
+void ObjectAllocator::StopRefill()
+{
+  if (!Refill_)
+    return;
+
+  if (Refill_->Thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(Refill_->Mutex);
+      Refill_->Stop = true;
+    }
+    Refill_->Wake.notify_one();
+    Refill_->Thread.join();
+  }
+
+  PageInfo *info = Refill_->Staged.exchange(nullptr, std::memory_order_acquire);
+  while (info)
+  {
+    PageInfo *next = info->NextPartial;
+    DeleteStagedPage(info);
+    info = next;
+  }
+
+  delete Refill_;
+  Refill_ = nullptr;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any active object in the allocator.
+  Without header blocks, the in-use state comes from the per-page occupancy
+  bitmaps, so each block is checked in constant time.
+
+\par fn The callback function.
+\return The amount of bytes currently in use by the allocator.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::DumpMemoryInUse(DUMPCALLBACK fn) const
+{
+  if (!PageList_)
+    return 0;
+  else
+  {
+    unsigned bytesUsed = 0;
+    GenericObject *page = PageList_;
+
+    if (Config_.HBlockInfo_.type_ == OAConfig::hbNone && !Config_.PerPageFreeLists_)
+      RefreshOccupancy();
+
+    while (page)
+    {
+      const PageInfo *info = FindPage(reinterpret_cast<BYTE *>(page));
+      BYTE *pageData = reinterpret_cast<BYTE *>(page) + HeaderSize_;
+      for (size_t i = 0; i < info->Carved; ++i)
+      {
+        GenericObject *objectData = reinterpret_cast<GenericObject *>(pageData + i * MidBlockSize_);
+
+        if (IsObjectUsed(info, objectData))
+        {
+          fn(objectData, Stats_.ObjectSize_);
+          ++bytesUsed;
+        }
+      }
+      page = page->Next;
+    }
+
+    for (const GuardSlot &slot : Guards_)
+    {
+      if (slot.InUse)
+      {
+        fn(slot.Object, Stats_.ObjectSize_);
+        ++bytesUsed;
+      }
+    }
+    return bytesUsed;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any corrupted object in the allocator.
+
+\par fn The callback function.
+\par The number of blocks/objects that are corrupted.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::ValidatePages(VALIDATECALLBACK fn) const
+{
+  if (!Config_.DebugOn_ || Config_.PadBytes_ == 0)
+    return 0;
+
+  unsigned numBlocksCorrupted = 0;
+  GenericObject *page = PageList_;
+
+  while (page)
+  {
+    const PageInfo *info = FindPage(reinterpret_cast<BYTE *>(page));
+    BYTE *pageData = reinterpret_cast<BYTE *>(page) + HeaderSize_;
+    for (size_t i = 0; i < info->Carved; ++i)
+    {
+      GenericObject *objectData = reinterpret_cast<GenericObject *>(pageData + i * MidBlockSize_);
+
+      if (!ValidatePadding(GetLeftPadAdrress(objectData), Config_.PadBytes_) || !ValidatePadding(GetRightPadAdrress(objectData), Config_.PadBytes_))
+      {
+        fn(objectData, Stats_.ObjectSize_);
+        ++numBlocksCorrupted;
+        continue;
+      }
+    }
+    page = page->Next;
+  }
+  return numBlocksCorrupted;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks the padding of at most \p MaxBlocks blocks, going
+  through the pages in address order and starting where the previous call
+  stopped, so a large pool can be scanned continuously at a fixed cost per
+  call. Blocks never carved count against the budget without being
+  checked. A call never checks a block twice. Pages freed or added between
+  calls are handled: the scan resumes at the first page from where it
+  stopped.
+
+\par fn The callback function.
+\par MaxBlocks The most blocks to check in this call.
+\return The number of blocks found corrupted in this call.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::ValidatePagesIncremental(VALIDATECALLBACK fn, unsigned MaxBlocks)
+{
+  if (!Config_.DebugOn_ || Config_.PadBytes_ == 0 || PageIndex_.empty())
+    return 0;
+
+  auto page = std::lower_bound(PageIndex_.begin(), PageIndex_.end(), ValidatePage_,
+                               [](const PageInfo *lhs, const GenericObject *rhs) { return lhs->Page < rhs; });
+  unsigned block = ValidateBlock_;
+  if (page == PageIndex_.end() || (*page)->Page != ValidatePage_)
+    block = 0;
+  if (page == PageIndex_.end())
+    page = PageIndex_.begin();
+
+  size_t budget = std::min(static_cast<size_t>(MaxBlocks), PageBlocks_);
+  size_t checked = 0;
+  unsigned numBlocksCorrupted = 0;
+
+  while (checked < budget)
+  {
+    const PageInfo *info = *page;
+    BYTE *pageData = reinterpret_cast<BYTE *>(info->Page) + HeaderSize_;
+    for (; block < info->Carved && checked < budget; ++block, ++checked)
+    {
+      GenericObject *objectData = reinterpret_cast<GenericObject *>(pageData + block * MidBlockSize_);
+
+      if (!ValidatePadding(GetLeftPadAdrress(objectData), Config_.PadBytes_) || !ValidatePadding(GetRightPadAdrress(objectData), Config_.PadBytes_))
+      {
+        fn(objectData, Stats_.ObjectSize_);
+        ++numBlocksCorrupted;
+      }
+    }
+
+    if (block < info->Carved)
+      break;
+
+    checked += info->Capacity - block;
+    block = 0;
+    if (++page == PageIndex_.end())
+      page = PageIndex_.begin();
+  }
+
+  ValidatePage_ = (*page)->Page;
+  ValidateBlock_ = block;
+
+  return numBlocksCorrupted;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This checks for empty pages and frees their memory (return to OS).
+  With per-page free lists every page already knows how many of its blocks
+  are free, so this is a single pass over the pages. Otherwise the global
+  free list is walked once to count the free blocks of every page, and once
+  more to unlink the blocks of the pages being released.
+
+\return number of pages freed.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::FreeEmptyPages()
+{
+  if (Config_.RemoteFrees_)
+    CollectRemoteFrees();
+
+  if (!PageList_)
+    return 0;
+
+  if (!Config_.PerPageFreeLists_)
+    CountFreeObjects();
+
+  unsigned numEmptyPages = 0;
+  for (const PageInfo *info : PageIndex_)
+  {
+    if (IsPageFree(info))
+      ++numEmptyPages;
+  }
+
+  if (!numEmptyPages)
+    return 0;
+
+  if (!Config_.PerPageFreeLists_)
+    UnlinkFreePages();
+  ReleaseFreePages();
+
+  return numEmptyPages;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds pages until \p Objects objects can be allocated
+  without adding another, so that a burst of allocations does not pay for
+  new pages. The new pages are touched now: lazily carved pages are
+  zeroed, and other pages are already written when their blocks are
+  linked. Growth events of the profile have no label.
+
+\par Objects The number of objects to make room for.
+\return The number of them that can be allocated without a new page
+  (fewer than \p Objects when MaxPages_ is reached; 0 with
+  UseCPPMemManager_).
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::Reserve(unsigned Objects)
+{
+  if (Config_.UseCPPMemManager_)
+    return 0;
+
+  if (Config_.RemoteFrees_ && Stats_.FreeObjects_ < Objects)
+    CollectRemoteFrees();
+
+  if (Profile_)
+    Profile_->Label = 0;
+
+  while (Stats_.FreeObjects_ < Objects && (!Config_.MaxPages_ || Stats_.PagesInUse_ < Config_.MaxPages_))
+  {
+    GrowPages();
+
+    // only lazily carved pages are still untouched
+    const PageInfo *info = FindPage(reinterpret_cast<BYTE *>(PageList_));
+    if (!info->Carved)
+      std::memset(reinterpret_cast<BYTE *>(info->Page) + HeaderSize_, 0, info->Size - HeaderSize_);
+  }
+
+  return std::min(Objects, Stats_.FreeObjects_);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees the pages added by Reserve that were not used, and
+  every other page with no object in use, then trims the page index to
+  the pages left. Pages staged by the background refill are adopted
+  first, so they are freed too.
+
+\return number of pages freed.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::ShrinkToFit()
+{
+  AdoptStagedPages();
+  unsigned freed = FreeEmptyPages();
+
+  PageIndex_.shrink_to_fit();
+  CarveQueue_.shrink_to_fit();
+  return freed;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function moves the objects of the emptiest pages into the free
+  blocks of the fullest ones, then frees the pages it emptied, so a pool
+  fragmented by churn gives back its memory without being torn down.
+  Pages are ranked by the share of their blocks in use; the fullest pages
+  that together have room for every object are kept, and every other page
+  is emptied. An object is moved by copying its bytes (and its header) to
+  a free block of a kept page, so it must be safe to move with memcpy.
+  Then \p fn is called with the old and the new address, so the client can
+  patch its pointers. The old block still holds the object until Compact
+  returns. Guarded blocks are never moved. Objects handed over by other
+  threads are collected first, so no other thread may use the allocator
+  during the call.
+
+\par fn The callback function (may be null).
+\par Context Passed to \p fn as is.
+\return The number of pages freed (0 with UseCPPMemManager_).
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::Compact(RELOCATECALLBACK fn, void *Context)
+{
+  if (Config_.UseCPPMemManager_)
+    return 0;
+
+  if (Config_.RemoteFrees_)
+    CollectRemoteFrees();
+
+  std::vector<PageInfo *> pages;
+  try
+  {
+    pages = PageIndex_;
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "Compact: No system memory available!");
+  }
+
+  // with a global free list, the counts (and the use bits) are brought up
+  // to date with one walk of the free list
+  if (!Config_.PerPageFreeLists_ && Config_.HBlockInfo_.type_ == OAConfig::hbNone)
+  {
+    RefreshOccupancy();
+    for (PageInfo *info : PageIndex_)
+    {
+      unsigned used = 0;
+      for (size_t i = 0; i < (info->Capacity + WORD_BITS - 1) / WORD_BITS; ++i)
+        used += static_cast<unsigned>(std::bitset<WORD_BITS>(info->Occupancy[i]).count());
+      info->FreeCount = info->Capacity - used;
+    }
+  }
+  else if (!Config_.PerPageFreeLists_)
+    CountFreeObjects();
+
+  std::sort(pages.begin(), pages.end(), [](const PageInfo *lhs, const PageInfo *rhs) {
+    return (lhs->Capacity - lhs->FreeCount) * static_cast<uint64_t>(rhs->Capacity) >
+           (rhs->Capacity - rhs->FreeCount) * static_cast<uint64_t>(lhs->Capacity);
+  });
+
+  size_t objects = 0;
+  for (const PageInfo *info : pages)
+    objects += info->Capacity - info->FreeCount;
+
+  size_t kept = 0;
+  for (size_t room = 0; room < objects; ++kept)
+    room += pages[kept]->Capacity;
+
+  if (kept == pages.size())
+    return 0;
+
+  // the pages to empty count as free from now on, so that their free
+  // blocks are never the target of a move
+  for (size_t i = kept; i < pages.size(); ++i)
+    pages[i]->FreeCount = pages[i]->Capacity;
+
+  // the free list is made again from the kept pages alone, fullest first
+  if (!Config_.PerPageFreeLists_)
+  {
+    CarveQueue_.clear();
+    if (CarvePage_ && IsPageFree(CarvePage_))
+      CarvePage_ = nullptr;
+
+    FreeList_ = nullptr;
+    for (size_t i = kept; i > 0; --i)
+    {
+      PageInfo *info = pages[i - 1];
+      BYTE *pageData = reinterpret_cast<BYTE *>(info->Page) + HeaderSize_;
+      for (unsigned slot = info->Carved; slot > 0; --slot)
+      {
+        GenericObject *object = reinterpret_cast<GenericObject *>(pageData + (slot - 1) * MidBlockSize_);
+        if (!IsObjectUsed(info, object))
+        {
+          object->Next = FreeList_;
+          FreeList_ = object;
+        }
+      }
+    }
+  }
+
+  size_t target = 0;
+  for (size_t i = kept; i < pages.size(); ++i)
+  {
+    PageInfo *info = pages[i];
+    BYTE *pageData = reinterpret_cast<BYTE *>(info->Page) + HeaderSize_;
+    for (unsigned slot = 0; slot < info->Carved; ++slot)
+    {
+      GenericObject *from = reinterpret_cast<GenericObject *>(pageData + slot * MidBlockSize_);
+      if (!IsObjectUsed(info, from))
+        continue;
+
+      GenericObject *to = nullptr;
+      if (Config_.PerPageFreeLists_)
+      {
+        while (!pages[target]->FreeCount)
+          ++target;
+        to = PopFromPageFreeList(pages[target]);
+        if (pages[target]->Occupancy)
+          SetOccupied(pages[target], to, true);
+      }
+      else if (FreeList_)
+      {
+        to = FreeList_;
+        FreeList_ = FreeList_->Next;
+      }
+      else
+        to = CarveBlock(CarvePage_);
+
+      MoveBlock(info, from, to);
+      if (fn)
+        fn(from, to, Context);
+    }
+  }
+
+  ReleaseFreePages();
+
+  return static_cast<unsigned>(pages.size() - kept);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function records a block moved by Compact in the OARelocationMap
+  given as the context. Clients that can only patch their pointers after
+  the move pass it to Compact, then look every pointer up in the map.
+
+\par OldAddress The address of the block before the move.
+\par NewAddress The address of the block after the move.
+\par Map The OARelocationMap to add the move to.
+*/
+/******************************************************************************/
+void ObjectAllocator::RecordRelocation(const void *OldAddress, void *NewAddress, void *Map)
+{
+  (*static_cast<OARelocationMap *>(Map))[OldAddress] = NewAddress;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function releases every object at once, in one pass over the pages
+  that never visits the objects themselves. Kept pages are emptied and
+  carved again block by block as they are needed, as with lazy carving, so
+  allocating from them next time costs the same as from a new page.
+  Headers are reset by the carving; the records of external headers are
+  all released with their chunks. Objects handed over by other threads are
+  dropped with the rest, so no other thread may use the allocator during
+  the call.
+
+\par KeepPages Keep the pages for reuse (true) or give them all back (false).
+\return Whether the objects were released (false with UseCPPMemManager_).
+*/
+/******************************************************************************/
+bool ObjectAllocator::ResetAll(bool KeepPages)
+{
+  if (Config_.UseCPPMemManager_)
+    return false;
+
+  try
+  {
+    if (KeepPages && !Config_.PerPageFreeLists_)
+      CarveQueue_.reserve(PageIndex_.size());
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "ResetAll: No system memory available!");
+  }
+
+  RemoteFreeList_.store(nullptr, std::memory_order_relaxed);
+
+  for (size_t i = 0; i < Guards_.size(); ++i)
+  {
+    if (Guards_[i].InUse)
+    {
+      Guards_[i].InUse = false;
+      Guards_[i].FreedAt = ++GuardFrees_;
+      ProtectGuardSlot(i);
+    }
+  }
+
+  if (Config_.HBlockInfo_.type_ == OAConfig::hbExternal)
+  {
+    for (MemBlockInfo *chunk : InfoChunks_)
+      delete[] chunk;
+    InfoChunks_.clear();
+    FreeInfos_ = nullptr;
+  }
+
+  Stats_.Deallocations_ += Stats_.ObjectsInUse_;
+  Stats_.ObjectsInUse_ = 0;
+  if (Profile_)
+  {
+    OAProfile &profile = Profile_->Profile;
+    profile.Deallocations_ += profile.ObjectsInUse_;
+    profile.ObjectsInUse_ = 0;
+    for (OALabelProfile &label : profile.Labels_)
+    {
+      label.Deallocations_ += label.ObjectsInUse_;
+      label.ObjectsInUse_ = 0;
+    }
+  }
+
+  FreeList_ = nullptr;
+  CarvePage_ = nullptr;
+  CarveQueue_.clear();
+  std::fill(PartialPages_.begin(), PartialPages_.end(), nullptr);
+  FirstBucket_ = static_cast<unsigned>(PartialPages_.size());
+
+  if (!KeepPages)
+  {
+    for (PageInfo *info : PageIndex_)
+    {
+      ReleasePageMemory(reinterpret_cast<BYTE *>(info->Page), info->Size);
+      delete[] info->Occupancy;
+      delete[] info->Labels;
+      delete info;
+    }
+    if (Profile_)
+    {
+      Profile_->Profile.PagesFreed_ += PageIndex_.size();
+      Profile_->LastPage = nullptr;
+    }
+
+    PageIndex_.clear();
+    PageTable_.resize(1);
+    FreeNumbers_.clear();
+    PageList_ = nullptr;
+    PageBlocks_ = 0;
+    Stats_.PagesInUse_ = 0;
+    Stats_.FreeObjects_ = 0;
+    return true;
+  }
+
+  // pages are used again from the lowest address up
+  for (auto it = PageIndex_.rbegin(); it != PageIndex_.rend(); ++it)
+  {
+    PageInfo *info = *it;
+    info->FreeList = nullptr;
+    info->FreeCount = info->Capacity;
+    info->Carved = 0;
+    if (info->Occupancy)
+      std::fill(info->Occupancy, info->Occupancy + (info->Capacity + WORD_BITS - 1) / WORD_BITS, 0U);
+
+    if (Config_.PerPageFreeLists_)
+      LinkPartialPage(info);
+    else
+      CarveQueue_.push_back(info);
+  }
+
+  if (!CarveQueue_.empty())
+  {
+    CarvePage_ = CarveQueue_.back();
+    CarveQueue_.pop_back();
+  }
+
+  Stats_.FreeObjects_ = static_cast<unsigned>(PageBlocks_);
+  return true;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function makes the calling thread the owner of the allocator, e.g.
+  when the allocator is created on one thread and handed to another. Only
+  the owner may allocate; with remote frees enabled, any thread may free.
+  Must not be called while other threads are using the allocator.
+*/
+/******************************************************************************/
+void ObjectAllocator::SetOwnerThread()
+{
+  Owner_ = std::this_thread::get_id();
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function sets the debug state of the object allocator
+
+\par State Send \p true to turn on debugging, \p false to turn off debugging.
+*/
+/******************************************************************************/
+void ObjectAllocator::SetDebugState(bool State)
+{
+  Config_.DebugOn_ = State;
+  UpdateFastPaths();
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the free list of the object allocator.
+
+\return Pointer to the free list.
+*/
+/******************************************************************************/
+const void *ObjectAllocator::GetFreeList() const
+{
+  if (Config_.PerPageFreeLists_)
+    return FullestPartialPage() ? FullestPartialPage()->FreeList : nullptr;
+
+  return FreeList_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the page list of the object allocator.
+
+\return Pointer to the page list.
+*/
+/******************************************************************************/
+const void *ObjectAllocator::GetPageList() const
+{
+  return PageList_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the configuration of the object allocator.
+
+\return A copy of this allocator's configuration.
+*/
+/******************************************************************************/
+OAConfig ObjectAllocator::GetConfig() const
+{
+  return Config_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the statistics of the object allocator.
+
+\return A copy of this allocator's statistics.
+*/
+/******************************************************************************/
+OAStats ObjectAllocator::GetStats() const
+{
+  OAStats stats = Stats_;
+  stats.Capacity_ = static_cast<unsigned>(PageBlocks_);
+  return stats;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the allocation profile of the object allocator.
+  The page events are put in order from oldest to newest.
+
+\return A copy of this allocator's profile (empty unless profiling).
+*/
+/******************************************************************************/
+OAProfile ObjectAllocator::GetProfile() const
+{
+  if (!Profile_)
+    return OAProfile();
+
+  OAProfile profile = Profile_->Profile;
+  std::rotate(profile.PageEvents_.begin(), profile.PageEvents_.begin() + Profile_->NextEvent,
+              profile.PageEvents_.end());
+  return profile;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates new memory for a page. Every block is put on the
+  free list(s) right away, unless blocks are carved lazily; then only the
+  page is linked in, and its blocks are formatted by CarveBlock when they
+  are first needed, so the page is not touched (or even zeroed) up front.
+
+\par pageList A pointer to the previous page list.
+*/
+/******************************************************************************/
+void ObjectAllocator::AllocateNewPage(GenericObject *&pageList)
+{
+  if (Config_.MaxPages_ && Stats_.PagesInUse_ == Config_.MaxPages_)
+  {
+    throw OAException(OAException::OA_EXCEPTION::E_NO_PAGES, "Out of pages!");
+  }
+  else
+  {
+    unsigned capacity = NextPageCapacity();
+    size_t pageSize = PTR_SIZE + Config_.LeftAlignSize_ + capacity * MidBlockSize_ - Config_.InterAlignSize_;
+    GenericObject *newPage = nullptr;
+    PageInfo *info = nullptr;
+    try
+    {
+      newPage = reinterpret_cast<GenericObject *>(AllocatePageMemory(pageSize, !Config_.LazyCarving_));
+      info = new PageInfo{newPage, nullptr, 0, nullptr, nullptr, nullptr,
+                          Config_.LazyCarving_ ? 0 : capacity, 0, nullptr, capacity, pageSize, 0};
+      if (Config_.HBlockInfo_.type_ == OAConfig::hbNone)
+        info->Occupancy = new unsigned[(capacity + WORD_BITS - 1) / WORD_BITS]();
+      if (Profile_)
+        info->Labels = new unsigned[capacity];
+
+      auto position = std::lower_bound(PageIndex_.begin(), PageIndex_.end(), newPage,
+                                       [](const PageInfo *lhs, const GenericObject *rhs) { return lhs->Page < rhs; });
+      if (Config_.LazyCarving_ && !Config_.PerPageFreeLists_ && CarvePage_)
+        CarveQueue_.reserve(CarveQueue_.size() + 1);
+      if (Config_.Handles_)
+        ReservePageNumbers(1);
+      PageIndex_.insert(position, info);
+      if (Config_.Handles_)
+        NumberPage(info);
+      ++Stats_.PagesInUse_;
+      PageBlocks_ += capacity;
+    }
+    catch (std::bad_alloc &)
+    {
+      if (info)
+      {
+        delete[] info->Occupancy;
+        delete[] info->Labels;
+      }
+      delete info;
+      if (newPage)
+        ReleasePageMemory(reinterpret_cast<BYTE *>(newPage), pageSize);
+      throw OAException{OAException::OA_EXCEPTION::E_NO_MEMORY, "AllocateNewPage: No system memory available!"};
+    }
+
+    if (Config_.DebugOn_)
+    {
+      std::memset(newPage, ALIGN_PATTERN, Config_.LazyCarving_ ? HeaderSize_ : pageSize);
+    }
+
+    newPage->Next = pageList;
+    pageList = newPage;
+
+    if (Profile_)
+      RecordPageGrowth();
+
+    if (Config_.LazyCarving_)
+    {
+      info->FreeCount = capacity;
+      Stats_.FreeObjects_ += capacity;
+
+      if (Config_.PerPageFreeLists_)
+        LinkPartialPage(info);
+      else
+      {
+        // pages added by Reserve wait for the page being carved
+        if (CarvePage_)
+          CarveQueue_.insert(CarveQueue_.begin(), info);
+        else
+          CarvePage_ = info;
+      }
+      return;
+    }
+
+    BYTE *PageStartAddress = reinterpret_cast<BYTE *>(newPage);
+    BYTE *DataStartAddress = PageStartAddress + HeaderSize_;
+
+    for (; static_cast<size_t>(DataStartAddress - PageStartAddress) < pageSize;
+         DataStartAddress += MidBlockSize_)
+    {
+      GenericObject *dataAddress = reinterpret_cast<GenericObject *>(DataStartAddress);
+
+      if (Config_.PerPageFreeLists_)
+        PushToPageFreeList(info, dataAddress);
+      else
+        PushToFreeList(dataAddress);
+
+      if (Config_.DebugOn_)
+      {
+        std::memset(reinterpret_cast<BYTE *>(dataAddress) + PTR_SIZE, UNALLOCATED_PATTERN, Stats_.ObjectSize_ - PTR_SIZE);
+        std::memset(GetLeftPadAdrress(dataAddress), PAD_PATTERN, Config_.PadBytes_);
+        std::memset(GetRightPadAdrress(dataAddress), PAD_PATTERN, Config_.PadBytes_);
+      }
+      std::memset(GetHeaderAddress(dataAddress), 0, Config_.HBlockInfo_.size_);
+    }
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function puts an object at the front of the free list.
+
+\par object The object to put on the free list.
+*/
+/******************************************************************************/
+void ObjectAllocator::PushToFreeList(GenericObject *object)
+{
+  GenericObject *temp = FreeList_;
+  FreeList_ = object;
+  object->Next = temp;
+
+  Stats_.FreeObjects_++;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function puts an object at the front of its page's free list. A page
+  that was full becomes a candidate for allocation again.
+
+\par page The page that holds the object.
+\par object The object to put on the free list.
+*/
+/******************************************************************************/
+void ObjectAllocator::PushToPageFreeList(PageInfo *page, GenericObject *object)
+{
+  object->Next = page->FreeList;
+  page->FreeList = object;
+
+  if (page->FreeCount++ == 0)
+    LinkPartialPage(page);
+  else
+    UpdateBucket(page);
+
+  Stats_.FreeObjects_++;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes the object at the front of a page's free list, or
+  carves a new one when the list is empty. A page that becomes full is no
+  longer considered for allocation.
+
+\par page The page to take the object from.
+\return The object taken off the free list.
+*/
+/******************************************************************************/
+GenericObject *ObjectAllocator::PopFromPageFreeList(PageInfo *page)
+{
+  GenericObject *object = page->FreeList;
+  if (object)
+    page->FreeList = object->Next;
+  else
+    object = CarveBlock(page);
+
+  if (--page->FreeCount == 0)
+    UnlinkPartialPage(page);
+  else
+    UpdateBucket(page);
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function carves the next block off a page: its header, padding and
+  alignment bytes are written now, instead of when the page was allocated.
+  The client's bytes are left for Allocate to fill in.
+
+\par page The page to carve from (must have uncarved blocks).
+\return The block carved.
+*/
+/******************************************************************************/
+GenericObject *ObjectAllocator::CarveBlock(PageInfo *page)
+{
+  BYTE *block = reinterpret_cast<BYTE *>(page->Page) + HeaderSize_ + page->Carved * MidBlockSize_;
+  GenericObject *object = reinterpret_cast<GenericObject *>(block);
+
+  if (++page->Carved == page->Capacity && page == CarvePage_)
+  {
+    CarvePage_ = CarveQueue_.empty() ? nullptr : CarveQueue_.back();
+    if (CarvePage_)
+      CarveQueue_.pop_back();
+  }
+
+  if (Config_.DebugOn_)
+  {
+    std::memset(GetLeftPadAdrress(object), PAD_PATTERN, Config_.PadBytes_);
+    std::memset(GetRightPadAdrress(object), PAD_PATTERN, Config_.PadBytes_);
+    if (page->Carved < page->Capacity)
+      std::memset(GetRightPadAdrress(object) + Config_.PadBytes_, ALIGN_PATTERN, Config_.InterAlignSize_);
+  }
+  std::memset(GetHeaderAddress(object), 0, Config_.HBlockInfo_.size_);
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds a page to the front of the pages with free blocks, in
+  the bucket for its number of free blocks.
+
+\par page The page to add.
+*/
+/******************************************************************************/
+void ObjectAllocator::LinkPartialPage(PageInfo *page)
+{
+  unsigned bucket = BucketOf(page);
+
+  page->Bucket = bucket;
+  page->PrevPartial = nullptr;
+  page->NextPartial = PartialPages_[bucket];
+  if (PartialPages_[bucket])
+    PartialPages_[bucket]->PrevPartial = page;
+  PartialPages_[bucket] = page;
+
+  if (bucket < FirstBucket_)
+    FirstBucket_ = bucket;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function removes a page from the pages with free blocks.
+
+\par page The page to remove.
+*/
+/******************************************************************************/
+void ObjectAllocator::UnlinkPartialPage(PageInfo *page)
+{
+  if (page->PrevPartial)
+    page->PrevPartial->NextPartial = page->NextPartial;
+  else
+    PartialPages_[page->Bucket] = page->NextPartial;
+
+  if (page->NextPartial)
+    page->NextPartial->PrevPartial = page->PrevPartial;
+
+  page->PrevPartial = nullptr;
+  page->NextPartial = nullptr;
+
+  while (FirstBucket_ < PartialPages_.size() && !PartialPages_[FirstBucket_])
+    ++FirstBucket_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function moves a page with free blocks to the bucket that matches
+  its number of free blocks, after it changed. With a single bucket (the
+  default) a page never moves.
+
+\par page The page to move.
+*/
+/******************************************************************************/
+void ObjectAllocator::UpdateBucket(PageInfo *page)
+{
+  if (PartialPages_.size() > 1 && BucketOf(page) != page->Bucket)
+  {
+    UnlinkPartialPage(page);
+    LinkPartialPage(page);
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the occupancy bucket of a page. Bucket 0 holds the
+  fullest pages, the last bucket the emptiest ones. Pages of different
+  sizes are bucketed by the share of their blocks that is free.
+
+\par page The page (with at least 1 free block).
+\return The bucket of the page.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::BucketOf(const PageInfo *page) const
+{
+  return static_cast<unsigned>((page->FreeCount - 1ULL) * PartialPages_.size() / page->Capacity);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the page the next block is taken from: the front
+  page of the fullest bucket that has pages. Taking blocks from the fullest
+  pages first lets the emptiest pages drain, so FreeEmptyPages can release
+  them.
+
+\return The page to allocate from, or null if every page is full.
+*/
+/******************************************************************************/
+ObjectAllocator::PageInfo *ObjectAllocator::FullestPartialPage() const
+{
+  return FirstBucket_ < PartialPages_.size() ? PartialPages_[FirstBucket_] : nullptr;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function recounts the free blocks of every page in a single walk of
+  the global free list, plus the blocks not carved yet. Only needed without
+  per-page free lists, where the counts are not kept up to date by Allocate
+  and Free.
+*/
+/******************************************************************************/
+void ObjectAllocator::CountFreeObjects()
+{
+  for (PageInfo *info : PageIndex_)
+    info->FreeCount = info->Capacity - info->Carved;
+
+  for (GenericObject *object = FreeList_; object; object = object->Next)
+    ++FindPage(reinterpret_cast<BYTE *>(object))->FreeCount;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function hands a chain of blocks freed by a thread other than the
+  owner to the owner. The chain is pushed onto a lock-free stack with a
+  single compare-and-swap; nothing else of the allocator is touched, so no
+  checks are made here. The owner runs the usual checks when it collects
+  the blocks.
+
+\par first The first block of the chain.
+\par last The last block of the chain (the same as \p first for one block).
+*/
+/******************************************************************************/
+void ObjectAllocator::PushToRemoteFreeList(GenericObject *first, GenericObject *last)
+{
+  GenericObject *head = RemoteFreeList_.load(std::memory_order_relaxed);
+  do
+  {
+    last->Next = head;
+  } while (!RemoteFreeList_.compare_exchange_weak(head, first, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees every block handed over by other threads. The whole
+  stack is taken with one exchange, so there is no ABA problem with the
+  pushes that keep coming in meanwhile. If a block fails the debug checks,
+  the blocks not yet freed are handed back before the exception leaves.
+*/
+/******************************************************************************/
+void ObjectAllocator::CollectRemoteFrees()
+{
+  GenericObject *object = RemoteFreeList_.exchange(nullptr, std::memory_order_acquire);
+
+  while (object)
+  {
+    GenericObject *next = object->Next;
+    try
+    {
+      FreeLocal(object);
+    }
+    catch (const OAException &)
+    {
+      if (next)
+      {
+        GenericObject *last = next;
+        while (last->Next)
+          last = last->Next;
+        PushToRemoteFreeList(next, last);
+      }
+      throw;
+    }
+    object = next;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a given address is on a valid boundary.
+
+\par address The address to validate.
+*/
+/******************************************************************************/
+void ObjectAllocator::CheckBoundaries(unsigned char *address) const
+{
+  PageInfo *page = FindPage(address);
+
+  if (!page)
+    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
+
+  BYTE *pageStart = reinterpret_cast<BYTE *>(page->Page);
+
+  if (static_cast<unsigned>(address - pageStart) < HeaderSize_)
+    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
+
+  pageStart += HeaderSize_;
+  long displacement = address - pageStart;
+  if (static_cast<size_t>(displacement) % MidBlockSize_ != 0)
+    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
+
+  // blocks that were never carved were never handed out
+  if (static_cast<size_t>(displacement) / MidBlockSize_ >= page->Carved)
+    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a given padding address is valid.
+
+\par address The address to validate.
+\return Returns \p true if padding is valid, else \p false if corrupted.
+*/
+/******************************************************************************/
+bool ObjectAllocator::ValidatePadding(unsigned char *paddingAddress, size_t size) const
+{
+  return MatchesPattern(paddingAddress, size, ObjectAllocator::PAD_PATTERN);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a given address is in a page.
+
+\par page The page to check.
+\par address The address to check.
+\return Returns \p true if address is in page, else \p false.
+*/
+/******************************************************************************/
+bool ObjectAllocator::IsObjectInPage(const PageInfo *page, unsigned char *address) const
+{
+  return (address >= reinterpret_cast<BYTE *>(page->Page) &&
+          address < reinterpret_cast<BYTE *>(page->Page) + page->Size);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the page that contains a given address. The page index
+  is kept sorted by address, so this is a binary search instead of a walk of
+  the page list.
+
+\par address The address to look up.
+\return The page containing the address, or \p nullptr if it is not on any page.
+*/
+/******************************************************************************/
+ObjectAllocator::PageInfo *ObjectAllocator::FindPage(unsigned char *address) const
+{
+  GenericObject *object = reinterpret_cast<GenericObject *>(address);
+  auto it = std::upper_bound(PageIndex_.begin(), PageIndex_.end(), object,
+                             [](const GenericObject *lhs, const PageInfo *rhs) { return lhs < rhs->Page; });
+
+  if (it == PageIndex_.begin())
+    return nullptr;
+
+  PageInfo *page = *(it - 1);
+  return IsObjectInPage(page, address) ? page : nullptr;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a given block address is currently used.
+
+\par page The page that holds the block.
+\par object The object to check.
+\return Returns \p true if block is used, else \p false.
+*/
+/******************************************************************************/
+bool ObjectAllocator::IsObjectUsed(const PageInfo *page, GenericObject *object) const
+{
+  switch (Config_.HBlockInfo_.type_)
+  {
+  case OAConfig::HBLOCK_TYPE::hbNone:
+  {
+    unsigned slot = BlockIndex(page, object);
+    return (page->Occupancy[slot / WORD_BITS] >> (slot % WORD_BITS)) & 1U;
+  }
+  case OAConfig::HBLOCK_TYPE::hbBasic:
+  case OAConfig::HBLOCK_TYPE::hbExtended:
+  {
+    BYTE *flagByte = reinterpret_cast<BYTE *>(object) - Config_.PadBytes_ - 1;
+    return *flagByte;
+  }
+  case OAConfig::HBLOCK_TYPE::hbExternal:
+  {
+    return *reinterpret_cast<MemBlockInfo **>(GetHeaderAddress(object)) != nullptr;
+  }
+  default:
+    return false;
+    break;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the slot of a block within its page.
+
+\par page The page that holds the block.
+\par object The block.
+\return The zero-based slot of the block.
+*/
+/******************************************************************************/
+unsigned ObjectAllocator::BlockIndex(const PageInfo *page, GenericObject *object) const
+{
+  BYTE *firstBlock = reinterpret_cast<BYTE *>(page->Page) + HeaderSize_;
+  return static_cast<unsigned>((reinterpret_cast<BYTE *>(object) - firstBlock) / MidBlockSize_);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function sets or clears the occupancy bit of a block.
+
+\par page The page that holds the block.
+\par object The block.
+\par used \p true if the block is now in use, else \p false.
+*/
+/******************************************************************************/
+void ObjectAllocator::SetOccupied(PageInfo *page, GenericObject *object, bool used)
+{
+  unsigned slot = BlockIndex(page, object);
+  unsigned mask = 1U << (slot % WORD_BITS);
+
+  if (used)
+    page->Occupancy[slot / WORD_BITS] |= mask;
+  else
+    page->Occupancy[slot / WORD_BITS] &= ~mask;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function rebuilds the occupancy bitmaps of every page with one walk of
+  the global free list. With a single free list, Allocate and Free do not
+  know which page a block belongs to, so the bitmaps are brought up to date
+  here instead of on every call.
+*/
+/******************************************************************************/
+void ObjectAllocator::RefreshOccupancy() const
+{
+  for (PageInfo *info : PageIndex_)
+  {
+    size_t words = (info->Capacity + WORD_BITS - 1) / WORD_BITS;
+    size_t tailBits = info->Capacity % WORD_BITS;
+    for (size_t i = 0; i < words; ++i)
+      info->Occupancy[i] = ~0U;
+    if (tailBits)
+      info->Occupancy[words - 1] = (1U << tailBits) - 1;
+
+    for (unsigned slot = info->Carved; slot < info->Capacity; ++slot)
+      info->Occupancy[slot / WORD_BITS] &= ~(1U << (slot % WORD_BITS));
+  }
+
+  for (GenericObject *object = FreeList_; object; object = object->Next)
+  {
+    PageInfo *info = FindPage(reinterpret_cast<BYTE *>(object));
+    unsigned slot = BlockIndex(info, object);
+    info->Occupancy[slot / WORD_BITS] &= ~(1U << (slot % WORD_BITS));
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a given page is not used at all.
+
+\par page The page to check.
+\return Returns \p true if page is free, else \p false.
+*/
+/******************************************************************************/
+bool ObjectAllocator::IsPageFree(const PageInfo *page) const
+{
+  return page->FreeCount == page->Capacity;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns memory used by a page back to the OS. The page must
+  already be unlinked from the page list and its blocks from the global
+  free list; the caller removes it from the page index.
+
+\par page The page to free.
+*/
+/******************************************************************************/
+void ObjectAllocator::FreePage(PageInfo *page)
+{
+  if (Config_.PerPageFreeLists_)
+    UnlinkPartialPage(page);
+  if (page == CarvePage_)
+    CarvePage_ = nullptr;
+
+  Stats_.FreeObjects_ -= page->FreeCount;
+  PageBlocks_ -= page->Capacity;
+
+  // room was made for the number when the page got it
+  if (Config_.Handles_)
+  {
+    PageTable_[page->Number] = nullptr;
+    FreeNumbers_.push_back(page->Number);
+  }
+
+  ReleasePageMemory(reinterpret_cast<BYTE *>(page->Page), page->Size);
+  delete[] page->Occupancy;
+  delete[] page->Labels;
+  delete page;
+  --Stats_.PagesInUse_;
+
+  if (Profile_)
+  {
+    ++Profile_->Profile.PagesFreed_;
+    if (Profile_->LastPage == page)
+      Profile_->LastPage = nullptr;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes the free pages out of the global free list: they are
+  dropped from the carve queue, and their blocks are unlinked from the
+  free list. The free block counts of the pages must be up to date.
+*/
+/******************************************************************************/
+void ObjectAllocator::UnlinkFreePages()
+{
+  // pages waiting to be carved are always empty
+  CarveQueue_.erase(std::remove_if(CarveQueue_.begin(), CarveQueue_.end(),
+                                   [this](const PageInfo *info) { return IsPageFree(info); }),
+                    CarveQueue_.end());
+  if (CarvePage_ && IsPageFree(CarvePage_))
+    CarvePage_ = nullptr;
+
+  GenericObject **link = &FreeList_;
+  while (*link)
+  {
+    if (IsPageFree(FindPage(reinterpret_cast<BYTE *>(*link))))
+      *link = (*link)->Next;
+    else
+      link = &(*link)->Next;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function unlinks every free page from the page list, frees it, and
+  removes it from the page index. With a global free list, UnlinkFreePages
+  must have been called first.
+*/
+/******************************************************************************/
+void ObjectAllocator::ReleaseFreePages()
+{
+  GenericObject **pageLink = &PageList_;
+  while (*pageLink)
+  {
+    if (IsPageFree(FindPage(reinterpret_cast<BYTE *>(*pageLink))))
+      *pageLink = (*pageLink)->Next;
+    else
+      pageLink = &(*pageLink)->Next;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < PageIndex_.size(); ++i)
+  {
+    if (IsPageFree(PageIndex_[i]))
+      FreePage(PageIndex_[i]);
+    else
+      PageIndex_[kept++] = PageIndex_[i];
+  }
+  PageIndex_.resize(kept);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function copies an object and its header to a free block, for
+  Compact. The use counter of an extended header belongs to the block, so
+  the new block keeps its own, counting the move as one more use.
+
+\par fromPage The page of the object.
+\par from The block of the object.
+\par to The free block taken for it.
+*/
+/******************************************************************************/
+void ObjectAllocator::MoveBlock(PageInfo *fromPage, GenericObject *from, GenericObject *to)
+{
+  std::memcpy(to, from, Stats_.ObjectSize_);
+
+  BYTE *toHeader = GetHeaderAddress(to);
+  if (Config_.HBlockInfo_.type_ == OAConfig::hbExtended)
+  {
+    unsigned short *counter = reinterpret_cast<unsigned short *>(toHeader + Config_.HBlockInfo_.additional_);
+    unsigned short uses = *counter;
+    std::memcpy(toHeader, GetHeaderAddress(from), Config_.HBlockInfo_.size_);
+    *counter = static_cast<unsigned short>(uses + 1);
+  }
+  else
+    std::memcpy(toHeader, GetHeaderAddress(from), Config_.HBlockInfo_.size_);
+
+  if (Profile_)
+  {
+    PageInfo *toPage = ProfilePage(to);
+    toPage->Labels[BlockIndex(toPage, to)] = fromPage->Labels[BlockIndex(fromPage, from)];
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function makes room in the page table for \p count more pages, and
+  as much in the list of free numbers, so that neither NumberPage nor
+  FreePage has to allocate.
+
+\par count The number of pages about to be added.
+*/
+/******************************************************************************/
+void ObjectAllocator::ReservePageNumbers(size_t count)
+{
+  size_t needed = PageTable_.size() + count;
+  if (PageTable_.capacity() < needed)
+    PageTable_.reserve(std::max(needed, 2 * PageTable_.capacity()));
+  if (FreeNumbers_.capacity() < PageTable_.capacity())
+    FreeNumbers_.reserve(PageTable_.capacity());
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This checks for empty pages and frees their memory (return to OS).
+  This function gives a page the number freed last, or a new one, and
+  enters its first block in the page table. ReservePageNumbers must have
+  made room for it.
 
-\return number of pages freed.
+\par info The page.
 */
 /******************************************************************************/
-unsigned ObjectAllocator::FreeEmptyPages()
+void ObjectAllocator::NumberPage(PageInfo *info)
 {
-  if (!PageList_)
-    return 0;
-  unsigned numEmptyPages = 0;
-  GenericObject *tempHead = PageList_;
-  GenericObject *prevHead = nullptr;
-
-  while (tempHead && IsPageFree(tempHead))
+  if (FreeNumbers_.empty())
   {
-    PageList_ = tempHead->Next;
-    FreePage(tempHead);
-    tempHead = this->PageList_;
-    ++numEmptyPages;
+    info->Number = static_cast<unsigned>(PageTable_.size());
+    PageTable_.push_back(nullptr);
   }
-
-  while (tempHead)
+  else
   {
-    while (tempHead && !IsPageFree(tempHead))
-    {
-      prevHead = tempHead;
-      tempHead = tempHead->Next;
-    }
-
-    if (!tempHead)
-      return numEmptyPages;
-
-    prevHead->Next = tempHead->Next;
-    FreePage(tempHead);
-
-    tempHead = prevHead->Next;
-    ++numEmptyPages;
+    info->Number = FreeNumbers_.back();
+    FreeNumbers_.pop_back();
   }
-  return numEmptyPages;
+
+  PageTable_[info->Number] = reinterpret_cast<BYTE *>(info->Page) + HeaderSize_;
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function sets the debug state of the object allocator
-
-\par State Send \p true to turn on debugging, \p false to turn off debugging.
+  This function returns the number of blocks of the next page. Pages all
+  have ObjectsPerPage_ blocks, unless they grow: then the next page holds
+  GrowthFactor_ - 1 times the blocks of the pages in use, so the blocks
+  together grow GrowthFactor_ times with each page, up to
+  MaxObjectsPerPage_ blocks a page. Freeing pages makes the next ones
+  smaller again.
+
+\return The number of blocks of the next page.
 */
 /******************************************************************************/
-void ObjectAllocator::SetDebugState(bool State)
+unsigned ObjectAllocator::NextPageCapacity() const
 {
-  Config_.DebugOn_ = State;
+  size_t capacity = (Config_.GrowthFactor_ - 1ULL) * PageBlocks_;
+  return static_cast<unsigned>(std::min(std::max(capacity, static_cast<size_t>(Config_.ObjectsPerPage_)),
+                                        static_cast<size_t>(Config_.MaxObjectsPerPage_)));
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function returns the free list of the object allocator.
+  This function takes the memory for a page. Mapped pages come from a slot
+  given back by FreePage, or the next slot of the newest chunk; either way
+  the memory reads as zeros. Other pages come from new[].
 
-\return Pointer to the free list.
+\par size The size of the page (that of a slot for mapped pages).
+\par zeroed Whether the page must be zeroed.
+\return The memory for the page.
 */
 /******************************************************************************/
-const void *ObjectAllocator::GetFreeList() const
+BYTE *ObjectAllocator::AllocatePageMemory(size_t size, bool zeroed)
 {
-  return FreeList_;
+  BYTE *page = nullptr;
+
+  if (Config_.MappedPages_)
+  {
+    if (!FreeSlots_.empty())
+    {
+      page = FreeSlots_.back();
+      FreeSlots_.pop_back();
+    }
+    else
+    {
+      if (NextSlot_ == ChunkEnd_)
+        MapChunk();
+      page = NextSlot_;
+      NextSlot_ += SlotSize_;
+    }
+    Stats_.ResidentBytes_ += SlotSize_;
+    return page;
+  }
+
+  page = zeroed ? new BYTE[size]() : new BYTE[size];
+  Stats_.ReservedBytes_ += size;
+  Stats_.ResidentBytes_ += size;
+  return page;
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function returns the page list of the object allocator.
+  This function gives the memory of a page back. A mapped page keeps its
+  address space, but its physical memory is dropped right away with
+  MADV_DONTNEED, so the resident size falls without waiting for the chunk
+  to be unmapped. Never throws.
 
-\return Pointer to the page list.
+\par page The memory of the page.
+\par size The size of the page.
 */
 /******************************************************************************/
-const void *ObjectAllocator::GetPageList() const
+void ObjectAllocator::ReleasePageMemory(BYTE *page, size_t size)
 {
-  return PageList_;
+#if OA_MAPPED_PAGES
+  if (Config_.MappedPages_)
+  {
+    madvise(page, SlotSize_, MADV_DONTNEED);
+    FreeSlots_.push_back(page); // MapChunk reserved room for every slot
+    Stats_.ResidentBytes_ -= SlotSize_;
+    return;
+  }
+#endif
+
+  delete[] page;
+  Stats_.ReservedBytes_ -= size;
+  Stats_.ResidentBytes_ -= size;
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function returns the configuration of the object allocator.
-
-\return A copy of this allocator's configuration.
+  This function maps a new chunk of page slots. With huge pages, the chunk
+  is aligned on a huge page boundary, which transparent huge pages need.
 */
 /******************************************************************************/
-OAConfig ObjectAllocator::GetConfig() const
+void ObjectAllocator::MapChunk()
 {
-  return Config_;
+#if OA_MAPPED_PAGES
+  PageChunks_.reserve(PageChunks_.size() + 1);
+  FreeSlots_.reserve((PageChunks_.size() + 1) * (ChunkSize_ / SlotSize_));
+
+  size_t size = Config_.HugePages_ ? ChunkSize_ + PAGE_CHUNK_SIZE : ChunkSize_;
+  void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED)
+    throw std::bad_alloc();
+
+  BYTE *chunk = static_cast<BYTE *>(mapping);
+  if (Config_.HugePages_)
+  {
+    // trim the mapping to a huge page boundary on both sides
+    BYTE *aligned = reinterpret_cast<BYTE *>(Align(reinterpret_cast<size_t>(chunk), PAGE_CHUNK_SIZE));
+    if (aligned != chunk)
+      munmap(chunk, aligned - chunk);
+    munmap(aligned + ChunkSize_, chunk + size - (aligned + ChunkSize_));
+    chunk = aligned;
+#ifdef MADV_HUGEPAGE
+    madvise(chunk, ChunkSize_, MADV_HUGEPAGE);
+#endif
+  }
+
+  PageChunks_.push_back(chunk);
+  Stats_.ReservedBytes_ += ChunkSize_;
+  NextSlot_ = chunk;
+  ChunkEnd_ = chunk + ChunkSize_ / SlotSize_ * SlotSize_;
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function returns the statistics of the object allocator.
-
-\return A copy of this allocator's statistics.
+  This function unmaps every chunk of page slots, with the pages in them.
 */
 /******************************************************************************/
-OAStats ObjectAllocator::GetStats() const
+void ObjectAllocator::UnmapChunks()
 {
-  return Stats_;
+#if OA_MAPPED_PAGES
+  for (BYTE *chunk : PageChunks_)
+    munmap(chunk, ChunkSize_);
+#endif
+  PageChunks_.clear();
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function allocates new memory for a page.
-
-\par pageList A pointer to the previous page list.
+  This function maps the guarded slots: one guard page, then for each slot
+  its data pages and another guard page. Everything starts out protected;
+  a slot is only opened while it holds a block. The allocator is then
+  registered for the fault handler, which is installed the first time.
 */
 /******************************************************************************/
-void ObjectAllocator::AllocateNewPage(GenericObject *&pageList)
+void ObjectAllocator::MapGuardSlots()
 {
-  if (Stats_.PagesInUse_ == Config_.MaxPages_)
+#if OA_MAPPED_PAGES
+  size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  GuardDataSize_ = Align(Stats_.ObjectSize_, pageSize);
+  GuardStride_ = GuardDataSize_ + pageSize;
+  Guards_.assign(Config_.GuardSlots_, GuardSlot{});
+
+  size_t size = pageSize + Config_.GuardSlots_ * GuardStride_;
+  void *mapping = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED)
+    throw std::bad_alloc();
+
+  GuardBase_ = static_cast<BYTE *>(mapping);
+  GuardEnd_ = GuardBase_ + size;
+  GuardCountdown_ = Config_.GuardSampleRate_;
+
+  bool registered = false;
+  for (std::atomic<const ObjectAllocator *> &entry : GuardRegistry)
   {
-    throw OAException(OAException::OA_EXCEPTION::E_NO_PAGES, "Out of pages!");
-  }
-  else
-  {
-    GenericObject *newPage = nullptr;
-    try
-    {
-      newPage = reinterpret_cast<GenericObject *>(new BYTE[Stats_.PageSize_]());
-      ++Stats_.PagesInUse_;
-    }
-    catch (std::bad_alloc &)
-    {
-      throw OAException{OAException::OA_EXCEPTION::E_NO_MEMORY, "AllocateNewPage: No system memory available!"};
-    }
-
-    if (Config_.DebugOn_)
+    const ObjectAllocator *empty = nullptr;
+    if (entry.compare_exchange_strong(empty, this))
     {
-      std::memset(newPage, ALIGN_PATTERN, Stats_.PageSize_);
+      registered = true;
+      break;
     }
+  }
 
-    newPage->Next = pageList;
-    pageList = newPage;
-
-    BYTE *PageStartAddress = reinterpret_cast<BYTE *>(newPage);
-    BYTE *DataStartAddress = PageStartAddress + HeaderSize_;
-
-    for (; static_cast<unsigned>(abs(static_cast<int>(DataStartAddress - PageStartAddress))) < Stats_.PageSize_;
-         DataStartAddress += MidBlockSize_)
-    {
-      GenericObject *dataAddress = reinterpret_cast<GenericObject *>(DataStartAddress);
-
-      PushToFreeList(dataAddress);
-
-      if (Config_.DebugOn_)
-      {
-        std::memset(reinterpret_cast<BYTE *>(dataAddress) + PTR_SIZE, UNALLOCATED_PATTERN, Stats_.ObjectSize_ - PTR_SIZE);
-        std::memset(GetLeftPadAdrress(dataAddress), PAD_PATTERN, Config_.PadBytes_);
-        std::memset(GetRightPadAdrress(dataAddress), PAD_PATTERN, Config_.PadBytes_);
-      }
-      std::memset(GetHeaderAddress(dataAddress), 0, Config_.HBlockInfo_.size_);
-    }
+  // faults the handler can't describe are no use, so sampling is turned off (see GetConfig)
+  if (!registered)
+  {
+    munmap(GuardBase_, size);
+    GuardBase_ = GuardEnd_ = nullptr;
+    Guards_.clear();
+    Config_.GuardSampleRate_ = 0;
+    return;
   }
+
+  if (!HandlerInstalled.exchange(true))
+    InstallGuardFaultHandler();
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function puts an object at the front of the free list.
-
-\par object The object to put on the free list.
+  This function installs the handler that describes faults on guarded
+  slots, in front of the SIGSEGV and SIGBUS handlers in place now. Every
+  fault, on a guarded slot or not, is forwarded to them. The first
+  allocator with guard sampling calls this; a client that installs a
+  handler of its own afterwards calls it again, or guard faults are no
+  longer described. Calling it while the handler is in place changes
+  nothing.
+
+\return Whether the handler is installed (false where there are no guards).
 */
 /******************************************************************************/
-void ObjectAllocator::PushToFreeList(GenericObject *object)
+bool ObjectAllocator::InstallGuardFaultHandler()
 {
-  GenericObject *temp = FreeList_;
-  FreeList_ = object;
-  object->Next = temp;
+#if OA_MAPPED_PAGES
+  std::lock_guard<std::mutex> lock(HandlerLock);
 
-  Stats_.FreeObjects_++;
+  struct sigaction action = {};
+  action.sa_sigaction = GuardFaultHandler;
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  sigemptyset(&action.sa_mask);
+
+  // the handler in place is only replaced (and read by the guard handler) when it is not this one
+  const int signals[] = {SIGSEGV, SIGBUS};
+  for (int number : signals)
+  {
+    struct sigaction current;
+    sigaction(number, nullptr, &current);
+    if ((current.sa_flags & SA_SIGINFO) && current.sa_sigaction == GuardFaultHandler)
+      continue;
+
+    (number == SIGBUS ? PreviousBus : PreviousSegv) = current;
+    sigaction(number, &action, nullptr);
+  }
+  HandlerInstalled = true;
+  return true;
+#else
+  return false;
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function checks if a given address is on a valid boundary.
-
-\par address The address to validate.
+  This function unregisters the allocator from the fault handler, then
+  unmaps the guarded slots.
 */
 /******************************************************************************/
-void ObjectAllocator::CheckBoundaries(unsigned char *address) const
+void ObjectAllocator::UnmapGuardSlots()
 {
-  GenericObject *pageList = PageList_;
+#if OA_MAPPED_PAGES
+  if (!GuardBase_)
+    return;
 
-  while (!IsObjectInPage(pageList, address))
+  for (std::atomic<const ObjectAllocator *> &entry : GuardRegistry)
   {
-    pageList = pageList->Next;
-
-    if (!pageList)
-    {
-      throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
-    }
+    const ObjectAllocator *self = this;
+    entry.compare_exchange_strong(self, nullptr);
   }
 
-  BYTE *pageStart = reinterpret_cast<BYTE *>(pageList);
-
-  if (static_cast<unsigned>(address - pageStart) < HeaderSize_)
-    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
-
-  pageStart += HeaderSize_;
-  long displacement = address - pageStart;
-  if (static_cast<size_t>(displacement) % MidBlockSize_ != 0)
-    throw OAException{OAException::E_BAD_BOUNDARY, "CheckBoundaries: Address is not on boundary!"};
+  munmap(GuardBase_, GuardEnd_ - GuardBase_);
+  GuardBase_ = GuardEnd_ = nullptr;
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function checks if a given padding address is valid.
+  This function puts a sampled block in the guarded slot freed longest
+  ago, so that a block is kept protected as long as possible after it is
+  freed. The block ends where the next guard page starts, so an access
+  just past its end faults right away.
 
-\par address The address to validate.
-\return Returns \p true if padding is valid, else \p false if corrupted.
+\par label A label for the block of memory requested.
+\return The block, or null if every slot is in use.
 */
 /******************************************************************************/
-bool ObjectAllocator::ValidatePadding(unsigned char *paddingAddress, size_t size) const
+void *ObjectAllocator::AllocateGuarded(const char *label)
 {
-  for (size_t i = 0; i < size; ++i)
+#if OA_MAPPED_PAGES
+  GuardSlot *slot = nullptr;
+  for (GuardSlot &candidate : Guards_)
   {
-    if (*(paddingAddress + i) != ObjectAllocator::PAD_PATTERN)
-      return false;
+    if (!candidate.InUse && (!slot || candidate.FreedAt < slot->FreedAt))
+      slot = &candidate;
   }
-  return true;
+  if (!slot)
+    return nullptr;
+
+  BYTE *data = GuardBase_ + (GuardStride_ - GuardDataSize_) + (slot - Guards_.data()) * GuardStride_;
+  if (mprotect(data, GuardDataSize_, PROT_READ | PROT_WRITE) != 0)
+    return nullptr;
+
+  size_t alignment = std::max(static_cast<size_t>(Config_.Alignment_), PTR_SIZE);
+  slot->Object = data + GuardDataSize_ - Align(Stats_.ObjectSize_, alignment);
+  slot->InUse = true;
+
+  size_t length = 0;
+  for (; label && label[length] && length + 1 < sizeof(slot->Label); ++length)
+    slot->Label[length] = label[length];
+  slot->Label[length] = 0;
+
+  if (Config_.DebugOn_)
+    std::memset(slot->Object, ALLOCATED_PATTERN, Stats_.ObjectSize_);
+
+  ++Stats_.ObjectsInUse_;
+  if (Stats_.ObjectsInUse_ > Stats_.MostObjects_)
+    Stats_.MostObjects_ = Stats_.ObjectsInUse_;
+  ++Stats_.Allocations_;
+  slot->AllocNum = Stats_.Allocations_;
+
+  return slot->Object;
+#else
+  (void)label;
+  return nullptr;
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function checks if a given address is in a page.
+  This function frees a guarded block. Its slot is protected again, so
+  any later access faults. These checks cost nothing, so they are made
+  with or without debugging.
 
-\par pageAddress The page to check.
-\par address The address to check.
-\return Returns \p true if address is in page, else \p false.
+\par object The guarded block.
 */
 /******************************************************************************/
-bool ObjectAllocator::IsObjectInPage(GenericObject *pageAddress, unsigned char *address) const
+void ObjectAllocator::FreeGuarded(GenericObject *object)
 {
-  return (address >= reinterpret_cast<BYTE *>(pageAddress) &&
-          address < reinterpret_cast<BYTE *>(pageAddress) + Stats_.PageSize_);
+  BYTE *address = reinterpret_cast<BYTE *>(object);
+  BYTE *firstData = GuardBase_ + (GuardStride_ - GuardDataSize_);
+  size_t index = address < firstData ? Guards_.size() : (address - firstData) / GuardStride_;
+
+  if (index >= Guards_.size() || address != Guards_[index].Object)
+    throw OAException(OAException::E_BAD_BOUNDARY, "FreeGuarded: Address is not on a guarded block boundary!");
+  if (!Guards_[index].InUse)
+    throw OAException(OAException::E_MULTIPLE_FREE, "FreeGuarded: Guarded block has already been freed!");
+
+  Guards_[index].InUse = false;
+  Guards_[index].FreedAt = ++GuardFrees_;
+  ProtectGuardSlot(index);
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function checks if a given block address is currently used.
+  This function gives the data of a slot back to the OS and protects it.
 
-\par object The object to check.
-\return Returns \p true if block is used, else \p false.
+\par index The slot.
 */
 /******************************************************************************/
-bool ObjectAllocator::IsObjectUsed(GenericObject *object) const
+void ObjectAllocator::ProtectGuardSlot(size_t index)
 {
-  switch (Config_.HBlockInfo_.type_)
-  {
-  case OAConfig::HBLOCK_TYPE::hbNone:
-  {
-    GenericObject *freelist = FreeList_;
-    while (freelist)
-    {
-      if (freelist == object)
-        return true;
-      freelist = freelist->Next;
-    }
-    return false;
-  }
-  case OAConfig::HBLOCK_TYPE::hbBasic:
-  case OAConfig::HBLOCK_TYPE::hbExtended:
-  {
-    BYTE *flagByte = reinterpret_cast<BYTE *>(object) - Config_.PadBytes_ - 1;
-    return *flagByte;
-  }
-  case OAConfig::HBLOCK_TYPE::hbExternal:
-  {
-    return *GetHeaderAddress(object);
-  }
-  default:
-    return false;
-    break;
-  }
+#if OA_MAPPED_PAGES
+  BYTE *data = GuardBase_ + (GuardStride_ - GuardDataSize_) + index * GuardStride_;
+  madvise(data, GuardDataSize_, MADV_DONTNEED);
+  mprotect(data, GuardDataSize_, PROT_NONE);
+#else
+  (void)index;
+#endif
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function checks if a given page is not used at all.
+  This function checks if a block is in the guarded slots.
 
-\par page The page to check.
-\return Returns \p true if page is free, else \p false.
+\par object The block.
+\return Whether the block is in the guarded slots.
 */
 /******************************************************************************/
-bool ObjectAllocator::IsPageFree(GenericObject *page) const
+bool ObjectAllocator::IsGuarded(const void *object) const
 {
-  GenericObject *temp = FreeList_;
-  unsigned freeObjectsInPage = 0;
-  while (temp)
-  {
-    if (IsObjectInPage(page, reinterpret_cast<BYTE *>(temp)))
-    {
-      if (++freeObjectsInPage > Config_.ObjectsPerPage_ - 1)
-        return true;
-    }
-    temp = temp->Next;
-  }
-  return false;
+  const BYTE *address = static_cast<const BYTE *>(object);
+  return address >= GuardBase_ && address < GuardEnd_;
 }
 
 /******************************************************************************/
 /*!
 \brief
-  This function returns memory used by a page back to the OS.
+  This function describes a fault on the guarded slots of any allocator:
+  what kind of access it was, where it was from the block, and the
+  allocation number and label of the block. It only reads memory and
+  calls write, so it is safe to call from a signal handler.
 
-\par page The page to free.
+\par Address The address of the access that faulted.
+\return Whether the address is on the guarded slots of an allocator.
 */
 /******************************************************************************/
-void ObjectAllocator::FreePage(GenericObject *page)
+bool ObjectAllocator::ReportGuardFault(const void *Address)
 {
-  GenericObject *temp = FreeList_;
-  GenericObject *prev = nullptr;
-
-  while (temp && IsObjectInPage(page, reinterpret_cast<BYTE *>(temp)))
-  {
-    FreeList_ = temp->Next;
-    temp = this->FreeList_;
-    --Stats_.FreeObjects_;
-  }
-
-  while (temp)
+#if OA_MAPPED_PAGES
+  const BYTE *address = static_cast<const BYTE *>(Address);
+  for (std::atomic<const ObjectAllocator *> &entry : GuardRegistry)
   {
-    while (temp && !IsObjectInPage(page, reinterpret_cast<BYTE *>(temp)))
+    const ObjectAllocator *oa = entry.load(std::memory_order_acquire);
+    if (!oa || !oa->IsGuarded(address))
+      continue;
+
+    // the slot whose data or following guard page holds the address
+    const BYTE *firstData = oa->GuardBase_ + (oa->GuardStride_ - oa->GuardDataSize_);
+    size_t index = address < firstData ? 0 : (address - firstData) / oa->GuardStride_;
+    if (index >= oa->Guards_.size())
+      index = oa->Guards_.size() - 1;
+    const GuardSlot &slot = oa->Guards_[index];
+
+    FaultMessage message;
+    message.Append("ObjectAllocator: ");
+    if (!slot.Object)
     {
-      prev = temp;
-      temp = temp->Next;
+      message.Append("access to an unused guarded slot at 0x");
+      message.Append(reinterpret_cast<uintptr_t>(address), 16);
     }
+    else
+    {
+      const BYTE *end = slot.Object + oa->Stats_.ObjectSize_;
+      message.Append(!slot.InUse ? "use after free" : address >= end ? "buffer overflow"
+                                                  : address < slot.Object ? "buffer underflow" : "invalid access");
+      message.Append(" at 0x");
+      message.Append(reinterpret_cast<uintptr_t>(address), 16);
+      if (address < slot.Object)
+      {
+        message.Append(", ");
+        message.Append(static_cast<uint64_t>(slot.Object - address), 10);
+        message.Append(" bytes before");
+      }
+      else
+      {
+        message.Append(", byte ");
+        message.Append(static_cast<uint64_t>(address - slot.Object), 10);
+        message.Append(" of");
+      }
+      message.Append(" the ");
+      message.Append(static_cast<uint64_t>(oa->Stats_.ObjectSize_), 10);
+      message.Append("-byte block 0x");
+      message.Append(reinterpret_cast<uintptr_t>(slot.Object), 16);
+      message.Append(" (allocation #");
+      message.Append(slot.AllocNum, 10);
+      if (slot.Label[0])
+      {
+        message.Append(", label \"");
+        message.Append(slot.Label);
+        message.Append("\"");
+      }
+      message.Append(slot.InUse ? ")" : ", freed)");
+    }
+    message.Append("\n");
 
-    if (!temp)
-      break;
-    prev->Next = temp->Next;
-
-    --Stats_.FreeObjects_;
-    temp = prev->Next;
+    ssize_t written = write(STDERR_FILENO, message.Text, message.Length);
+    (void)written;
+    return true;
   }
-
-  delete[] reinterpret_cast<BYTE *>(page);
-  --Stats_.PagesInUse_;
+#else
+  (void)Address;
+#endif
+  return false;
 }
 
 /******************************************************************************/
@@ -626,9 +3317,10 @@ void ObjectAllocator::FreePage(GenericObject *page)
 \par object The block to initialize.
 \par headerType The type of header to initialize.
 \par label_ A cstring label for the block of memory.
+\par allocNum The allocation number of the block.
 */
 /******************************************************************************/
-void ObjectAllocator::InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE headerType, const char *label_)
+void ObjectAllocator::InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE headerType, const char *label_, unsigned allocNum)
 {
   switch (headerType)
   {
@@ -636,7 +3328,7 @@ void ObjectAllocator::InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE he
   {
     BYTE *headerAddress = GetHeaderAddress(object);
     unsigned *allocationNumber = reinterpret_cast<unsigned *>(headerAddress);
-    *allocationNumber = Stats_.Allocations_;
+    *allocationNumber = allocNum;
 
     BYTE *flag = reinterpret_cast<BYTE *>(allocationNumber + 1);
     *flag = true;
@@ -649,7 +3341,7 @@ void ObjectAllocator::InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE he
     ++(*counter);
 
     unsigned *allocationNumber = reinterpret_cast<unsigned *>(counter + 1);
-    *allocationNumber = Stats_.Allocations_;
+    *allocationNumber = allocNum;
 
     BYTE *flag = reinterpret_cast<BYTE *>(allocationNumber + 1);
     *flag = true;
@@ -659,26 +3351,24 @@ void ObjectAllocator::InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE he
   {
     BYTE *headerAddress = GetHeaderAddress(object);
     MemBlockInfo **memPtr = reinterpret_cast<MemBlockInfo **>(headerAddress);
-    try
+    char *label = nullptr;
+    if (label_)
     {
-      *memPtr = new MemBlockInfo{true, nullptr, Stats_.Allocations_};
-      if (label_)
+      try
       {
-        try
-        {
-          (*memPtr)->label = new char[std::strlen(label_) + 1];
-        }
-        catch (std::bad_alloc &)
-        {
-          throw OAException(OAException::E_NO_MEMORY, "InitHeader: No system memory available!");
-        }
-        std::strcpy((*memPtr)->label, label_);
+        label = InternLabel(label_);
+      }
+      catch (std::bad_alloc &)
+      {
+        throw OAException(OAException::E_NO_MEMORY, "InitHeader: No system memory available!");
       }
     }
-    catch (std::bad_alloc &)
-    {
-      throw OAException(OAException::E_NO_MEMORY, "InitHeader: No system memory available!");
-    }
+
+    MemBlockInfo *info = AllocateInfo();
+    info->in_use = true;
+    info->label = label;
+    info->alloc_num = allocNum;
+    *memPtr = info;
   }
   break;
   default:
@@ -735,12 +3425,10 @@ void ObjectAllocator::FreeHeader(GenericObject *object, OAConfig::HBLOCK_TYPE he
   case OAConfig::hbExternal:
   {
     MemBlockInfo **info = reinterpret_cast<MemBlockInfo **>(headerAddress);
-    if (nullptr == *info && Config_.DebugOn_)
+    if (nullptr == *info)
       return;
 
-    if ((*info)->label)
-      delete[](*info)->label;
-    delete *info;
+    FreeInfo(*info);
     *info = nullptr;
   }
   break;
@@ -749,6 +3437,80 @@ void ObjectAllocator::FreeHeader(GenericObject *object, OAConfig::HBLOCK_TYPE he
   }
 }
 
+/******************************************************************************/
+/*!
+\brief
+  This function returns the interned copy of a label, so that blocks with
+  the same label share one string that lives as long as the allocator.
+  Labels are usually string literals passed again and again, so the label
+  of the previous call is checked first, without hashing it.
+
+\par label The label given to Allocate.
+\return The interned label.
+*/
+/******************************************************************************/
+char *ObjectAllocator::InternLabel(const char *label)
+{
+  if (label == LastLabel_ && std::strcmp(label, LastInterned_) == 0)
+    return LastInterned_;
+
+  const std::string &interned = *Labels_.insert(label).first;
+  LastLabel_ = label;
+  LastInterned_ = const_cast<char *>(interned.c_str());
+
+  return LastInterned_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes a MemBlockInfo record off the record pool. Records
+  are allocated in chunks and kept on their own free list, so an external
+  header costs no trip to the general heap once the pool is warm.
+
+\return An uninitialized record.
+*/
+/******************************************************************************/
+MemBlockInfo *ObjectAllocator::AllocateInfo()
+{
+  if (!FreeInfos_)
+  {
+    MemBlockInfo *chunk = nullptr;
+    try
+    {
+      InfoChunks_.reserve(InfoChunks_.size() + 1);
+      chunk = new MemBlockInfo[INFOS_PER_CHUNK];
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "AllocateInfo: No system memory available!");
+    }
+    InfoChunks_.push_back(chunk);
+
+    for (size_t i = INFOS_PER_CHUNK; i > 0; --i)
+      FreeInfo(chunk + i - 1);
+  }
+
+  MemBlockInfo *info = reinterpret_cast<MemBlockInfo *>(FreeInfos_);
+  FreeInfos_ = FreeInfos_->Next;
+  return info;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function puts a MemBlockInfo record back on the record pool.
+
+\par info The record to put back.
+*/
+/******************************************************************************/
+void ObjectAllocator::FreeInfo(MemBlockInfo *info)
+{
+  GenericObject *record = reinterpret_cast<GenericObject *>(info);
+  record->Next = FreeInfos_;
+  FreeInfos_ = record;
+}
+
 /******************************************************************************/
 /*!
 \brief
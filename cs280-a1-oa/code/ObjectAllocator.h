@@ -15,11 +15,30 @@
 #define OBJECTALLOCATORH
 //---------------------------------------------------------------------------
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 // If the client doesn't specify these:
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;
 static const int DEFAULT_MAX_PAGES = 3;
+static const unsigned DEFAULT_PROFILE_SAMPLE_RATE = 64;
+static const unsigned DEFAULT_GUARD_SLOTS = 32;
+static const unsigned DEFAULT_MAX_OBJECTS_PER_PAGE = 4096;
+
+// Most allocators with guard sampling at a time (guard sampling is off for any more)
+static const unsigned OA_MAX_GUARDED_ALLOCATORS = 64;
+
+// Size of the profile histograms and event log
+static const unsigned OA_LATENCY_BUCKETS = 32;
+static const unsigned OA_PAGE_EVENTS = 256;
 
 /*!
   Exception class
@@ -175,6 +194,21 @@ struct OAConfig
     HBlockInfo_ = HBInfo;
     LeftAlignSize_ = 0;
     InterAlignSize_ = 0;
+    PerPageFreeLists_ = false;
+    RemoteFrees_ = false;
+    LazyCarving_ = false;
+    MappedPages_ = false;
+    HugePages_ = false;
+    FullestPageFirst_ = false;
+    Profiling_ = false;
+    ProfileSampleRate_ = DEFAULT_PROFILE_SAMPLE_RATE;
+    GuardSampleRate_ = 0;
+    GuardSlots_ = DEFAULT_GUARD_SLOTS;
+    GrowthFactor_ = 1;
+    MaxObjectsPerPage_ = DEFAULT_MAX_OBJECTS_PER_PAGE;
+    BackgroundRefill_ = false;
+    RefillWatermark_ = 0;
+    Handles_ = false;
   }
 
   bool UseCPPMemManager_;      //!< by-pass the functionality of the OA and use new/delete
@@ -186,6 +220,21 @@ struct OAConfig
   unsigned Alignment_;         //!< address alignment of each block
   unsigned LeftAlignSize_;     //!< number of alignment bytes required to align first block
   unsigned InterAlignSize_;    //!< number of alignment bytes required between remaining blocks
+  bool PerPageFreeLists_;      //!< keep a free list on every page instead of one global list
+  bool RemoteFrees_;           //!< allow threads other than the owner to free blocks
+  bool LazyCarving_;           //!< carve blocks off new pages when needed instead of all at once
+  bool MappedPages_;           //!< take pages from large mmap'd chunks instead of new[] (POSIX only)
+  bool HugePages_;             //!< ask for transparent huge pages for those chunks
+  bool FullestPageFirst_;      //!< allocate from the fullest page with room (implies PerPageFreeLists_)
+  bool Profiling_;             //!< keep an allocation profile (see ObjectAllocator::GetProfile)
+  unsigned ProfileSampleRate_; //!< time one in this many calls to Allocate and Free (0=none)
+  unsigned GuardSampleRate_;   //!< put one in this many allocations between guard pages (0=none, POSIX only, at most OA_MAX_GUARDED_ALLOCATORS allocators)
+  unsigned GuardSlots_;        //!< most blocks between guard pages at a time
+  unsigned GrowthFactor_;      //!< each new page takes the pages in use this many times over (1=every page alike)
+  unsigned MaxObjectsPerPage_; //!< most objects on a page grown by GrowthFactor_
+  bool BackgroundRefill_;      //!< add pages on a helper thread before the free blocks run out (new[] pages only)
+  unsigned RefillWatermark_;   //!< free blocks below which the helper thread adds pages (0=ObjectsPerPage_)
+  bool Handles_;               //!< number the pages so blocks can be named by 32-bit handles (no guard sampling)
 };
 
 /*!
@@ -197,16 +246,74 @@ struct OAStats
     Constructor
   */
   OAStats() : ObjectSize_(0), PageSize_(0), FreeObjects_(0), ObjectsInUse_(0), PagesInUse_(0),
-              MostObjects_(0), Allocations_(0), Deallocations_(0){};
+              MostObjects_(0), Allocations_(0), Deallocations_(0), ReservedBytes_(0), ResidentBytes_(0),
+              Capacity_(0){};
 
   size_t ObjectSize_;      //!< size of each object
-  size_t PageSize_;        //!< size of a page including all headers, padding, etc.
+  size_t PageSize_;        //!< size of a page including all headers, padding, etc. (the first page when pages grow)
   unsigned FreeObjects_;   //!< number of objects on the free list
   unsigned ObjectsInUse_;  //!< number of objects in use by client
   unsigned PagesInUse_;    //!< number of pages allocated
   unsigned MostObjects_;   //!< most objects in use by client at one time
   unsigned Allocations_;   //!< total requests to allocate memory
   unsigned Deallocations_; //!< total requests to free memory
+  size_t ReservedBytes_;   //!< bytes of address space held for pages
+  size_t ResidentBytes_;   //!< bytes of pages not given back to the OS (at most what is actually resident)
+  unsigned Capacity_;      //!< number of objects the pages hold, in use or free
+};
+
+/*!
+  Allocation profile of the blocks allocated with one label
+*/
+struct OALabelProfile
+{
+  /*!
+    Constructor
+
+    \param Label
+      The label given to Allocate.
+  */
+  explicit OALabelProfile(const std::string &Label = std::string())
+      : Label_(Label), Allocations_(0), Deallocations_(0), ObjectsInUse_(0), PageGrowths_(0){};
+
+  std::string Label_;      //!< label given to Allocate ("" for no label)
+  uint64_t Allocations_;   //!< blocks allocated with this label
+  uint64_t Deallocations_; //!< blocks with this label freed again (not counted with UseCPPMemManager_)
+  uint64_t ObjectsInUse_;  //!< blocks with this label still in use (not counted with UseCPPMemManager_)
+  uint64_t PageGrowths_;   //!< pages added to serve an allocation with this label
+};
+
+/*!
+  A page added to the allocator
+*/
+struct OAPageEvent
+{
+  uint64_t Time_;       //!< nanoseconds since profiling started
+  unsigned Label_;      //!< index in OAProfile::Labels_ of the allocation that needed the page
+  unsigned PagesInUse_; //!< number of pages with the new one
+};
+
+/*!
+  Allocation profile of an ObjectAllocator (see OAConfig::Profiling_)
+*/
+struct OAProfile
+{
+  /*!
+    Constructor
+  */
+  OAProfile() : Allocations_(0), Deallocations_(0), ObjectsInUse_(0), MostObjects_(0), PagesAllocated_(0),
+                PagesFreed_(0), AllocateLatency_(), FreeLatency_(){};
+
+  uint64_t Allocations_;    //!< total requests to allocate memory
+  uint64_t Deallocations_;  //!< total requests to free memory
+  uint64_t ObjectsInUse_;   //!< number of objects in use by client
+  uint64_t MostObjects_;    //!< most objects in use by client at one time
+  uint64_t PagesAllocated_; //!< pages ever added
+  uint64_t PagesFreed_;     //!< pages ever freed
+  uint64_t AllocateLatency_[OA_LATENCY_BUCKETS]; //!< sampled Allocate times; bucket i counts [2^i, 2^(i+1)) ns
+  uint64_t FreeLatency_[OA_LATENCY_BUCKETS];     //!< sampled Free times; bucket i counts [2^i, 2^(i+1)) ns
+  std::vector<OALabelProfile> Labels_;           //!< every label seen, in order of first use ("" first)
+  std::vector<OAPageEvent> PageEvents_;          //!< last OA_PAGE_EVENTS pages added, oldest first
 };
 
 /*!
@@ -227,6 +334,12 @@ struct MemBlockInfo
   unsigned alloc_num; //!< The allocation number (count) of this block
 };
 
+//! Old address -> new address of the blocks moved by ObjectAllocator::Compact
+typedef std::unordered_map<const void *, void *> OARelocationMap;
+
+//! A block named by its page number (high bits) and slot (low bits); 0 names no block
+typedef uint32_t OAHandle;
+
 /*!
   This class represents a custom memory manager
 */
@@ -236,6 +349,8 @@ public:
   // Defined by the client (pointer to a block, size of block)
   typedef void (*DUMPCALLBACK)(const void *, size_t);     //!< Callback function when dumping memory leaks
   typedef void (*VALIDATECALLBACK)(const void *, size_t); //!< Callback function when validating blocks
+  // Defined by the client (old address, new address, context given to Compact)
+  typedef void (*RELOCATECALLBACK)(const void *, void *, void *); //!< Callback function when a block is moved
 
   // Predefined values for memory signatures
   static const unsigned char UNALLOCATED_PATTERN = 0xAA; //!< New memory never given to the client
@@ -244,6 +359,9 @@ public:
   static const unsigned char PAD_PATTERN = 0xDD;         //!< Pad signature to detect buffer over/under flow
   static const unsigned char ALIGN_PATTERN = 0xEE;       //!< For the alignment bytes
 
+  // Checks that every byte of a range holds a signature, many bytes at a time (e.g. the pads)
+  static bool MatchesPattern(const unsigned char *address, size_t size, unsigned char pattern);
+
   // Creates the ObjectManager per the specified values
   // Throws an exception if the construction fails. (Memory allocation problem)
   ObjectAllocator(size_t ObjectSize, const OAConfig &config);
@@ -259,51 +377,283 @@ public:
   // Throws an exception if the the object can't be freed. (Invalid object)
   void Free(void *Object);
 
+  // Same as Allocate, but inlined while blocks are on the free list and no checks are made
+  // Returns null instead of throwing if the object can't be allocated.
+  void *TryAllocate(const char *label = 0) noexcept;
+
+  // Same as Free, but inlined while no checks are made
+  // Returns false instead of throwing if the object can't be freed.
+  bool TryFree(void *Object) noexcept;
+
+  // Same as Allocate, but names the object by a 32-bit handle (OAConfig::Handles_ only)
+  // Throws an exception if the object can't be allocated, or if handles are off.
+  OAHandle AllocateHandle(const char *label = 0);
+
+  // Frees an object named by a handle, like Free
+  // Throws an exception if the handle names no page, or the object can't be freed.
+  void FreeHandle(OAHandle Handle);
+
+  // Returns the object named by a handle (null for 0), with one look-up in the page table
+  // Only call this on the owning thread, with a handle of an object in use.
+  void *ToPointer(OAHandle Handle) const;
+
+  // Returns the handle of an object (0 if handles are off or the object is not on a page)
+  OAHandle ToHandle(const void *Object) const;
+
+  // Takes Count objects at once and stores them in Objects, with one update of the statistics
+  // Throws an exception if the objects can't be allocated; no object is taken then.
+  void AllocateBatch(unsigned Count, void **Objects, const char *label = 0);
+
+  // Returns Count objects at once, with one update of the statistics
+  // Throws an exception at the first object that can't be freed; the objects before it are freed.
+  void FreeBatch(void **Objects, unsigned Count);
+
   // Calls the callback fn for each block still in use
   unsigned DumpMemoryInUse(DUMPCALLBACK fn) const;
 
   // Calls the callback fn for each block that is potentially corrupted
   unsigned ValidatePages(VALIDATECALLBACK fn) const;
 
+  // Checks at most MaxBlocks blocks, starting where the previous call stopped
+  // Calls the callback fn for each of them that is potentially corrupted
+  unsigned ValidatePagesIncremental(VALIDATECALLBACK fn, unsigned MaxBlocks);
+
   // Frees all empty page
   unsigned FreeEmptyPages();
 
+  // Adds pages, touched ahead of time, until Objects objects can be allocated without adding one
+  // Returns how many of them can (fewer when MaxPages_ is reached); throws if memory runs out.
+  unsigned Reserve(unsigned Objects);
+
+  // Frees the pages left over from Reserve, and every other empty page
+  unsigned ShrinkToFit();
+
+  // Moves the objects of the emptiest pages into the fullest ones and frees the pages emptied
+  // Calls fn with the old and new address of each object moved; returns the number of pages freed.
+  unsigned Compact(RELOCATECALLBACK fn, void *Context = 0);
+
+  // A RELOCATECALLBACK that adds each move to the OARelocationMap given as the context
+  static void RecordRelocation(const void *OldAddress, void *NewAddress, void *Map);
+
+  // Releases every object at once, keeping the pages for reuse unless KeepPages is false
+  // Returns false with UseCPPMemManager_, where objects can only be freed one at a time.
+  bool ResetAll(bool KeepPages = true);
+
+  // Writes a description of a fault on a guarded block to stderr (async-signal-safe)
+  // Returns false if the address is not on the guarded slots of any allocator.
+  static bool ReportGuardFault(const void *Address);
+
+  // Puts the guard fault handler in front of the SIGSEGV/SIGBUS handlers in place now, which
+  // it forwards every fault to. The first allocator with guard sampling calls it; call it
+  // again after installing a handler of your own, or guard faults are no longer described.
+  // Returns false where guard sampling is not available.
+  static bool InstallGuardFaultHandler();
+
+  // Makes the calling thread the owner (the only thread that may allocate)
+  // Only call this while no other thread is using the allocator.
+  void SetOwnerThread();
+
   // Testing/Debugging/Statistic methods
   void SetDebugState(bool State);  // true=enable, false=disable
   const void *GetFreeList() const; // returns a pointer to the internal free list
   const void *GetPageList() const; // returns a pointer to the internal page list
   OAConfig GetConfig() const;      // returns the configuration parameters
   OAStats GetStats() const;        // returns the statistics for the allocator
+  OAProfile GetProfile() const;    // returns the allocation profile (empty unless profiling)
 
   // Prevent copy construction and assignment
   ObjectAllocator(const ObjectAllocator &oa) = delete;            //!< Do not implement!
   ObjectAllocator &operator=(const ObjectAllocator &oa) = delete; //!< Do not implement!
 
 private:
+  /*!
+    Book-keeping for a page. It is kept outside of the page so that the page
+    layout seen through GetPageList() does not change.
+  */
+  struct PageInfo
+  {
+    GenericObject *Page;     //!< The start of the page
+    GenericObject *FreeList; //!< Free blocks of this page (per-page free lists only)
+    unsigned FreeCount;      //!< Number of free blocks on this page
+    PageInfo *PrevPartial;   //!< Previous page that still has free blocks
+    PageInfo *NextPartial;   //!< Next page that still has free blocks
+    unsigned *Occupancy;     //!< One bit per block, set while the block is in use (hbNone only)
+    unsigned Carved;         //!< Number of blocks carved so far; the rest were never handed out
+    unsigned Bucket;         //!< Occupancy bucket the page is linked into while it has free blocks
+    unsigned *Labels;        //!< Label of each block in use, by slot (profiling only)
+    unsigned Capacity;       //!< Number of blocks on this page
+    size_t Size;             //!< Size of this page in bytes
+    unsigned Number;         //!< Index of the page in the page table (handles only)
+  };
+
+  /*!
+    A slot between guard pages for a sampled block. It is read by the fault
+    handler, so the label is copied in rather than pointed to.
+  */
+  struct GuardSlot
+  {
+    unsigned char *Object; //!< The block in the slot (null until the slot is first used)
+    unsigned AllocNum;     //!< Allocation number of the block
+    uint64_t FreedAt;      //!< Guarded frees before this one; the slot freed longest ago is reused first
+    bool InUse;            //!< Is the block still allocated?
+    char Label[32];        //!< The label of the block, cut short if needed
+  };
+
+  /*!
+    The helper thread of the background refill and what it shares with the
+    owner. Pages staged by the helper are linked through NextPartial.
+  */
+  struct RefillState
+  {
+    std::thread Thread;                //!< The helper thread
+    std::mutex Mutex;                  //!< Guards Stop, Requested and Debug
+    std::condition_variable Wake;      //!< Wakes the helper when pages are requested or it must stop
+    bool Stop;                         //!< Must the helper stop?
+    unsigned Requested;                //!< Pages the helper has yet to stage
+    bool Debug;                        //!< Debug state when the pages were requested
+    std::atomic<PageInfo *> Staged;    //!< Pages staged, ready to adopt
+    std::atomic<unsigned> Shortfall;   //!< Pages requested that the helper had no memory for
+    unsigned Pending;                  //!< Pages requested and not adopted yet (owner only)
+    unsigned Watermark;                //!< Free blocks below which pages are requested (owner only)
+  };
+
+  /*!
+    Book-keeping for the allocation profile, kept only while profiling.
+  */
+  struct ProfileState
+  {
+    OAProfile Profile;                              //!< The counters handed out by GetProfile
+    std::unordered_map<std::string, unsigned> Ids;  //!< Index of each label in Profile.Labels_
+    const char *LastLabel;                          //!< Label passed to the previous Allocate
+    unsigned LastId;                                //!< Index of LastLabel
+    unsigned Label;                                 //!< Index of the label of the allocation in progress
+    unsigned Countdown;                             //!< Calls left until the next timed one
+    PageInfo *LastPage;                             //!< Page of the block last added or removed
+    size_t NextEvent;                               //!< Slot of the event log to write next once it is full
+    std::chrono::steady_clock::time_point Start;    //!< When profiling started
+  };
+
   // Some "suggested" members (only a suggestion!)
   GenericObject *PageList_; //!< the beginning of the list of pages
   GenericObject *FreeList_; //!< the beginning of the list of objects
+  std::vector<PageInfo *> PartialPages_; //!< pages that have free blocks, by occupancy bucket (per-page free lists only)
+  unsigned FirstBucket_;    //!< no bucket below this one has pages
+  PageInfo *CarvePage_;     //!< page whose blocks are not all carved yet (global free list only)
+  std::vector<PageInfo *> CarveQueue_; //!< pages reset by ResetAll to carve after CarvePage_, next one last
+  std::vector<PageInfo *> PageIndex_; //!< every page, sorted by address
+  std::atomic<GenericObject *> RemoteFreeList_; //!< blocks freed by other threads, not yet collected
+  std::thread::id Owner_;               //!< the thread that allocates from this allocator
 
   // Lots of other private stuff...
   OAConfig Config_;     //!< Configuration of the Object Allocator
   OAStats Stats_;       //!< Statistics of the Object Allocator
   size_t HeaderSize_;   //!< Size of the page header in bytes
   size_t MidBlockSize_; //!< Size of a midblock
-
+  GenericObject *FreeInfos_;               //!< Free MemBlockInfo records of external headers
+  std::vector<MemBlockInfo *> InfoChunks_; //!< Every chunk of MemBlockInfo records
+  std::unordered_set<std::string> Labels_; //!< Interned labels of external headers
+  const char *LastLabel_;                  //!< Label passed to the previous Allocate
+  char *LastInterned_;                     //!< Interned copy of LastLabel_
+  std::vector<unsigned char *> PageChunks_; //!< Chunks mapped for pages (mapped pages only)
+  std::vector<unsigned char *> FreeSlots_;  //!< Page slots given back to the OS, ready for reuse
+  unsigned char *NextSlot_;                 //!< Next slot of the newest chunk never used
+  unsigned char *ChunkEnd_;                 //!< End of the last whole slot of the newest chunk
+  size_t SlotSize_;                         //!< Size of a page rounded up to whole OS pages
+  size_t ChunkSize_;                        //!< Bytes mapped per chunk
+  ProfileState *Profile_;                   //!< Allocation profile (null unless profiling)
+  RefillState *Refill_;                     //!< Background refill (null unless enabled)
+  const GenericObject *ValidatePage_;       //!< Page the incremental validation resumes on
+  unsigned ValidateBlock_;                  //!< Block of that page it resumes at
+  std::vector<GuardSlot> Guards_;           //!< Slots for sampled blocks (guard sampling only)
+  unsigned char *GuardBase_;                //!< Start of the guarded slots (null unless guard sampling)
+  unsigned char *GuardEnd_;                 //!< End of the guarded slots
+  size_t GuardStride_;                      //!< Bytes from one slot to the next: its data and a guard page
+  size_t GuardDataSize_;                    //!< Bytes of data in a slot, in whole OS pages
+  unsigned GuardCountdown_;                 //!< Allocations left until the next guarded one
+  uint64_t GuardFrees_;                     //!< Guarded blocks freed so far
+  size_t PageBlocks_;                       //!< Blocks on every page together
+  bool FastAllocate_;                       //!< Can TryAllocate pop the free list inline?
+  bool FastFree_;                           //!< Can TryFree push onto the free list inline?
+  std::vector<unsigned char *> PageTable_;  //!< First block of each numbered page; entry 0 is always null
+  std::vector<unsigned> FreeNumbers_;       //!< Numbers of freed pages, reused before new ones (handles only)
+  unsigned SlotBits_;                       //!< Low bits of a handle that hold the slot
+
+  void *AllocateBlock(const char *label);         //!< Takes a block for Allocate
   void AllocateNewPage(GenericObject *&pageList); //!< Allocates page
+  unsigned char *AllocatePageMemory(size_t size, bool zeroed); //!< Takes the memory for a page from new[] or a chunk
+  void ReleasePageMemory(unsigned char *page, size_t size);    //!< Gives the memory of a page back to the OS
+  unsigned NextPageCapacity() const;              //!< Returns the number of blocks of the next page
+  void ReservePageNumbers(size_t count);          //!< Makes room to number count more pages
+  void NumberPage(PageInfo *info);                //!< Gives a page a number and enters it in the page table
+  void MapChunk();                                //!< Maps a new chunk of page slots
+  void UnmapChunks();                             //!< Unmaps every chunk (never throws)
+  void MapGuardSlots();                           //!< Maps the guarded slots and registers them for fault reports
+  void UnmapGuardSlots();                         //!< Unregisters and unmaps the guarded slots (never throws)
+  void *AllocateGuarded(const char *label);       //!< Puts a sampled block in a guarded slot (null if none is free)
+  void FreeGuarded(GenericObject *object);        //!< Frees a guarded block and protects its slot
+  void ProtectGuardSlot(size_t index);            //!< Gives back and protects the data of a slot
+  bool IsGuarded(const void *object) const;       //!< Checks if a block is in the guarded slots
   void PushToFreeList(GenericObject *object);     //!< Puts an object on the free list
+  void PushToPageFreeList(PageInfo *page, GenericObject *object); //!< Puts an object on its page's free list
+  GenericObject *PopFromPageFreeList(PageInfo *page);            //!< Takes an object off a page's free list
+  GenericObject *CarveBlock(PageInfo *page);                     //!< Formats the next uncarved block of a page
+  void LinkPartialPage(PageInfo *page);   //!< Adds a page to the pages with free blocks
+  void UnlinkPartialPage(PageInfo *page); //!< Removes a page from the pages with free blocks
+  void UpdateBucket(PageInfo *page);      //!< Moves a page to the bucket of its free block count
+  unsigned BucketOf(const PageInfo *page) const; //!< Returns the bucket of a page for its free blocks
+  PageInfo *FullestPartialPage() const;   //!< Returns the page to allocate from (or null)
+  void CountFreeObjects();                //!< Recounts the free blocks of every page from the global free list
+  void PushToRemoteFreeList(GenericObject *first, GenericObject *last); //!< Hands a chain of blocks freed by another thread to the owner
+  void CollectRemoteFrees();              //!< Frees the blocks handed over by other threads
+  void FreeLocal(GenericObject *object);  //!< Frees a block on the owning thread
+  void ReleaseBlock(GenericObject *object); //!< Checks a block being freed and resets its header
+  void PushBlock(GenericObject *object);  //!< Puts a block on its free list without touching the statistics
+  void *TryAllocateSlow(const char *label) noexcept; //!< TryAllocate when the inline path can't be taken
+  bool TryFreeSlow(void *object) noexcept;           //!< TryFree when the inline path can't be taken
+  void UpdateFastPaths();                 //!< Decides if TryAllocate and TryFree can take their inline paths
+
+  void *ProfileAllocate(const char *label);   //!< Allocate, with the allocation added to the profile
+  void ProfileFree(GenericObject *object);    //!< Free on the owning thread, timed when sampled
+  unsigned ProfileLabel(const char *label);   //!< Returns the index of a label in the profile
+  bool SampleLatency();                       //!< Checks if the current call is one to time
+  void RecordAllocation(void *object, unsigned label); //!< Adds an allocated block to the profile
+  void RecordFree(GenericObject *object);     //!< Removes a freed block from the profile
+  PageInfo *ProfilePage(GenericObject *object); //!< Returns the page of a block, trying the last one first
+  void RecordPageGrowth();                    //!< Adds a new page to the profile
+
+  void GrowPages();                           //!< Adopts the staged pages, or allocates a page if there are none
+  bool AdoptStagedPages();                    //!< Adds the pages staged by the helper thread
+  void RequestRefill();                       //!< Asks the helper thread for pages when below the watermark
+  void RefillLoop();                          //!< Body of the helper thread
+  PageInfo *StagePage(bool debug);            //!< Allocates and formats a page on the helper thread
+  void DeleteStagedPage(PageInfo *info);      //!< Frees a staged page that was not adopted
+  void StopRefill();                          //!< Stops the helper thread and frees the staged pages (never throws)
+  static void RecordLatency(uint64_t *histogram, std::chrono::steady_clock::time_point start); //!< Adds a time to a histogram
 
   void CheckBoundaries(unsigned char *address) const; //!< Check if an object is on a proper boundary
   bool ValidatePadding(unsigned char *paddingAddress, size_t size) const; //!< Checks if the padding at the address is corrupted
-  bool IsObjectInPage(GenericObject *pageAddress, unsigned char *address) const;  //!< Checks if object exists in the page list
-  bool IsObjectUsed(GenericObject *object) const; //!< Checks if the block is used
-  bool IsPageFree(GenericObject *page) const;   //!< Checks if page is free
-  void FreePage(GenericObject *page);    //!< Free a page
+  bool IsObjectInPage(const PageInfo *page, unsigned char *address) const;  //!< Checks if object exists in the page
+  PageInfo *FindPage(unsigned char *address) const; //!< Returns the page that holds the address (or null)
+  bool IsObjectUsed(const PageInfo *page, GenericObject *object) const; //!< Checks if the block is used
+  unsigned BlockIndex(const PageInfo *page, GenericObject *object) const; //!< Returns the slot of a block in its page
+  void SetOccupied(PageInfo *page, GenericObject *object, bool used);    //!< Sets the occupancy bit of a block
+  void RefreshOccupancy() const; //!< Rebuilds the occupancy bitmaps from the global free list
+  bool IsPageFree(const PageInfo *page) const;   //!< Checks if page is free
+  void FreePage(PageInfo *page);    //!< Free a page
+  void UnlinkFreePages();           //!< Takes the blocks of the free pages off the global free list
+  void ReleaseFreePages();          //!< Frees every page that is free
+  void MoveBlock(PageInfo *fromPage, GenericObject *from, GenericObject *to); //!< Copies an object and its header to another block
 
   // Formats the header block of a midblock
-  void InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE headerType, const char *label_);
+  void InitHeader(GenericObject *object, OAConfig::HBLOCK_TYPE headerType, const char *label_, unsigned allocNum);
   // Free the header block of a midblock
   void FreeHeader(GenericObject *object, OAConfig::HBLOCK_TYPE headerType);
+  // Returns the interned copy of a label of an external header
+  char *InternLabel(const char *label);
+  // Takes a MemBlockInfo record from the record pool
+  MemBlockInfo *AllocateInfo();
+  // Returns a MemBlockInfo record to the record pool
+  void FreeInfo(MemBlockInfo *info);
   // Returns the header address of a midblock
   unsigned char *GetHeaderAddress(GenericObject *object) const;
   // Returns the left padding address of a midblock
@@ -312,4 +662,75 @@ private:
   unsigned char *GetRightPadAdrress(GenericObject *object) const;
 };
 
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a block like Allocate. Without debugging,
+  headers, per-page free lists, profiling or guard sampling, allocating is
+  only taking the front of the free list, so that is done right here; the
+  rest (new pages, carving, checks) is left to Allocate.
+
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory, or null if there is none.
+*/
+/******************************************************************************/
+inline void *ObjectAllocator::TryAllocate(const char *label) noexcept
+{
+  GenericObject *object = FreeList_;
+  if (!FastAllocate_ || !object)
+    return TryAllocateSlow(label);
+
+  FreeList_ = object->Next;
+
+  if (++Stats_.ObjectsInUse_ > Stats_.MostObjects_)
+    Stats_.MostObjects_ = Stats_.ObjectsInUse_;
+  --Stats_.FreeObjects_;
+  ++Stats_.Allocations_;
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a block like Free. When TryAllocate can take its
+  inline path and only the owner frees, freeing is only pushing onto the
+  free list, so that is done right here.
+
+\par Object The objects address that needs to be freed.
+\return Whether the object was freed.
+*/
+/******************************************************************************/
+inline bool ObjectAllocator::TryFree(void *Object) noexcept
+{
+  if (!FastFree_)
+    return TryFreeSlow(Object);
+
+  GenericObject *object = reinterpret_cast<GenericObject *>(Object);
+  object->Next = FreeList_;
+  FreeList_ = object;
+
+  ++Stats_.Deallocations_;
+  --Stats_.ObjectsInUse_;
+  ++Stats_.FreeObjects_;
+
+  return true;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the object named by a handle. The page number
+  indexes the page table, which holds the first block of the page, and the
+  slot picks the block; entry 0 is null, so handle 0 gives null.
+
+\par Handle The handle of the object (or 0).
+\return The address of the object, or null for handle 0.
+*/
+/******************************************************************************/
+inline void *ObjectAllocator::ToPointer(OAHandle Handle) const
+{
+  return PageTable_[Handle >> SlotBits_] + (Handle & ((1ULL << SlotBits_) - 1)) * MidBlockSize_;
+}
+
 #endif
@@ -0,0 +1,664 @@
+/******************************************************************************/
+/*!
+\file   ObjectAllocatorT.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the Object Allocator template, an Object Allocator
+  whose object size and configuration are fixed at compile time.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef OBJECTALLOCATORTH
+#define OBJECTALLOCATORTH
+//---------------------------------------------------------------------------
+
+#include <algorithm> // std::sort, std::upper_bound, std::binary_search
+#include <cstring>   // std::memset, std::memcpy
+#include <new>       // std::bad_alloc
+#include <vector>
+#include "ObjectAllocator.h"
+
+// Keeps the rare path out of line, so the common path needs no stack frame
+#if defined(__GNUC__)
+#define OA_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define OA_NOINLINE __declspec(noinline)
+#else
+#define OA_NOINLINE
+#endif
+
+/*!
+  Compile-time configuration of an ObjectAllocatorT. The parameters mean the
+  same as the OAConfig fields of the same name. Additional is the number of
+  user-defined bytes of an extended header.
+
+  Statistics are kept when KeepStats is set, or when debugging or header
+  blocks need them. Otherwise GetStats() counts the pages and free blocks
+  on demand, and leaves the allocation counters at 0.
+*/
+template <unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE,
+          unsigned MaxPages = DEFAULT_MAX_PAGES,
+          bool DebugOn = false,
+          unsigned PadBytes = 0,
+          OAConfig::HBLOCK_TYPE HeaderType = OAConfig::hbNone,
+          unsigned Alignment = 0,
+          unsigned Additional = 0,
+          bool KeepStats = false>
+struct OAPolicy
+{
+  static constexpr unsigned ObjectsPerPage_ = ObjectsPerPage;      //!< number of objects on each page
+  static constexpr unsigned MaxPages_ = MaxPages;                  //!< maximum number of pages (0=unlimited)
+  static constexpr bool DebugOn_ = DebugOn;                        //!< enable/disable debugging code
+  static constexpr unsigned PadBytes_ = PadBytes;                  //!< size of the left/right padding for each block
+  static constexpr OAConfig::HBLOCK_TYPE HeaderType_ = HeaderType; //!< type of the header blocks
+  static constexpr unsigned Alignment_ = Alignment;                //!< address alignment of each block
+  static constexpr unsigned Additional_ = Additional;              //!< user-defined bytes of extended headers
+  static constexpr bool KeepStats_ = KeepStats;                    //!< keep the statistics up to date
+};
+
+/*!
+  A release configuration: no checks, no headers, no statistics
+*/
+template <unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE, unsigned MaxPages = 0>
+using OAReleasePolicy = OAPolicy<ObjectsPerPage, MaxPages>;
+
+/*!
+  A debug configuration: signatures, padding and basic headers
+*/
+template <unsigned ObjectsPerPage = DEFAULT_OBJECTS_PER_PAGE, unsigned MaxPages = 0, unsigned PadBytes = 8>
+using OADebugPolicy = OAPolicy<ObjectsPerPage, MaxPages, true, PadBytes, OAConfig::hbBasic>;
+
+/*!
+  An Object Allocator configured at compile time.
+
+  The pages have the same layout as the pages of an ObjectAllocator with
+  the same configuration, and the same checks are made, but every offset is
+  a constant and every disabled feature is compiled out. With a release
+  policy, Allocate and Free are a pop and a push on the free list.
+
+  External headers are not supported.
+*/
+template <size_t Size, typename Policy = OAReleasePolicy<>>
+class ObjectAllocatorT
+{
+public:
+  // Creates the allocator and its first page
+  // Throws an exception if the construction fails. (Memory allocation problem)
+  ObjectAllocatorT();
+
+  // Destroys the allocator (never throws)
+  ~ObjectAllocatorT();
+
+  // Take an object from the free list and give it to the client (simulates new)
+  // Throws an exception if the object can't be allocated. (Memory allocation problem)
+  void *Allocate(const char *label = 0);
+
+  // Returns an object to the free list for the client (simulates delete)
+  // Throws an exception if the the object can't be freed. (Invalid object, debug policies only)
+  void Free(void *Object);
+
+  // Calls the callback fn for each block still in use
+  unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+  // Calls the callback fn for each block that is potentially corrupted
+  unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const;
+
+  // Frees all empty pages
+  unsigned FreeEmptyPages();
+
+  // Testing/Debugging/Statistic methods
+  const void *GetFreeList() const; // returns a pointer to the internal free list
+  const void *GetPageList() const; // returns a pointer to the internal page list
+  OAConfig GetConfig() const;      // returns the configuration parameters
+  OAStats GetStats() const;        // returns the statistics for the allocator
+                                   // (without TRACK_STATS, walks the free list: O(free objects))
+
+  // Prevent copy construction and assignment
+  ObjectAllocatorT(const ObjectAllocatorT &oa) = delete;            //!< Do not implement!
+  ObjectAllocatorT &operator=(const ObjectAllocatorT &oa) = delete; //!< Do not implement!
+
+private:
+  using BYTE = unsigned char; //!< Type of byte
+
+  //! Returns the closest multiple of alignment that is not less than n
+  static constexpr size_t Align(size_t n, size_t alignment)
+  {
+    return alignment ? (n + alignment - 1) / alignment * alignment : n;
+  }
+
+  static constexpr OAConfig::HBLOCK_TYPE HEADER_TYPE = Policy::HeaderType_; //!< Type of the header blocks
+  static constexpr size_t PTR_SIZE = sizeof(GenericObject *);             //!< Size of a pointer
+  static constexpr size_t PAD = Policy::PadBytes_;                        //!< Size of each padding
+  static constexpr size_t HEADER_SIZE = HEADER_TYPE == OAConfig::hbBasic ? OAConfig::BASIC_HEADER_SIZE
+                                        : HEADER_TYPE == OAConfig::hbExtended
+                                            ? sizeof(unsigned) + sizeof(unsigned short) + 1 + Policy::Additional_
+                                            : 0; //!< Size of a header block
+  static constexpr size_t FLAG_OFFSET = HEADER_SIZE - 1; //!< Offset of the in-use flag in a header block
+  static constexpr size_t LEFT_HEADER_SIZE = PTR_SIZE + HEADER_SIZE + PAD;                //!< Page header before alignment
+  static constexpr size_t PAGE_HEADER_SIZE = Align(LEFT_HEADER_SIZE, Policy::Alignment_);  //!< Page header
+  static constexpr size_t BLOCK_SIZE = Size + 2 * PAD + HEADER_SIZE;                     //!< Midblock before alignment
+  static constexpr size_t MID_BLOCK_SIZE = Align(BLOCK_SIZE, Policy::Alignment_);        //!< Midblock
+  static constexpr size_t LEFT_ALIGN_SIZE = PAGE_HEADER_SIZE - LEFT_HEADER_SIZE;         //!< Alignment of the first block
+  static constexpr size_t INTER_ALIGN_SIZE = MID_BLOCK_SIZE - BLOCK_SIZE;                //!< Alignment between blocks
+  static constexpr size_t PAGE_SIZE = PTR_SIZE + LEFT_ALIGN_SIZE + Policy::ObjectsPerPage_ * MID_BLOCK_SIZE - INTER_ALIGN_SIZE; //!< Size of a page
+  static constexpr bool TRACK_STATS = Policy::KeepStats_ || Policy::DebugOn_ || HEADER_TYPE != OAConfig::hbNone; //!< Counters kept up to date
+
+  static_assert(Size >= sizeof(GenericObject *), "ObjectAllocatorT: objects must be able to hold a pointer");
+  static_assert(Policy::ObjectsPerPage_ > 0, "ObjectAllocatorT: pages must hold at least one object");
+  static_assert(HEADER_TYPE != OAConfig::hbExternal, "ObjectAllocatorT: external headers are not supported");
+
+  GenericObject *PageList_; //!< the beginning of the list of pages
+  GenericObject *FreeList_; //!< the beginning of the list of objects
+  OAStats Stats_;           //!< Statistics (only the page and object sizes unless TRACK_STATS)
+  std::vector<GenericObject *> PageIndex_; //!< every page, sorted by address
+
+  void AllocateNewPage();          //!< Allocates a page and puts its blocks on the free list
+  OA_NOINLINE GenericObject *PopFromNewPage(); //!< Allocates a page and takes the first block of its free list
+  void CheckBlock(GenericObject *object) const; //!< Runs the debug checks on a block being freed
+  size_t PageOf(const GenericObject *object) const; //!< Returns the index of the page below an address
+  bool IsUsed(GenericObject *object, const std::vector<const GenericObject *> &freeBlocks) const; //!< Checks if a block is in use
+  std::vector<const GenericObject *> SortedFreeList() const; //!< Returns the free blocks sorted by address
+
+  static BYTE *HeaderOf(GenericObject *object) //!< Returns the header block of a block
+  {
+    return reinterpret_cast<BYTE *>(object) - PAD - HEADER_SIZE;
+  }
+  static bool PaddingIntact(const BYTE *padding) //!< Checks that a padding still holds PAD_PATTERN
+  {
+    return ObjectAllocator::MatchesPattern(padding, PAD, ObjectAllocator::PAD_PATTERN);
+  }
+};
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor of an Object Allocator template. The first page
+  is allocated right away, as with ObjectAllocator.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+ObjectAllocatorT<Size, Policy>::ObjectAllocatorT() : PageList_{nullptr}, FreeList_{nullptr}, Stats_{}
+{
+  Stats_.ObjectSize_ = Size;
+  Stats_.PageSize_ = PAGE_SIZE;
+  AllocateNewPage();
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor of an Object Allocator template.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+ObjectAllocatorT<Size, Policy>::~ObjectAllocatorT()
+{
+  while (PageList_)
+  {
+    GenericObject *next = PageList_->Next;
+    delete[] reinterpret_cast<BYTE *>(PageList_);
+    PageList_ = next;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function provides block of memory to store an object.
+
+\par label Ignored; only external headers keep labels.
+\return A pointer to an allocated block of memory.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+void *ObjectAllocatorT<Size, Policy>::Allocate(const char *)
+{
+  // the new page case pops the block itself, so nothing is live across the call
+  GenericObject *object = FreeList_;
+  if (nullptr != object)
+    FreeList_ = object->Next;
+  else
+    object = PopFromNewPage();
+
+  if constexpr (TRACK_STATS)
+  {
+    ++Stats_.ObjectsInUse_;
+    if (Stats_.ObjectsInUse_ > Stats_.MostObjects_)
+      Stats_.MostObjects_ = Stats_.ObjectsInUse_;
+    --Stats_.FreeObjects_;
+    ++Stats_.Allocations_;
+  }
+
+  if constexpr (Policy::DebugOn_)
+    std::memset(object, ObjectAllocator::ALLOCATED_PATTERN, Size);
+
+  if constexpr (HEADER_TYPE == OAConfig::hbBasic)
+  {
+    BYTE *header = HeaderOf(object);
+    std::memcpy(header, &Stats_.Allocations_, sizeof(unsigned));
+    header[FLAG_OFFSET] = 1;
+  }
+  else if constexpr (HEADER_TYPE == OAConfig::hbExtended)
+  {
+    BYTE *header = HeaderOf(object) + Policy::Additional_;
+    unsigned short counter;
+    std::memcpy(&counter, header, sizeof(counter));
+    ++counter;
+    std::memcpy(header, &counter, sizeof(counter));
+    std::memcpy(header + sizeof(counter), &Stats_.Allocations_, sizeof(unsigned));
+    header[sizeof(counter) + sizeof(unsigned)] = 1;
+  }
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees block of memory used by an object. Debug policies
+  check the boundary, the padding and for double frees first.
+
+\par Object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+void ObjectAllocatorT<Size, Policy>::Free(void *Object)
+{
+  GenericObject *object = static_cast<GenericObject *>(Object);
+
+  if constexpr (TRACK_STATS)
+    ++Stats_.Deallocations_;
+
+  if constexpr (Policy::DebugOn_)
+  {
+    CheckBlock(object);
+    std::memset(object, ObjectAllocator::FREED_PATTERN, Size);
+  }
+
+  if constexpr (HEADER_TYPE == OAConfig::hbBasic)
+    std::memset(HeaderOf(object), 0, HEADER_SIZE);
+  else if constexpr (HEADER_TYPE == OAConfig::hbExtended)
+    std::memset(HeaderOf(object) + Policy::Additional_ + sizeof(unsigned short), 0, OAConfig::BASIC_HEADER_SIZE);
+
+  object->Next = FreeList_;
+  FreeList_ = object;
+
+  if constexpr (TRACK_STATS)
+  {
+    --Stats_.ObjectsInUse_;
+    ++Stats_.FreeObjects_;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any active object in the allocator.
+
+\par fn The callback function.
+\return The number of blocks in use.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+unsigned ObjectAllocatorT<Size, Policy>::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  std::vector<const GenericObject *> freeBlocks;
+  if constexpr (HEADER_TYPE == OAConfig::hbNone)
+    freeBlocks = SortedFreeList();
+
+  unsigned inUse = 0;
+  for (GenericObject *page = PageList_; page; page = page->Next)
+  {
+    BYTE *block = reinterpret_cast<BYTE *>(page) + PAGE_HEADER_SIZE;
+    for (unsigned i = 0; i < Policy::ObjectsPerPage_; ++i, block += MID_BLOCK_SIZE)
+    {
+      GenericObject *object = reinterpret_cast<GenericObject *>(block);
+      if (IsUsed(object, freeBlocks))
+      {
+        fn(object, Size);
+        ++inUse;
+      }
+    }
+  }
+  return inUse;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any corrupted object in the
+  allocator. Only debug policies with padding can detect corruption.
+
+\par fn The callback function.
+\return The number of blocks that are corrupted.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+unsigned ObjectAllocatorT<Size, Policy>::ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+{
+  if constexpr (!Policy::DebugOn_ || PAD == 0)
+  {
+    (void)fn;
+    return 0;
+  }
+  else
+  {
+    unsigned corrupted = 0;
+    for (GenericObject *page = PageList_; page; page = page->Next)
+    {
+      BYTE *block = reinterpret_cast<BYTE *>(page) + PAGE_HEADER_SIZE;
+      for (unsigned i = 0; i < Policy::ObjectsPerPage_; ++i, block += MID_BLOCK_SIZE)
+      {
+        if (!PaddingIntact(block - PAD) || !PaddingIntact(block + Size))
+        {
+          fn(block, Size);
+          ++corrupted;
+        }
+      }
+    }
+    return corrupted;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees the pages that have no block in use.
+
+\return The number of pages freed.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+unsigned ObjectAllocatorT<Size, Policy>::FreeEmptyPages()
+{
+  // count the free blocks of every page, found by address
+  std::vector<unsigned> freeCounts(PageIndex_.size(), 0);
+  for (GenericObject *object = FreeList_; object; object = object->Next)
+    ++freeCounts[PageOf(object)];
+
+  auto isEmpty = [&](GenericObject *object) { return freeCounts[PageOf(object)] == Policy::ObjectsPerPage_; };
+
+  GenericObject **link = &FreeList_;
+  while (*link)
+  {
+    if (isEmpty(*link))
+      *link = (*link)->Next;
+    else
+      link = &(*link)->Next;
+  }
+
+  link = &PageList_;
+  while (*link)
+  {
+    if (isEmpty(*link))
+      *link = (*link)->Next;
+    else
+      link = &(*link)->Next;
+  }
+
+  unsigned freed = 0;
+  size_t kept = 0;
+  for (size_t i = 0; i < PageIndex_.size(); ++i)
+  {
+    if (freeCounts[i] == Policy::ObjectsPerPage_)
+    {
+      delete[] reinterpret_cast<BYTE *>(PageIndex_[i]);
+      ++freed;
+    }
+    else
+      PageIndex_[kept++] = PageIndex_[i];
+  }
+  PageIndex_.resize(kept);
+
+  if constexpr (TRACK_STATS)
+    Stats_.FreeObjects_ -= freed * Policy::ObjectsPerPage_;
+
+  return freed;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the free list of the allocator.
+
+\return Pointer to the free list.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+const void *ObjectAllocatorT<Size, Policy>::GetFreeList() const
+{
+  return FreeList_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the page list of the allocator.
+
+\return Pointer to the page list.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+const void *ObjectAllocatorT<Size, Policy>::GetPageList() const
+{
+  return PageList_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the configuration of the policy, as the OAConfig
+  of an equivalent ObjectAllocator.
+
+\return The configuration.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+OAConfig ObjectAllocatorT<Size, Policy>::GetConfig() const
+{
+  OAConfig config(false, Policy::ObjectsPerPage_, Policy::MaxPages_, Policy::DebugOn_, Policy::PadBytes_,
+                  OAConfig::HeaderBlockInfo(HEADER_TYPE, Policy::Additional_), Policy::Alignment_);
+  config.LeftAlignSize_ = static_cast<unsigned>(LEFT_ALIGN_SIZE);
+  config.InterAlignSize_ = static_cast<unsigned>(INTER_ALIGN_SIZE);
+  return config;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the statistics of the allocator. Without kept
+  statistics, the free blocks are counted now, by a walk of the free list
+  that takes time in the number of free blocks, and the allocation
+  counters are 0. Keep statistics (KeepStats) to call this often.
+
+\return A copy of the statistics.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+OAStats ObjectAllocatorT<Size, Policy>::GetStats() const
+{
+  OAStats stats = Stats_;
+  stats.PagesInUse_ = static_cast<unsigned>(PageIndex_.size());
+  stats.ReservedBytes_ = stats.ResidentBytes_ = PageIndex_.size() * PAGE_SIZE;
+  stats.Capacity_ = stats.PagesInUse_ * Policy::ObjectsPerPage_;
+
+  if constexpr (!TRACK_STATS)
+  {
+    for (const GenericObject *object = FreeList_; object; object = object->Next)
+      ++stats.FreeObjects_;
+    stats.ObjectsInUse_ = stats.PagesInUse_ * Policy::ObjectsPerPage_ - stats.FreeObjects_;
+  }
+
+  return stats;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a page and puts its blocks on the free list, in
+  the same order as ObjectAllocator.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+void ObjectAllocatorT<Size, Policy>::AllocateNewPage()
+{
+  if (Policy::MaxPages_ && PageIndex_.size() == Policy::MaxPages_)
+    throw OAException(OAException::E_NO_PAGES, "Out of pages!");
+
+  BYTE *page = nullptr;
+  try
+  {
+    PageIndex_.reserve(PageIndex_.size() + 1);
+    page = new BYTE[PAGE_SIZE];
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "AllocateNewPage: No system memory available!");
+  }
+
+  if constexpr (Policy::DebugOn_)
+    std::memset(page, ObjectAllocator::ALIGN_PATTERN, PAGE_SIZE);
+
+  reinterpret_cast<GenericObject *>(page)->Next = PageList_;
+  PageList_ = reinterpret_cast<GenericObject *>(page);
+  PageIndex_.insert(std::upper_bound(PageIndex_.begin(), PageIndex_.end(), PageList_), PageList_);
+
+  BYTE *block = page + PAGE_HEADER_SIZE;
+  for (unsigned i = 0; i < Policy::ObjectsPerPage_; ++i, block += MID_BLOCK_SIZE)
+  {
+    GenericObject *object = reinterpret_cast<GenericObject *>(block);
+    object->Next = FreeList_;
+    FreeList_ = object;
+
+    if constexpr (Policy::DebugOn_)
+    {
+      std::memset(block + PTR_SIZE, ObjectAllocator::UNALLOCATED_PATTERN, Size - PTR_SIZE);
+      std::memset(block - PAD, ObjectAllocator::PAD_PATTERN, PAD);
+      std::memset(block + Size, ObjectAllocator::PAD_PATTERN, PAD);
+    }
+    if constexpr (HEADER_SIZE != 0)
+      std::memset(HeaderOf(object), 0, HEADER_SIZE);
+  }
+
+  if constexpr (TRACK_STATS)
+    Stats_.FreeObjects_ += Policy::ObjectsPerPage_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function allocates a page and takes the block at the front of the
+  free list, for Allocate when the free list is empty.
+
+\return The block taken.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+GenericObject *ObjectAllocatorT<Size, Policy>::PopFromNewPage()
+{
+  AllocateNewPage();
+  GenericObject *object = FreeList_;
+  FreeList_ = object->Next;
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function runs the debug checks on a block being freed: the block
+  must start on a block boundary of one of the pages, its padding must be
+  intact, and it must not be free already.
+
+\par object The block being freed.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+void ObjectAllocatorT<Size, Policy>::CheckBlock(GenericObject *object) const
+{
+  BYTE *address = reinterpret_cast<BYTE *>(object);
+
+  size_t index = PageOf(object);
+  if (index == PageIndex_.size() || address >= reinterpret_cast<BYTE *>(PageIndex_[index]) + PAGE_SIZE)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not on any page!");
+
+  BYTE *first = reinterpret_cast<BYTE *>(PageIndex_[index]) + PAGE_HEADER_SIZE;
+  if (address < first || static_cast<size_t>(address - first) % MID_BLOCK_SIZE != 0)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not on boundary!");
+
+  if (!PaddingIntact(address - PAD))
+    throw OAException(OAException::E_CORRUPTED_BLOCK, "Free: Corrupted left padding!");
+  if (!PaddingIntact(address + Size))
+    throw OAException(OAException::E_CORRUPTED_BLOCK, "Free: Corrupted right padding!");
+
+  bool freed;
+  if constexpr (HEADER_TYPE == OAConfig::hbNone)
+    freed = address[Size - 1] == ObjectAllocator::FREED_PATTERN;
+  else
+    freed = HeaderOf(object)[FLAG_OFFSET] == 0;
+
+  if (freed)
+    throw OAException(OAException::E_MULTIPLE_FREE, "Free: Object has already been freed!");
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the page that starts at or below an address with a
+  binary search of the page index.
+
+\par object The address.
+\return The index of the page in PageIndex_, or the size of the index if
+        every page starts above the address.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+size_t ObjectAllocatorT<Size, Policy>::PageOf(const GenericObject *object) const
+{
+  auto it = std::upper_bound(PageIndex_.begin(), PageIndex_.end(), object);
+  return it == PageIndex_.begin() ? PageIndex_.size() : static_cast<size_t>(it - PageIndex_.begin() - 1);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks if a block is in use. Headers carry an in-use flag;
+  without headers, the block is looked up among the free blocks.
+
+\par object The block.
+\par freeBlocks The free blocks sorted by address (without headers only).
+\return Whether the block is in use.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+bool ObjectAllocatorT<Size, Policy>::IsUsed(GenericObject *object,
+                                            const std::vector<const GenericObject *> &freeBlocks) const
+{
+  if constexpr (HEADER_TYPE == OAConfig::hbNone)
+    return !std::binary_search(freeBlocks.begin(), freeBlocks.end(), object);
+  else
+    return HeaderOf(object)[FLAG_OFFSET] != 0;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the free blocks sorted by address.
+
+\return The free blocks.
+*/
+/******************************************************************************/
+template <size_t Size, typename Policy>
+std::vector<const GenericObject *> ObjectAllocatorT<Size, Policy>::SortedFreeList() const
+{
+  std::vector<const GenericObject *> blocks;
+  for (const GenericObject *object = FreeList_; object; object = object->Next)
+    blocks.push_back(object);
+  std::sort(blocks.begin(), blocks.end());
+  return blocks;
+}
+
+#endif
@@ -0,0 +1,191 @@
+/******************************************************************************/
+/*!
+\file   ObjectPool.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the Object Pool, a typed front-end that constructs
+  and destroys objects in the blocks of an ObjectAllocator.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef OBJECTPOOLH
+#define OBJECTPOOLH
+//---------------------------------------------------------------------------
+
+#include <memory>  // std::unique_ptr
+#include <new>     // placement new, operator new/delete
+#include <utility> // std::forward
+#include "ObjectAllocator.h"
+
+/*!
+  Typed view of an ObjectAllocator whose blocks hold objects of type T.
+
+  emplace() takes a block and constructs the object in it, forwarding its
+  arguments to the constructor, so nothing is copied on the way. destroy()
+  runs the destructor and returns the block. make() does the same as
+  emplace() but returns a std::unique_ptr that destroys the object.
+
+  The pool does not own the allocator, and holds nothing else, so it is
+  cheap to create wherever it is needed. Without an allocator, the objects
+  come from operator new instead.
+*/
+template <typename T>
+class ObjectPool
+{
+public:
+  /*!
+    Destroys an object of the pool; usable as the deleter of a unique_ptr
+  */
+  struct Deleter
+  {
+    ObjectAllocator *Allocator; //!< The allocator of the object (may be 0)
+
+    /*!
+      Destroys the object and returns its block.
+
+      \param object
+        The object (may be 0).
+    */
+    void operator()(T *object) const
+    {
+      if (object)
+        ObjectPool(Allocator).destroy(object);
+    }
+  };
+
+  //! An object of the pool that is destroyed when it goes out of scope
+  typedef std::unique_ptr<T, Deleter> Handle;
+
+  /*!
+    Creates a pool over an allocator.
+
+    \param allocator
+      The allocator whose blocks hold the objects, with blocks of at least
+      sizeof(T) bytes (0: use operator new).
+  */
+  explicit ObjectPool(ObjectAllocator *allocator = 0) : Allocator_(allocator)
+  {
+  }
+
+  // Constructs an object in a new block with the given constructor arguments
+  // Throws what the allocator or the constructor throws; the block is returned then.
+  template <typename... Args>
+  T *emplace(Args &&...args);
+
+  // Destroys an object made by emplace and returns its block
+  void destroy(T *object);
+
+  // Same as emplace, but the object is destroyed with the handle
+  template <typename... Args>
+  Handle make(Args &&...args);
+
+  // Returns a deleter that destroys the objects of this pool
+  Deleter get_deleter() const;
+
+  // Returns the allocator of the pool (may be 0)
+  ObjectAllocator *allocator() const;
+
+private:
+  ObjectAllocator *Allocator_; //!< Where the blocks come from (0: operator new)
+};
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes a block and constructs an object in it. If the
+  constructor throws, the block is returned before the exception goes on.
+
+\par args The arguments of the constructor of T.
+\return The new object.
+*/
+/******************************************************************************/
+template <typename T>
+template <typename... Args>
+T *ObjectPool<T>::emplace(Args &&...args)
+{
+  void *block = Allocator_ ? Allocator_->Allocate() : ::operator new(sizeof(T));
+
+  try
+  {
+    return new (block) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    if (Allocator_)
+      Allocator_->Free(block);
+    else
+      ::operator delete(block);
+    throw;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function destroys an object and returns its block.
+
+\par object The object, made by emplace or make with the same allocator.
+*/
+/******************************************************************************/
+template <typename T>
+void ObjectPool<T>::destroy(T *object)
+{
+  object->~T();
+
+  if (Allocator_)
+    Allocator_->Free(object);
+  else
+    ::operator delete(object);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function constructs an object like emplace, and hands it to a
+  unique_ptr that destroys it with this pool's allocator.
+
+\par args The arguments of the constructor of T.
+\return The handle that owns the new object.
+*/
+/******************************************************************************/
+template <typename T>
+template <typename... Args>
+typename ObjectPool<T>::Handle ObjectPool<T>::make(Args &&...args)
+{
+  return Handle(emplace(std::forward<Args>(args)...), get_deleter());
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns a deleter for the objects of this pool.
+
+\return The deleter.
+*/
+/******************************************************************************/
+template <typename T>
+typename ObjectPool<T>::Deleter ObjectPool<T>::get_deleter() const
+{
+  Deleter deleter = {Allocator_};
+  return deleter;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the allocator of the pool.
+
+\return The allocator (0 when objects come from operator new).
+*/
+/******************************************************************************/
+template <typename T>
+ObjectAllocator *ObjectPool<T>::allocator() const
+{
+  return Allocator_;
+}
+
+#endif
@@ -0,0 +1,460 @@
+/******************************************************************************/
+/*!
+\file   SmallObjectHeap.cpp
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the implementation for the Small Object Heap.
+*/
+/******************************************************************************/
+#include "SmallObjectHeap.h"
+#include <algorithm> //<! std::lower_bound, std::upper_bound
+
+namespace
+{
+  //! Largest request of each size class. Spaced 8 bytes apart for the
+  //! smallest sizes and about 25% apart above that, so no more than a
+  //! fifth of a block is ever wasted by rounding up.
+  const size_t SIZE_CLASSES[] = {8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256};
+
+  constexpr unsigned CLASS_COUNT = sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]); //!< Number of size classes
+  constexpr size_t CLASS_STEP = 8;                                                 //!< Granularity of ClassOf_
+  constexpr unsigned NO_CLASS = CLASS_COUNT;                                       //!< Returned for unknown blocks
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor of a Small Object Heap. No memory is allocated
+  for blocks until a size class is first used.
+
+\par config The configuration of every size class.
+*/
+/******************************************************************************/
+SmallObjectHeap::SmallObjectHeap(const OAConfig &config)
+    : Config_{config}, Pools_(CLASS_COUNT, nullptr), PageHeads_(CLASS_COUNT, nullptr),
+      RequestedBytes_(CLASS_COUNT, 0), ClassOf_(MAX_SMALL_OBJECT_SIZE / CLASS_STEP + 1)
+{
+  for (size_t i = 0; i < ClassOf_.size(); ++i)
+  {
+    const size_t *match = std::lower_bound(SIZE_CLASSES, SIZE_CLASSES + CLASS_COUNT, i * CLASS_STEP);
+    ClassOf_[i] = static_cast<unsigned char>(match - SIZE_CLASSES);
+  }
+
+  // blocks are matched to their size class by their page, so pages all have
+  // one size, and guarded blocks (which have no page) are not used
+  Config_.GuardSampleRate_ = 0;
+  Config_.GrowthFactor_ = 1;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor of a Small Object Heap.
+*/
+/******************************************************************************/
+SmallObjectHeap::~SmallObjectHeap()
+{
+  for (ObjectAllocator *pool : Pools_)
+    delete pool;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function provides a block of at least \p Size bytes.
+
+\par Size The number of bytes requested.
+\par label A label for the block of memory requested.
+\return A pointer to an allocated block of memory.
+*/
+/******************************************************************************/
+void *SmallObjectHeap::Allocate(size_t Size, const char *label)
+{
+  if (Size > MAX_SMALL_OBJECT_SIZE)
+    throw OAException(OAException::E_NO_MEMORY, "Allocate: Size is larger than the largest size class!");
+
+  unsigned index = SizeClass(Size);
+  ObjectAllocator *pool = GetPool(index);
+  void *object = pool->Allocate(label);
+
+  // new pages go to the front of the page list
+  if (pool->GetPageList() != PageHeads_[index])
+  {
+    try
+    {
+      AddPage(index);
+    }
+    catch (const OAException &)
+    {
+      // Free could not find the block without its page in the index
+      pool->Free(object);
+      throw;
+    }
+  }
+
+  RequestedBytes_[index] += Size;
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a block. The size class that owns the block is found
+  with a binary search of the pages of every size class.
+
+\par Object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+void SmallObjectHeap::Free(void *Object)
+{
+  unsigned index = FindClass(Object);
+
+  if (index == NO_CLASS)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not in any size class!");
+
+  Pools_[index]->Free(Object);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees a block whose requested size is known, which skips
+  the lookup of the owning size class.
+
+\par Object The objects address that needs to be freed.
+\par Size The size given to Allocate for this block.
+*/
+/******************************************************************************/
+void SmallObjectHeap::Free(void *Object, size_t Size)
+{
+  if (Size > MAX_SMALL_OBJECT_SIZE || !Pools_[SizeClass(Size)])
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not in any size class!");
+
+  Pools_[SizeClass(Size)]->Free(Object);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any active object in the heap.
+
+\par fn The callback function.
+\return The number of blocks in use.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  unsigned inUse = 0;
+  for (const ObjectAllocator *pool : Pools_)
+  {
+    if (pool)
+      inUse += pool->DumpMemoryInUse(fn);
+  }
+  return inUse;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on any corrupted object in the heap.
+
+\par fn The callback function.
+\return The number of blocks that are corrupted.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+{
+  unsigned corrupted = 0;
+  for (const ObjectAllocator *pool : Pools_)
+  {
+    if (pool)
+      corrupted += pool->ValidatePages(fn);
+  }
+  return corrupted;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees the empty pages of every size class.
+
+\return The number of pages freed.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::FreeEmptyPages()
+{
+  unsigned freed = 0;
+  for (ObjectAllocator *pool : Pools_)
+  {
+    if (pool)
+      freed += pool->FreeEmptyPages();
+  }
+
+  if (freed)
+    RebuildPageIndex();
+
+  return freed;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function compacts every size class with ObjectAllocator::Compact.
+
+\par fn The callback function, called for each block moved (may be null).
+\par Context Passed to \p fn as is.
+\return The number of pages freed.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::Compact(ObjectAllocator::RELOCATECALLBACK fn, void *Context)
+{
+  unsigned freed = 0;
+  for (ObjectAllocator *pool : Pools_)
+  {
+    if (pool)
+      freed += pool->Compact(fn, Context);
+  }
+
+  if (freed)
+    RebuildPageIndex();
+
+  return freed;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function releases every block of every size class at once, with
+  ObjectAllocator::ResetAll.
+
+\par KeepPages Keep the pages for reuse (true) or give them all back (false).
+\return Whether the blocks were released (false with the C++ memory manager).
+*/
+/******************************************************************************/
+bool SmallObjectHeap::ResetAll(bool KeepPages)
+{
+  bool released = true;
+  for (ObjectAllocator *pool : Pools_)
+  {
+    if (pool)
+      released = pool->ResetAll(KeepPages) && released;
+  }
+
+  if (!KeepPages)
+    RebuildPageIndex();
+
+  return released;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the number of size classes.
+
+\return The number of size classes.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::GetClassCount() const
+{
+  return CLASS_COUNT;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the statistics of one size class. A size class
+  that was never used reports no pages and no objects.
+
+\par Class The size class, from 0 to GetClassCount() - 1.
+\return The statistics of the size class.
+*/
+/******************************************************************************/
+SizeClassStats SmallObjectHeap::GetClassStats(unsigned Class) const
+{
+  SizeClassStats stats;
+
+  if (Class >= CLASS_COUNT)
+    return stats;
+
+  if (Pools_[Class])
+    static_cast<OAStats &>(stats) = Pools_[Class]->GetStats();
+  else
+    stats.ObjectSize_ = SIZE_CLASSES[Class];
+
+  stats.ClassSize_ = SIZE_CLASSES[Class];
+  stats.RequestedBytes_ = RequestedBytes_[Class];
+
+  return stats;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the statistics summed over every size class. The
+  object and page sizes differ between classes, so they are left at 0, and
+  MostObjects_ is the sum of the peaks of each class.
+
+\return The combined statistics.
+*/
+/******************************************************************************/
+OAStats SmallObjectHeap::GetStats() const
+{
+  OAStats total;
+
+  for (const ObjectAllocator *pool : Pools_)
+  {
+    if (!pool)
+      continue;
+
+    OAStats stats = pool->GetStats();
+    total.FreeObjects_ += stats.FreeObjects_;
+    total.ObjectsInUse_ += stats.ObjectsInUse_;
+    total.PagesInUse_ += stats.PagesInUse_;
+    total.MostObjects_ += stats.MostObjects_;
+    total.Allocations_ += stats.Allocations_;
+    total.Deallocations_ += stats.Deallocations_;
+    total.ReservedBytes_ += stats.ReservedBytes_;
+    total.ResidentBytes_ += stats.ResidentBytes_;
+    total.Capacity_ += stats.Capacity_;
+  }
+
+  return total;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the smallest size class that can hold a request.
+
+\par size The number of bytes requested (at most MAX_SMALL_OBJECT_SIZE).
+\return The index of the size class.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::SizeClass(size_t size) const
+{
+  return ClassOf_[(size + CLASS_STEP - 1) / CLASS_STEP];
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the allocator of a size class, and creates it the
+  first time the class is used.
+
+\par index The index of the size class.
+\return The allocator of the size class.
+*/
+/******************************************************************************/
+ObjectAllocator *SmallObjectHeap::GetPool(unsigned index)
+{
+  if (!Pools_[index])
+  {
+    try
+    {
+      Pools_[index] = new ObjectAllocator(SIZE_CLASSES[index], Config_);
+      PageIndex_.reserve(PageIndex_.size() + 1);
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "GetPool: No system memory available!");
+    }
+    AddPage(index);
+  }
+  return Pools_[index];
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds the newest pages of a size class to the page index.
+  A size class only ever adds pages at the front of its page list: one at
+  a time, or several at once when a background refill is adopted. Pages
+  already indexed are skipped, so after a failure the whole list can be
+  walked again.
+
+\par index The index of the size class.
+*/
+/******************************************************************************/
+void SmallObjectHeap::AddPage(unsigned index)
+{
+  const void *indexed = PageHeads_[index];
+  const void *head = Pools_[index]->GetPageList();
+  PageHeads_[index] = head;
+
+  size_t pageSize = Pools_[index]->GetStats().PageSize_;
+  for (const GenericObject *page = static_cast<const GenericObject *>(head); page && page != indexed; page = page->Next)
+  {
+    const unsigned char *start = reinterpret_cast<const unsigned char *>(page);
+    PageRange range{start, start + pageSize, index};
+
+    auto position = std::upper_bound(PageIndex_.begin(), PageIndex_.end(), range,
+                                     [](const PageRange &lhs, const PageRange &rhs) { return lhs.Start < rhs.Start; });
+    if (position != PageIndex_.begin() && (position - 1)->Start == start)
+      continue;
+
+    try
+    {
+      PageIndex_.insert(position, range);
+    }
+    catch (std::bad_alloc &)
+    {
+      // try again on the next allocation from this size class
+      PageHeads_[index] = nullptr;
+      throw OAException(OAException::E_NO_MEMORY, "AddPage: No system memory available!");
+    }
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function indexes the pages of every size class again, after some of
+  them have been released.
+*/
+/******************************************************************************/
+void SmallObjectHeap::RebuildPageIndex()
+{
+  PageIndex_.clear();
+
+  for (unsigned i = 0; i < CLASS_COUNT; ++i)
+  {
+    if (!Pools_[i])
+      continue;
+
+    size_t pageSize = Pools_[i]->GetStats().PageSize_;
+    PageHeads_[i] = Pools_[i]->GetPageList();
+    for (const GenericObject *page = static_cast<const GenericObject *>(PageHeads_[i]); page; page = page->Next)
+    {
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(page);
+      PageIndex_.push_back(PageRange{start, start + pageSize, i});
+    }
+  }
+
+  std::sort(PageIndex_.begin(), PageIndex_.end(),
+            [](const PageRange &lhs, const PageRange &rhs) { return lhs.Start < rhs.Start; });
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the size class that owns a block.
+
+\par object The address of the block.
+\return The index of the size class, or NO_CLASS if no page holds the address.
+*/
+/******************************************************************************/
+unsigned SmallObjectHeap::FindClass(const void *object) const
+{
+  const unsigned char *address = static_cast<const unsigned char *>(object);
+  auto it = std::upper_bound(PageIndex_.begin(), PageIndex_.end(), address,
+                             [](const unsigned char *lhs, const PageRange &rhs) { return lhs < rhs.Start; });
+
+  if (it == PageIndex_.begin() || address >= (it - 1)->End)
+    return NO_CLASS;
+
+  return (it - 1)->Class;
+}
@@ -0,0 +1,122 @@
+/******************************************************************************/
+/*!
+\file   SmallObjectHeap.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the declaration for the Small Object Heap, a pool of
+  ObjectAllocators that serves blocks of mixed sizes by rounding every
+  request up to a size class.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef SMALLOBJECTHEAPH
+#define SMALLOBJECTHEAPH
+//---------------------------------------------------------------------------
+
+#include <vector>
+#include "ObjectAllocator.h"
+
+// The largest request served by the heap
+static const size_t MAX_SMALL_OBJECT_SIZE = 256;
+
+/*!
+  Statistics of one size class
+*/
+struct SizeClassStats : public OAStats
+{
+  /*!
+    Constructor
+  */
+  SizeClassStats() : OAStats(), ClassSize_(0), RequestedBytes_(0){};
+
+  size_t ClassSize_;      //!< largest request served by this class
+  size_t RequestedBytes_; //!< total bytes asked for by the client (ClassSize_ * Allocations_ at most)
+};
+
+/*!
+  A heap for small objects of mixed sizes.
+
+  Every request is rounded up to one of a fixed set of size classes, and
+  each size class is served by its own ObjectAllocator, created on first
+  use with the configuration given to the heap. The heap keeps one index
+  of the pages of every size class, sorted by address, so Free finds the
+  owning size class with a single binary search and the client does not
+  have to remember the size it asked for.
+*/
+class SmallObjectHeap
+{
+public:
+  // Creates an empty heap; every size class uses the given configuration
+  SmallObjectHeap(const OAConfig &config = OAConfig());
+
+  // Destroys the heap and every size class (never throws)
+  ~SmallObjectHeap();
+
+  // Takes a block of at least Size bytes from the matching size class
+  // Throws an exception if the block can't be allocated. (Memory allocation problem or Size too large)
+  void *Allocate(size_t Size, const char *label = 0);
+
+  // Returns a block to the size class that owns it
+  // Throws an exception if the block can't be freed. (Invalid object)
+  void Free(void *Object);
+
+  // Returns a block to the size class of Size, without looking for the owner
+  // Required when the configuration uses the C++ memory manager.
+  void Free(void *Object, size_t Size);
+
+  // Calls the callback fn for each block still in use, in every size class
+  unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+  // Calls the callback fn for each block that is potentially corrupted, in every size class
+  unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const;
+
+  // Frees all empty pages of every size class
+  unsigned FreeEmptyPages();
+
+  // Moves the blocks of the emptiest pages of every size class into the fullest ones
+  // Calls fn with the old and new address of each block moved; returns the number of pages freed.
+  unsigned Compact(ObjectAllocator::RELOCATECALLBACK fn, void *Context = 0);
+
+  // Releases every block of every size class at once, keeping the pages unless KeepPages is false
+  // Returns false when the configuration uses the C++ memory manager.
+  bool ResetAll(bool KeepPages = true);
+
+  // Testing/Debugging/Statistic methods
+  unsigned GetClassCount() const;                     // returns the number of size classes
+  SizeClassStats GetClassStats(unsigned Class) const; // returns the statistics for one size class
+  OAStats GetStats() const;                           // returns the statistics summed over every size class
+
+  // Prevent copy construction and assignment
+  SmallObjectHeap(const SmallObjectHeap &heap) = delete;            //!< Do not implement!
+  SmallObjectHeap &operator=(const SmallObjectHeap &heap) = delete; //!< Do not implement!
+
+private:
+  /*!
+    A page of one of the size classes
+  */
+  struct PageRange
+  {
+    const unsigned char *Start; //!< First byte of the page
+    const unsigned char *End;   //!< One past the last byte of the page
+    unsigned Class;             //!< Size class that owns the page
+  };
+
+  OAConfig Config_;                      //!< Configuration of every size class
+  std::vector<ObjectAllocator *> Pools_; //!< One allocator per size class (null until first used)
+  std::vector<const void *> PageHeads_;  //!< First page of each size class, as last seen by the heap
+  std::vector<size_t> RequestedBytes_;   //!< Bytes asked for per size class
+  std::vector<PageRange> PageIndex_;     //!< Every page of every size class, sorted by address
+  std::vector<unsigned char> ClassOf_;   //!< Size class of every request size, in steps of 8 bytes
+
+  unsigned SizeClass(size_t size) const;    //!< Returns the size class that serves a request
+  ObjectAllocator *GetPool(unsigned index); //!< Returns the allocator of a size class, creating it on first use
+  void AddPage(unsigned index);             //!< Adds the newest pages of a size class to the index
+  void RebuildPageIndex();                  //!< Indexes the pages of every size class again
+  unsigned FindClass(const void *object) const; //!< Returns the size class that owns a block
+};
+
+#endif
@@ -0,0 +1,723 @@
+/******************************************************************************/
+/*!
+\file   TlsfAllocator.cpp
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the implementation for the TLSF Allocator.
+*/
+/******************************************************************************/
+#include "TlsfAllocator.h"
+#include <algorithm> //<! std::max, std::upper_bound
+#include <cstring>   //<! std::memset
+#include <limits>    //<! std::numeric_limits
+
+namespace
+{
+  typedef unsigned char BYTE;
+
+  constexpr size_t FREE_BIT = 1; //!< Set in BlockHeader::Size while the block is free
+
+  //! Largest request; keeps every rounded block size inside the first-level lists
+  constexpr size_t MAX_REQUEST = std::numeric_limits<size_t>::max() >> 2;
+
+  //! A byte of the free pattern in every byte of a header means the block was merged away
+  constexpr size_t MERGED_SIZE = std::numeric_limits<size_t>::max() / 0xFF * ObjectAllocator::FREED_PATTERN;
+
+  /*!
+    Rounds a size up to a multiple of align (a power of two)
+  */
+  inline size_t RoundUp(size_t size, size_t align)
+  {
+    return (size + align - 1) & ~(align - 1);
+  }
+
+  /*!
+    Returns the index of the highest set bit of a value (not 0). Without the
+    builtins the loop is still bounded by the bits of a size_t.
+  */
+  inline unsigned HighBit(size_t value)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1)
+      ++bit;
+    return bit;
+#endif
+  }
+
+  /*!
+    Returns the index of the lowest set bit of a value (not 0)
+  */
+  inline unsigned LowBit(uint64_t value)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+    unsigned bit = 0;
+    while (!(value & 1))
+    {
+      value >>= 1;
+      ++bit;
+    }
+    return bit;
+#endif
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor of a TLSF Allocator. The first page is allocated
+  here, unless blocks come from new/delete.
+
+\par config The configuration of the allocator.
+\par PageSize The size of each page, in bytes.
+*/
+/******************************************************************************/
+TlsfAllocator::TlsfAllocator(const OAConfig &config, size_t PageSize)
+    : Config_{config}, Stats_{}, LeftSize_{RoundUp(config.PadBytes_, BLOCK_ALIGN)}, FlBitmap_{0},
+      SlBitmap_{}, FreeLists_{}, Pages_{}
+{
+  Stats_.PageSize_ = RoundUp(std::max(PageSize, 4 * BLOCK_ALIGN), BLOCK_ALIGN);
+
+  if (!Config_.UseCPPMemManager_)
+    AddPage(0);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor of a TLSF Allocator. Every page is freed, whether
+  or not its blocks were.
+*/
+/******************************************************************************/
+TlsfAllocator::~TlsfAllocator()
+{
+  for (const PageRange &page : Pages_)
+    delete[] page.Start;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function provides a block of at least \p Size bytes. A free list
+  whose blocks are all big enough is found from the bitmaps, and the first
+  block of it is split to size. A page is only added when no list has one.
+
+\par Size The number of bytes requested.
+\return A pointer to the block.
+*/
+/******************************************************************************/
+void *TlsfAllocator::Allocate(size_t Size)
+{
+  if (Config_.UseCPPMemManager_)
+  {
+    BYTE *object;
+    try
+    {
+      object = new BYTE[Size];
+    }
+    catch (std::bad_alloc &)
+    {
+      throw OAException(OAException::E_NO_MEMORY, "Allocate: No system memory available.");
+    }
+
+    ++Stats_.Allocations_;
+    Stats_.MostObjects_ = std::max(Stats_.MostObjects_, ++Stats_.ObjectsInUse_);
+    Stats_.RequestedBytes_ += Size;
+    return object;
+  }
+
+  if (Size > MAX_REQUEST)
+    throw OAException(OAException::E_NO_MEMORY, "Allocate: Size is larger than any block!");
+
+  size_t blockSize = RoundUp(std::max(LeftSize_ + Size + Config_.PadBytes_, sizeof(FreeLinks)), BLOCK_ALIGN);
+  BlockHeader *block = FindFree(blockSize);
+  if (!block)
+  {
+    block = AddPage(blockSize);
+    RemoveFree(block);
+  }
+  Split(block, blockSize);
+
+  ++Stats_.Allocations_;
+  Stats_.MostObjects_ = std::max(Stats_.MostObjects_, ++Stats_.ObjectsInUse_);
+  Stats_.BytesInUse_ += block->Size;
+  Stats_.MostBytes_ = std::max(Stats_.MostBytes_, Stats_.BytesInUse_);
+  Stats_.RequestedBytes_ += Size;
+
+  BYTE *data = reinterpret_cast<BYTE *>(block + 1);
+  BYTE *object = data + LeftSize_;
+
+  if (Config_.DebugOn_)
+  {
+    // left alignment, left pad, client bytes, rounding, right pad
+    std::memset(data, ObjectAllocator::ALIGN_PATTERN, LeftSize_ - Config_.PadBytes_);
+    std::memset(object - Config_.PadBytes_, ObjectAllocator::PAD_PATTERN, Config_.PadBytes_);
+    std::memset(object, ObjectAllocator::ALLOCATED_PATTERN, Size);
+    BYTE *rightPad = data + block->Size - Config_.PadBytes_;
+    std::memset(object + Size, ObjectAllocator::ALIGN_PATTERN, rightPad - (object + Size));
+    std::memset(rightPad, ObjectAllocator::PAD_PATTERN, Config_.PadBytes_);
+  }
+
+  return object;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns a block. It is merged with the free blocks before
+  and after it in its page, and the merged block goes on its free list.
+
+\par Object The objects address that needs to be freed.
+*/
+/******************************************************************************/
+void TlsfAllocator::Free(void *Object)
+{
+  if (Config_.UseCPPMemManager_)
+  {
+    delete[] static_cast<BYTE *>(Object);
+    ++Stats_.Deallocations_;
+    --Stats_.ObjectsInUse_;
+    return;
+  }
+
+  BlockHeader *block = CheckBlock(Object);
+
+  ++Stats_.Deallocations_;
+  --Stats_.ObjectsInUse_;
+  Stats_.BytesInUse_ -= block->Size;
+
+  if (Config_.DebugOn_)
+    std::memset(block + 1, ObjectAllocator::FREED_PATTERN, block->Size);
+
+  InsertFree(Merge(block));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the number of bytes the client may use in a block,
+  which is at least the size it was allocated with.
+
+\par Object The address of a block in use.
+\return The usable bytes of the block (0 when blocks come from new/delete).
+*/
+/******************************************************************************/
+size_t TlsfAllocator::GetUsableSize(const void *Object) const
+{
+  if (Config_.UseCPPMemManager_)
+    return 0;
+
+  const BYTE *data = static_cast<const BYTE *>(Object) - LeftSize_;
+  return UsableSize(reinterpret_cast<const BlockHeader *>(data) - 1);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on every block in use, page by page
+  in address order.
+
+\par fn The callback function.
+\return The number of blocks in use.
+*/
+/******************************************************************************/
+unsigned TlsfAllocator::DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const
+{
+  unsigned inUse = 0;
+
+  for (const PageRange &page : Pages_)
+  {
+    const BlockHeader *block = reinterpret_cast<const BlockHeader *>(page.Start);
+    for (; block->Size; block = NextPhys(block))
+    {
+      if (block->Size & FREE_BIT)
+        continue;
+
+      fn(reinterpret_cast<const BYTE *>(block + 1) + LeftSize_, UsableSize(block));
+      ++inUse;
+    }
+  }
+  return inUse;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function calls a callback \p fn on every block in use whose pads
+  have been overwritten.
+
+\par fn The callback function.
+\return The number of corrupted blocks.
+*/
+/******************************************************************************/
+unsigned TlsfAllocator::ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const
+{
+  if (!Config_.DebugOn_ || Config_.PadBytes_ == 0)
+    return 0;
+
+  unsigned numBlocksCorrupted = 0;
+
+  for (const PageRange &page : Pages_)
+  {
+    const BlockHeader *block = reinterpret_cast<const BlockHeader *>(page.Start);
+    for (; block->Size; block = NextPhys(block))
+    {
+      if (!(block->Size & FREE_BIT) && !PadsIntact(block))
+      {
+        fn(reinterpret_cast<const BYTE *>(block + 1) + LeftSize_, UsableSize(block));
+        ++numBlocksCorrupted;
+      }
+    }
+  }
+  return numBlocksCorrupted;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function frees every page that holds no block in use. Such a page
+  is one free block, since free blocks next to each other are merged.
+
+\return The number of pages freed.
+*/
+/******************************************************************************/
+unsigned TlsfAllocator::FreeEmptyPages()
+{
+  unsigned freed = 0;
+  size_t kept = 0;
+
+  for (const PageRange &page : Pages_)
+  {
+    BlockHeader *block = reinterpret_cast<BlockHeader *>(page.Start);
+    if ((block->Size & FREE_BIT) && NextPhys(block)->Size == 0)
+    {
+      RemoveFree(block);
+      delete[] page.Start;
+
+      --Stats_.PagesInUse_;
+      Stats_.ReservedBytes_ -= page.Size;
+      Stats_.ResidentBytes_ -= page.Size;
+      ++freed;
+    }
+    else
+      Pages_[kept++] = page;
+  }
+  Pages_.resize(kept);
+
+  return freed;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function sets the debug state of the allocator.
+
+\par State The new debug state.
+*/
+/******************************************************************************/
+void TlsfAllocator::SetDebugState(bool State)
+{
+  Config_.DebugOn_ = State;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the configuration of the allocator.
+
+\return The configuration of the allocator.
+*/
+/******************************************************************************/
+OAConfig TlsfAllocator::GetConfig() const
+{
+  return Config_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the statistics of the allocator.
+
+\return The statistics of the allocator.
+*/
+/******************************************************************************/
+TlsfStats TlsfAllocator::GetStats() const
+{
+  return Stats_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function adds a page, which starts as one free block and ends with
+  a header of size 0 that stops walks and merges. The page is PageSize
+  bytes, or larger if needed to hold a block of \p blockSize bytes.
+
+\par blockSize The smallest free block the page must hold.
+\return The free block of the new page.
+*/
+/******************************************************************************/
+TlsfAllocator::BlockHeader *TlsfAllocator::AddPage(size_t blockSize)
+{
+  if (Config_.MaxPages_ && Stats_.PagesInUse_ >= Config_.MaxPages_)
+    throw OAException(OAException::E_NO_PAGES, "AddPage: Maximum number of pages has been allocated!");
+
+  size_t pageSize = std::max(Stats_.PageSize_, blockSize + 2 * sizeof(BlockHeader));
+  BYTE *page;
+  try
+  {
+    Pages_.reserve(Pages_.size() + 1);
+    page = new BYTE[pageSize];
+  }
+  catch (std::bad_alloc &)
+  {
+    throw OAException(OAException::E_NO_MEMORY, "AddPage: No system memory available.");
+  }
+
+  PageRange range = {page, pageSize};
+  Pages_.insert(std::upper_bound(Pages_.begin(), Pages_.end(), range,
+                                 [](const PageRange &lhs, const PageRange &rhs) { return lhs.Start < rhs.Start; }),
+                range);
+
+  BlockHeader *block = reinterpret_cast<BlockHeader *>(page);
+  block->PrevPhys = nullptr;
+  block->Size = pageSize - 2 * sizeof(BlockHeader);
+
+  BlockHeader *end = NextPhys(block);
+  end->PrevPhys = block;
+  end->Size = 0;
+
+  if (Config_.DebugOn_)
+    std::memset(block + 1, ObjectAllocator::UNALLOCATED_PATTERN, block->Size);
+
+  ++Stats_.PagesInUse_;
+  Stats_.ReservedBytes_ += pageSize;
+  Stats_.ResidentBytes_ += pageSize;
+
+  InsertFree(block);
+  return block;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function puts a free block at the front of the list for its size.
+
+\par block The free block.
+*/
+/******************************************************************************/
+void TlsfAllocator::InsertFree(BlockHeader *block)
+{
+  unsigned fl, sl;
+  Mapping(block->Size, fl, sl);
+
+  FreeLinks *links = reinterpret_cast<FreeLinks *>(block + 1);
+  links->Next = FreeLists_[fl][sl];
+  links->Prev = nullptr;
+  if (links->Next)
+    reinterpret_cast<FreeLinks *>(links->Next + 1)->Prev = block;
+
+  FreeLists_[fl][sl] = block;
+  FlBitmap_ |= uint64_t(1) << fl;
+  SlBitmap_[fl] |= 1U << sl;
+
+  ++Stats_.FreeObjects_;
+  Stats_.FreeBytes_ += block->Size;
+  block->Size |= FREE_BIT;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes a free block off its list, clearing the bits of the
+  list once it is empty.
+
+\par block The free block.
+*/
+/******************************************************************************/
+void TlsfAllocator::RemoveFree(BlockHeader *block)
+{
+  block->Size &= ~FREE_BIT;
+
+  unsigned fl, sl;
+  Mapping(block->Size, fl, sl);
+
+  FreeLinks *links = reinterpret_cast<FreeLinks *>(block + 1);
+  if (links->Next)
+    reinterpret_cast<FreeLinks *>(links->Next + 1)->Prev = links->Prev;
+  if (links->Prev)
+    reinterpret_cast<FreeLinks *>(links->Prev + 1)->Next = links->Next;
+  else
+  {
+    FreeLists_[fl][sl] = links->Next;
+    if (!links->Next)
+    {
+      SlBitmap_[fl] &= ~(1U << sl);
+      if (!SlBitmap_[fl])
+        FlBitmap_ &= ~(uint64_t(1) << fl);
+    }
+  }
+
+  --Stats_.FreeObjects_;
+  Stats_.FreeBytes_ -= block->Size;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function takes a free block of at least \p blockSize bytes off its
+  list. The size is first rounded up to the next list, so that every block
+  of the list found is big enough: the list itself, or the first non-empty
+  list after it, comes from a bit scan of each bitmap.
+
+\par blockSize The bytes needed after the header.
+\return The block, or null when no list holds one.
+*/
+/******************************************************************************/
+TlsfAllocator::BlockHeader *TlsfAllocator::FindFree(size_t blockSize)
+{
+  if (blockSize >= (size_t(1) << FL_SHIFT))
+    blockSize += (size_t(1) << (HighBit(blockSize) - TLSF_SL_LOG)) - 1;
+
+  unsigned fl, sl;
+  Mapping(blockSize, fl, sl);
+
+  unsigned slMap = SlBitmap_[fl] & (~0U << sl);
+  if (!slMap)
+  {
+    uint64_t flMap = FlBitmap_ & (~uint64_t(0) << (fl + 1));
+    if (!flMap)
+      return nullptr;
+
+    fl = LowBit(flMap);
+    slMap = SlBitmap_[fl];
+  }
+  sl = LowBit(slMap);
+
+  BlockHeader *block = FreeLists_[fl][sl];
+  RemoveFree(block);
+  return block;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function gives the bytes of a block past \p blockSize to a new free
+  block, when there are enough of them for one.
+
+\par block The block, off its list.
+\par blockSize The bytes to keep in the block.
+*/
+/******************************************************************************/
+void TlsfAllocator::Split(BlockHeader *block, size_t blockSize)
+{
+  if (block->Size < blockSize + sizeof(BlockHeader) + sizeof(FreeLinks))
+    return;
+
+  BlockHeader *rest = reinterpret_cast<BlockHeader *>(reinterpret_cast<BYTE *>(block + 1) + blockSize);
+  rest->PrevPhys = block;
+  rest->Size = block->Size - blockSize - sizeof(BlockHeader);
+  NextPhys(rest)->PrevPhys = rest;
+  block->Size = blockSize;
+
+  // the block after the split was not free, so there is nothing to merge
+  InsertFree(rest);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function merges a block being freed with the free blocks before and
+  after it in its page. In debug the headers merged away are given the free
+  pattern, which is how a second Free of the block is caught.
+
+\par block The block, off any list.
+\return The merged block, off any list.
+*/
+/******************************************************************************/
+TlsfAllocator::BlockHeader *TlsfAllocator::Merge(BlockHeader *block)
+{
+  BlockHeader *next = NextPhys(block);
+  if (next->Size & FREE_BIT)
+  {
+    RemoveFree(next);
+    block->Size += sizeof(BlockHeader) + next->Size;
+    NextPhys(block)->PrevPhys = block;
+    if (Config_.DebugOn_)
+      std::memset(next, ObjectAllocator::FREED_PATTERN, sizeof(BlockHeader) + sizeof(FreeLinks));
+  }
+
+  BlockHeader *prev = block->PrevPhys;
+  if (prev && (prev->Size & FREE_BIT))
+  {
+    RemoveFree(prev);
+    prev->Size += sizeof(BlockHeader) + block->Size;
+    NextPhys(prev)->PrevPhys = prev;
+    if (Config_.DebugOn_)
+      std::memset(block, ObjectAllocator::FREED_PATTERN, sizeof(BlockHeader) + sizeof(FreeLinks));
+    block = prev;
+  }
+
+  return block;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the page that holds an address, by a binary search
+  of the pages.
+
+\par address The address.
+\return The page, or null when no page holds the address.
+*/
+/******************************************************************************/
+const TlsfAllocator::PageRange *TlsfAllocator::FindPage(const void *address) const
+{
+  const BYTE *byte = static_cast<const BYTE *>(address);
+  auto page = std::upper_bound(Pages_.begin(), Pages_.end(), byte,
+                               [](const BYTE *lhs, const PageRange &rhs) { return lhs < rhs.Start; });
+
+  if (page == Pages_.begin())
+    return nullptr;
+
+  --page;
+  return byte < page->Start + page->Size ? &*page : nullptr;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the header of a block being freed. In debug, the
+  address must be on a page, at the start of a block that the blocks next
+  to it link to, and the block must be in use with its pads intact.
+
+\par object The address given to Free.
+\return The header of the block.
+*/
+/******************************************************************************/
+TlsfAllocator::BlockHeader *TlsfAllocator::CheckBlock(void *object) const
+{
+  BYTE *data = static_cast<BYTE *>(object) - LeftSize_;
+  BlockHeader *block = reinterpret_cast<BlockHeader *>(data) - 1;
+
+  if (!Config_.DebugOn_)
+    return block;
+
+  const PageRange *page = FindPage(object);
+  if (!page)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not on any page!");
+
+  BYTE *start = page->Start;
+  BYTE *end = page->Start + page->Size - sizeof(BlockHeader);
+  if (data - start < static_cast<std::ptrdiff_t>(sizeof(BlockHeader)) || (data - start) % BLOCK_ALIGN)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not on a block boundary!");
+
+  if (block->Size == MERGED_SIZE)
+    throw OAException(OAException::E_MULTIPLE_FREE, "Free: Block has already been freed!");
+
+  // the header must fit the page and be the one its neighbours point at
+  BYTE *prev = reinterpret_cast<BYTE *>(block->PrevPhys);
+  bool linked = prev ? (prev >= start && prev < data && NextPhys(block->PrevPhys) == block)
+                     : reinterpret_cast<BYTE *>(block) == start;
+  linked = linked && (block->Size & ~FREE_BIT) <= static_cast<size_t>(end - data) &&
+           NextPhys(block)->PrevPhys == block;
+  if (!linked)
+    throw OAException(OAException::E_BAD_BOUNDARY, "Free: Address is not on a block boundary!");
+
+  if (block->Size & FREE_BIT)
+    throw OAException(OAException::E_MULTIPLE_FREE, "Free: Block has already been freed!");
+
+  if (!ObjectAllocator::MatchesPattern(data + LeftSize_ - Config_.PadBytes_, Config_.PadBytes_,
+                                       ObjectAllocator::PAD_PATTERN))
+    throw OAException(OAException::E_CORRUPTED_BLOCK, "Free: Corrupted left padding!");
+
+  if (!ObjectAllocator::MatchesPattern(data + block->Size - Config_.PadBytes_, Config_.PadBytes_,
+                                       ObjectAllocator::PAD_PATTERN))
+    throw OAException(OAException::E_CORRUPTED_BLOCK, "Free: Corrupted right padding!");
+
+  return block;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the bytes a block leaves the client, between the
+  pads.
+
+\par block A block in use.
+\return The usable bytes of the block.
+*/
+/******************************************************************************/
+size_t TlsfAllocator::UsableSize(const BlockHeader *block) const
+{
+  return (block->Size & ~FREE_BIT) - LeftSize_ - Config_.PadBytes_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function checks both pads of a block in use.
+
+\par block A block in use.
+\return Returns \p true if both pads are intact, else \p false.
+*/
+/******************************************************************************/
+bool TlsfAllocator::PadsIntact(const BlockHeader *block) const
+{
+  const BYTE *data = reinterpret_cast<const BYTE *>(block + 1);
+  return ObjectAllocator::MatchesPattern(data + LeftSize_ - Config_.PadBytes_, Config_.PadBytes_,
+                                         ObjectAllocator::PAD_PATTERN) &&
+         ObjectAllocator::MatchesPattern(data + block->Size - Config_.PadBytes_, Config_.PadBytes_,
+                                         ObjectAllocator::PAD_PATTERN);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the block after a block in its page.
+
+\par block A block (not the header that ends the page).
+\return The next block, or the header that ends the page.
+*/
+/******************************************************************************/
+TlsfAllocator::BlockHeader *TlsfAllocator::NextPhys(const BlockHeader *block)
+{
+  const BYTE *data = reinterpret_cast<const BYTE *>(block + 1);
+  return reinterpret_cast<BlockHeader *>(const_cast<BYTE *>(data) + (block->Size & ~FREE_BIT));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the list of blocks of a size. Below 2^FL_SHIFT
+  bytes, lists are BLOCK_ALIGN bytes apart on first level 0; above, the
+  first level is the power of two and the second level the next
+  TLSF_SL_LOG bits of the size.
+
+\par size The size of a block.
+\par fl The first level of the list.
+\par sl The second level of the list.
+*/
+/******************************************************************************/
+void TlsfAllocator::Mapping(size_t size, unsigned &fl, unsigned &sl)
+{
+  if (size < (size_t(1) << FL_SHIFT))
+  {
+    fl = 0;
+    sl = static_cast<unsigned>(size >> ALIGN_LOG);
+  }
+  else
+  {
+    unsigned high = HighBit(size);
+    sl = static_cast<unsigned>(size >> (high - TLSF_SL_LOG)) ^ SL_COUNT;
+    fl = high - FL_SHIFT + 1;
+  }
+}
@@ -0,0 +1,163 @@
+/******************************************************************************/
+/*!
+\file   TlsfAllocator.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 1
+\date   17 October 2026
+\brief
+  This file contains the declaration for the TLSF Allocator, a two-level
+  segregated-fit allocator for blocks of any size, with constant time
+  Allocate and Free.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef TLSFALLOCATORH
+#define TLSFALLOCATORH
+//---------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+#include "ObjectAllocator.h"
+
+// If the client doesn't specify it:
+static const size_t DEFAULT_TLSF_PAGE_SIZE = 1024 * 1024;
+
+// Second-level lists per power of two (as a power of two)
+static const unsigned TLSF_SL_LOG = 5;
+
+/*!
+  Statistics of a TLSF Allocator. The counts of OAStats are kept for blocks
+  of every size; ObjectSize_ is 0, since blocks have no one size.
+*/
+struct TlsfStats : public OAStats
+{
+  /*!
+    Constructor
+  */
+  TlsfStats() : OAStats(), BytesInUse_(0), MostBytes_(0), FreeBytes_(0), RequestedBytes_(0){};
+
+  size_t BytesInUse_;     //!< bytes of the blocks in use, pads and rounding included
+  size_t MostBytes_;      //!< most bytes in use at one time
+  size_t FreeBytes_;      //!< bytes of the free blocks
+  size_t RequestedBytes_; //!< total bytes asked for by the client
+};
+
+/*!
+  A two-level segregated-fit allocator for blocks of mixed sizes.
+
+  Free blocks are kept in lists by size: the first level splits sizes by
+  power of two, the second level splits each power of two into
+  2^TLSF_SL_LOG ranges. A bitmap per level tells which lists have blocks,
+  so Allocate finds a list whose every block is big enough with two bit
+  scans, and splits the block it takes. Free merges a block with the free
+  blocks next to it in memory, found through the block headers. Neither
+  walks a list, so both take constant time whatever the number of blocks.
+
+  Blocks are carved from pages of PageSize bytes (larger requests get a
+  page of their own). From the configuration, UseCPPMemManager_, MaxPages_,
+  DebugOn_ and PadBytes_ are used as by ObjectAllocator: with debugging
+  on, blocks are filled with the same signatures, the pads are checked on
+  Free and by ValidatePages, and bad or double frees throw. The right pad
+  ends the block, after any bytes added by rounding the block up.
+*/
+class TlsfAllocator
+{
+public:
+  // Creates the allocator and its first page
+  // Throws an exception if the construction fails. (Memory allocation problem)
+  TlsfAllocator(const OAConfig &config = OAConfig(false, DEFAULT_OBJECTS_PER_PAGE, 0),
+                size_t PageSize = DEFAULT_TLSF_PAGE_SIZE);
+
+  // Destroys the allocator and every page (never throws)
+  ~TlsfAllocator();
+
+  // Takes a block of at least Size bytes, in constant time unless a page is added
+  // Throws an exception if the block can't be allocated. (Memory allocation problem)
+  void *Allocate(size_t Size);
+
+  // Returns a block, merging it with the free blocks around it, in constant time
+  // Throws an exception if the block can't be freed. (Invalid object)
+  void Free(void *Object);
+
+  // Returns the number of bytes the client may use in a block (at least the Size asked for)
+  size_t GetUsableSize(const void *Object) const;
+
+  // Calls the callback fn for each block still in use
+  unsigned DumpMemoryInUse(ObjectAllocator::DUMPCALLBACK fn) const;
+
+  // Calls the callback fn for each block that is potentially corrupted
+  unsigned ValidatePages(ObjectAllocator::VALIDATECALLBACK fn) const;
+
+  // Frees every page that holds no block in use
+  unsigned FreeEmptyPages();
+
+  // Testing/Debugging/Statistic methods
+  void SetDebugState(bool State); // true=enable, false=disable
+  OAConfig GetConfig() const;     // returns the configuration parameters
+  TlsfStats GetStats() const;     // returns the statistics for the allocator
+
+  // Prevent copy construction and assignment
+  TlsfAllocator(const TlsfAllocator &tlsf) = delete;            //!< Do not implement!
+  TlsfAllocator &operator=(const TlsfAllocator &tlsf) = delete; //!< Do not implement!
+
+private:
+  /*!
+    Header in front of every block. Size is the size of the block after the
+    header, with the low bit set while the block is free. A free block
+    keeps its list links in its first bytes.
+  */
+  struct BlockHeader
+  {
+    BlockHeader *PrevPhys; //!< The block before this one in the page (null for the first)
+    size_t Size;           //!< Bytes after the header, and FREE_BIT
+  };
+
+  /*!
+    List links of a free block, right after its header
+  */
+  struct FreeLinks
+  {
+    BlockHeader *Next; //!< Next free block of the same list
+    BlockHeader *Prev; //!< Previous free block of the same list
+  };
+
+  /*!
+    A page the blocks are carved from
+  */
+  struct PageRange
+  {
+    unsigned char *Start; //!< First byte of the page
+    size_t Size;          //!< Bytes of the page
+  };
+
+  static const size_t BLOCK_ALIGN = 2 * sizeof(void *);               //!< Alignment and granularity of blocks
+  static const unsigned ALIGN_LOG = sizeof(void *) == 8 ? 4 : 3;      //!< log2 of BLOCK_ALIGN
+  static const unsigned FL_SHIFT = TLSF_SL_LOG + ALIGN_LOG;           //!< Sizes below 2^FL_SHIFT share first level 0
+  static const unsigned FL_COUNT = sizeof(size_t) * 8 - FL_SHIFT + 1; //!< First-level lists
+  static const unsigned SL_COUNT = 1U << TLSF_SL_LOG;                 //!< Second-level lists per first level
+
+  OAConfig Config_;                          //!< Configuration of the allocator
+  TlsfStats Stats_;                          //!< Statistics of the allocator
+  size_t LeftSize_;                          //!< Bytes from the start of a block to the client's bytes
+  uint64_t FlBitmap_;                        //!< Bit i is set while a list of first level i has blocks
+  unsigned SlBitmap_[FL_COUNT];              //!< Bit j of word i is set while list (i, j) has blocks
+  BlockHeader *FreeLists_[FL_COUNT][SL_COUNT]; //!< Free blocks, by size
+  std::vector<PageRange> Pages_;             //!< Every page, sorted by address
+
+  BlockHeader *AddPage(size_t blockSize);             //!< Adds a page with a free block of at least blockSize bytes
+  void InsertFree(BlockHeader *block);                //!< Puts a free block on its list
+  void RemoveFree(BlockHeader *block);                //!< Takes a free block off its list
+  BlockHeader *FindFree(size_t blockSize);            //!< Takes a free block of at least blockSize bytes (or null)
+  void Split(BlockHeader *block, size_t blockSize);   //!< Gives the bytes of a block past blockSize to a new free block
+  BlockHeader *Merge(BlockHeader *block);             //!< Merges a free block with the free blocks around it
+  const PageRange *FindPage(const void *address) const; //!< Returns the page that holds the address (or null)
+  BlockHeader *CheckBlock(void *object) const;        //!< Returns the header of a block being freed, checked in debug
+  size_t UsableSize(const BlockHeader *block) const;  //!< Returns the client's bytes of a block
+  bool PadsIntact(const BlockHeader *block) const;    //!< Checks the pads of a block in use
+  static BlockHeader *NextPhys(const BlockHeader *block); //!< Returns the block after this one in its page
+  static void Mapping(size_t size, unsigned &fl, unsigned &sl); //!< Returns the list of blocks of a size
+};
+
+#endif
@@ -0,0 +1,1804 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using std::cout;
+using std::endl;
+using std::printf;
+
+#include "ObjectAllocator.h"
+#include "ObjectAllocatorT.h"
+#include "OAStlAllocator.h"
+#include "ConcurrentObjectAllocator.h"
+#include "SmallObjectHeap.h"
+#include "TlsfAllocator.h"
+#include "PRNG.h"
+
+struct Student
+{
+    int Age;
+    float GPA;
+    long Year;
+    long ID;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Benchmarks
+void BenchDebugFree(unsigned pages);  // debug, header, 10k+ pages
+void BenchFreeEmptyPages(unsigned pages, bool perPageFreeLists);
+void BenchDumpMemoryInUse(unsigned pages, bool perPageFreeLists); // Stress configuration
+void BenchThreads(unsigned threads, bool magazines); // global mutex vs per-thread magazines
+void BenchProducerConsumer(unsigned objects, bool remoteFrees); // global mutex vs remote frees
+void BenchBatch(unsigned objects, unsigned batch, bool debug); // single calls vs AllocateBatch/FreeBatch
+void BenchMixedSizes(unsigned live, unsigned operations, bool heap); // new/delete vs SmallObjectHeap
+void BenchHeaders(unsigned objects, OAConfig::HBLOCK_TYPE type, const char* label); // basic vs external headers
+void BenchPageGrowth(unsigned objectsPerPage, unsigned objects, bool lazy); // eager vs lazy carving
+void BenchReleasePages(unsigned pages, bool mapped, bool huge); // new[]/delete[] vs mapped pages
+void BenchChurn(unsigned peak, unsigned rounds, bool fullestFirst); // LIFO vs fullest-page-first
+void BenchTemplate(unsigned objects, bool debug); // runtime vs compile-time configuration
+template <typename Container>
+void BenchContainer(const char* name, unsigned elements); // std::allocator vs OAStlAllocator
+void BenchProfiling(unsigned objects, bool profiling, unsigned sampleRate); // profiling off vs on
+void BenchValidatePages(unsigned pages, unsigned padBytes, unsigned step); // whole sweep vs bounded steps
+void BenchResetAll(unsigned objects, bool debug, bool reset); // one Free per object vs ResetAll
+void BenchGuardSampling(unsigned rounds, unsigned sampleRate); // no guards vs sampled guard pages
+void BenchRampUp(unsigned objectsPerPage, unsigned objects, unsigned growthFactor); // fixed vs geometric page growth
+void BenchTryAllocate(unsigned objects, bool tryApi, bool debug); // Allocate/Free vs TryAllocate/TryFree
+void BenchReserve(unsigned objects, bool lazy, bool reserve); // growing on demand vs Reserve ahead of a burst
+void BenchRefill(unsigned bursts, unsigned burst, bool refill); // growing inline vs background refill
+void BenchCompact(unsigned objects, unsigned keepOneIn, bool compact); // FreeEmptyPages vs Compact after churn
+void BenchHandles(unsigned nodes, bool handles); // pointer vs 32-bit handle links in a BST
+void BenchTlsf(unsigned live, unsigned operations, bool tlsf); // new/delete vs TlsfAllocator, mixed sizes
+
+//****************************************************************************************************
+//****************************************************************************************************
+int RandomInt(int low, int high)
+{
+    return Digipen::Utils::Random(low, high);
+}
+
+template <typename T>
+void Shuffle(T* array, unsigned count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        int r = RandomInt(i, static_cast<int>(count) - 1);
+        T temp = array[i];
+        array[i] = array[r];
+        array[r] = temp;
+    }
+}
+
+double ElapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void BenchDebugFree(unsigned pages)
+{
+    const unsigned objects = 16;
+    const unsigned total = objects * pages;
+
+    std::vector<void*> ptrs(total);
+
+    try
+    {
+        bool newdel = false;
+        bool debug = true;
+        unsigned padbytes = 4;
+        OAConfig::HeaderBlockInfo header(OAConfig::hbBasic);
+        unsigned alignment = 0;
+
+        OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        for (unsigned i = 0; i < total; i++)
+            ptrs[i] = oa->Allocate();
+
+        Shuffle(&ptrs[0], total);
+
+        Clock::time_point start = Clock::now();
+        for (unsigned i = 0; i < total; i++)
+            oa->Free(ptrs[i]);
+        double ms = ElapsedMs(start);
+
+        printf("Pages: %6u, Frees: %8u, Time: %9.2f ms, %7.1f ns/free\n",
+               pages, total, ms, ms * 1e6 / total);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchFreeEmptyPages(unsigned pages, bool perPageFreeLists)
+{
+    const unsigned objects = 64;
+    const unsigned total = objects * pages;
+
+    std::vector<void*> ptrs(total);
+
+    try
+    {
+        OAConfig config(false, objects, pages);
+        config.PerPageFreeLists_ = perPageFreeLists;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        for (unsigned i = 0; i < total; i++)
+            ptrs[i] = oa->Allocate();
+
+        // keep one object alive on every other page, free the rest
+        std::vector<void*> keep;
+        std::vector<void*> release;
+        for (unsigned i = 0; i < total; i++)
+        {
+            if ((i / objects) % 2 == 0 && i % objects == 0)
+                keep.push_back(ptrs[i]);
+            else
+                release.push_back(ptrs[i]);
+        }
+        Shuffle(&release[0], static_cast<unsigned>(release.size()));
+        for (unsigned i = 0; i < release.size(); i++)
+            oa->Free(release[i]);
+
+        Clock::time_point start = Clock::now();
+        unsigned freed = oa->FreeEmptyPages();
+        double ms = ElapsedMs(start);
+
+        printf("%-8s Pages: %6u, Free objects: %8u, Pages freed: %6u, Time: %9.2f ms\n",
+               perPageFreeLists ? "per-page" : "global", pages,
+               static_cast<unsigned>(release.size()), freed, ms);
+
+        for (unsigned i = 0; i < keep.size(); i++)
+            oa->Free(keep[i]);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void DumpCallback(const void*, size_t)
+{
+}
+
+void BenchDumpMemoryInUse(unsigned pages, bool perPageFreeLists)
+{
+    const unsigned objects = 4096;
+    const unsigned total = objects * pages;
+
+    std::vector<void*> ptrs(total);
+
+    try
+    {
+        // same configuration as Stress(false) in driver-sample.cpp
+        bool newdel = false;
+        bool debug = false;
+        unsigned padbytes = 0;
+        OAConfig::HeaderBlockInfo header(OAConfig::hbNone);
+        unsigned alignment = 0;
+
+        OAConfig config(newdel, objects, pages, debug, padbytes, header, alignment);
+        config.PerPageFreeLists_ = perPageFreeLists;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        for (unsigned i = 0; i < total; i++)
+            ptrs[i] = oa->Allocate();
+
+        Shuffle(&ptrs[0], total);
+        for (unsigned i = 0; i < total / 2; i++)
+            oa->Free(ptrs[i]);
+
+        Clock::time_point start = Clock::now();
+        unsigned leaks = oa->DumpMemoryInUse(DumpCallback);
+        double ms = ElapsedMs(start);
+
+        printf("%-8s Pages: %4u, Blocks: %7u, In use: %7u, Time: %9.2f ms\n",
+               perPageFreeLists ? "per-page" : "global", pages, total, leaks, ms);
+
+        for (unsigned i = total / 2; i < total; i++)
+            oa->Free(ptrs[i]);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+/*!
+  The usual way of sharing an ObjectAllocator between threads
+*/
+class LockedObjectAllocator
+{
+public:
+    LockedObjectAllocator(size_t ObjectSize, const OAConfig& config) : oa(ObjectSize, config)
+    {
+    }
+    void* Allocate()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return oa.Allocate();
+    }
+    void Free(void* Object)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        oa.Free(Object);
+    }
+    OAStats GetStats() const
+    {
+        return oa.GetStats();
+    }
+
+private:
+    ObjectAllocator oa;
+    std::mutex lock;
+};
+
+template <typename Allocator>
+void AllocateFreeLoop(Allocator* oa, unsigned rounds)
+{
+    const unsigned batch = 32;
+    void* ptrs[batch];
+
+    for (unsigned r = 0; r < rounds; r++)
+    {
+        for (unsigned i = 0; i < batch; i++)
+            ptrs[i] = oa->Allocate();
+        for (unsigned i = 0; i < batch; i++)
+            oa->Free(ptrs[batch - i - 1]);
+    }
+}
+
+template <typename Allocator>
+double RunThreads(Allocator* oa, unsigned threads, unsigned rounds)
+{
+    std::vector<std::thread> workers;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned t = 0; t < threads; t++)
+        workers.push_back(std::thread(AllocateFreeLoop<Allocator>, oa, rounds));
+    for (unsigned t = 0; t < threads; t++)
+        workers[t].join();
+
+    return ElapsedMs(start);
+}
+
+void BenchThreads(unsigned threads, bool magazines)
+{
+    const unsigned rounds = 20000; // 32 allocations + 32 frees each
+    const unsigned objects = 1024;
+
+    try
+    {
+        OAConfig config(false, objects, 1000);
+        double ms;
+        OAStats stats;
+
+        if (magazines)
+        {
+            ConcurrentObjectAllocator oa(sizeof(Student), config);
+            ms = RunThreads(&oa, threads, rounds);
+            stats = oa.GetStats();
+        }
+        else
+        {
+            LockedObjectAllocator oa(sizeof(Student), config);
+            ms = RunThreads(&oa, threads, rounds);
+            stats = oa.GetStats();
+        }
+
+        double ops = 2.0 * 32 * rounds * threads;
+        printf("%-9s Threads: %2u, Allocs: %9u, Frees: %9u, Time: %9.2f ms, %8.2f Mops/s\n",
+               magazines ? "magazine" : "mutex", threads, stats.Allocations_, stats.Deallocations_,
+               ms, ops / ms / 1000.0);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+/*!
+  Single producer, single consumer ring of pointers
+*/
+class PointerQueue
+{
+public:
+    PointerQueue() : head(0), tail(0)
+    {
+    }
+    void Push(void* ptr)
+    {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        while (t - head.load(std::memory_order_acquire) == size)
+            std::this_thread::yield();
+        slots[t % size] = ptr;
+        tail.store(t + 1, std::memory_order_release);
+    }
+    void* Pop()
+    {
+        unsigned h = head.load(std::memory_order_relaxed);
+        while (tail.load(std::memory_order_acquire) == h)
+            std::this_thread::yield();
+        void* ptr = slots[h % size];
+        head.store(h + 1, std::memory_order_release);
+        return ptr;
+    }
+
+private:
+    static const unsigned size = 4096;
+    void* slots[size];
+    std::atomic<unsigned> head;
+    std::atomic<unsigned> tail;
+};
+
+template <typename Allocator>
+void Produce(Allocator* oa, PointerQueue* queue, unsigned objects)
+{
+    for (unsigned i = 0; i < objects; i++)
+        queue->Push(oa->Allocate());
+}
+
+template <typename Allocator>
+void Consume(Allocator* oa, PointerQueue* queue, unsigned objects)
+{
+    for (unsigned i = 0; i < objects; i++)
+        oa->Free(queue->Pop());
+}
+
+template <typename Allocator>
+double RunProducerConsumer(Allocator* oa, unsigned objects)
+{
+    PointerQueue* queue = new PointerQueue;
+
+    Clock::time_point start = Clock::now();
+    std::thread consumer(Consume<Allocator>, oa, queue, objects);
+    Produce(oa, queue, objects);
+    consumer.join();
+    double ms = ElapsedMs(start);
+
+    delete queue;
+    return ms;
+}
+
+void BenchProducerConsumer(unsigned objects, bool remoteFrees)
+{
+    try
+    {
+        // the ring holds 4096 pointers, so 8 pages of 1024 are always enough
+        OAConfig config(false, 1024, 8);
+        double ms;
+        OAStats stats;
+
+        if (remoteFrees)
+        {
+            config.RemoteFrees_ = true;
+            ObjectAllocator oa(sizeof(Student), config);
+            ms = RunProducerConsumer(&oa, objects);
+            oa.FreeEmptyPages(); // collects the last remote frees
+            stats = oa.GetStats();
+        }
+        else
+        {
+            LockedObjectAllocator oa(sizeof(Student), config);
+            ms = RunProducerConsumer(&oa, objects);
+            stats = oa.GetStats();
+        }
+
+        printf("%-7s Objects: %9u, Allocs: %9u, Frees: %9u, Time: %9.2f ms, %8.2f Mops/s\n",
+               remoteFrees ? "remote" : "mutex", objects, stats.Allocations_, stats.Deallocations_,
+               ms, 2.0 * objects / ms / 1000.0);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchBatch(unsigned objects, unsigned batch, bool debug)
+{
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        OAConfig::HeaderBlockInfo header(debug ? OAConfig::hbBasic : OAConfig::hbNone);
+        OAConfig config(false, 1024, 0, debug, debug ? 4 : 0, header);
+        config.MaxPages_ = objects / 1024 + 1;
+
+        double allocMs[2];
+        double freeMs[2];
+        for (int batched = 0; batched < 2; batched++)
+        {
+            ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+            // the first pass grows the pages, the best of the rest is kept
+            allocMs[batched] = freeMs[batched] = 1e9;
+            for (int pass = 0; pass < 6; pass++)
+            {
+                Clock::time_point start = Clock::now();
+                if (batched)
+                {
+                    for (unsigned i = 0; i < objects; i += batch)
+                        oa->AllocateBatch(batch, &ptrs[i]);
+                }
+                else
+                {
+                    for (unsigned i = 0; i < objects; i++)
+                        ptrs[i] = oa->Allocate();
+                }
+                double ms = ElapsedMs(start);
+                if (pass && ms < allocMs[batched])
+                    allocMs[batched] = ms;
+
+                start = Clock::now();
+                if (batched)
+                {
+                    for (unsigned i = 0; i < objects; i += batch)
+                        oa->FreeBatch(&ptrs[i], batch);
+                }
+                else
+                {
+                    for (unsigned i = 0; i < objects; i++)
+                        oa->Free(ptrs[i]);
+                }
+                ms = ElapsedMs(start);
+                if (pass && ms < freeMs[batched])
+                    freeMs[batched] = ms;
+            }
+
+            delete oa;
+        }
+
+        printf("%-7s Objects: %8u, Batch: %4u, Allocate: %6.2f -> %6.2f ns/object, Free: %6.2f -> %6.2f ns/object\n",
+               debug ? "debug" : "release", objects, batch,
+               allocMs[0] * 1e6 / objects, allocMs[1] * 1e6 / objects,
+               freeMs[0] * 1e6 / objects, freeMs[1] * 1e6 / objects);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+// Mostly small requests, like tree, list and hash table nodes and short labels
+size_t RandomSize()
+{
+    if (RandomInt(0, 3))
+        return static_cast<size_t>(RandomInt(8, 64));
+    return static_cast<size_t>(RandomInt(65, 256));
+}
+
+void BenchMixedSizes(unsigned live, unsigned operations, bool heap)
+{
+    std::vector<void*> ptrs(live);
+    std::vector<size_t> sizes(operations + live);
+    std::vector<unsigned> victims(operations);
+
+    for (unsigned i = 0; i < sizes.size(); i++)
+        sizes[i] = RandomSize();
+    for (unsigned i = 0; i < operations; i++)
+        victims[i] = static_cast<unsigned>(RandomInt(0, static_cast<int>(live) - 1));
+
+    try
+    {
+        OAConfig config(false, 256, 0);
+        SmallObjectHeap* soh = heap ? new SmallObjectHeap(config) : 0;
+
+        Clock::time_point start = Clock::now();
+        for (unsigned i = 0; i < live; i++)
+            ptrs[i] = heap ? soh->Allocate(sizes[i]) : new char[sizes[i]];
+
+        // replace a random live block on every step
+        for (unsigned i = 0; i < operations; i++)
+        {
+            unsigned victim = victims[i];
+            if (heap)
+            {
+                soh->Free(ptrs[victim]);
+                ptrs[victim] = soh->Allocate(sizes[live + i]);
+            }
+            else
+            {
+                delete[] static_cast<char*>(ptrs[victim]);
+                ptrs[victim] = new char[sizes[live + i]];
+            }
+        }
+
+        for (unsigned i = 0; i < live; i++)
+        {
+            if (heap)
+                soh->Free(ptrs[i]);
+            else
+                delete[] static_cast<char*>(ptrs[i]);
+        }
+        double ms = ElapsedMs(start);
+
+        printf("%-10s Live: %7u, Operations: %8u, Time: %8.2f ms, %6.1f ns/op",
+               heap ? "heap" : "new/delete", live, operations, ms, ms * 1e6 / (operations + live));
+        if (heap)
+        {
+            OAStats stats = soh->GetStats();
+            printf(", Pages: %u, Most objects: %u", stats.PagesInUse_, stats.MostObjects_);
+        }
+        printf("\n");
+
+        delete soh;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchHeaders(unsigned objects, OAConfig::HBLOCK_TYPE type, const char* label)
+{
+    static const char* names[] = {"none", "basic", "extended", "external"};
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        OAConfig config(false, 1024, 0, false, 0, OAConfig::HeaderBlockInfo(type));
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // the first pass grows the pages, the best of the rest is kept
+        double best = 1e9;
+        for (int pass = 0; pass < 6; pass++)
+        {
+            Clock::time_point start = Clock::now();
+            for (unsigned i = 0; i < objects; i++)
+                ptrs[i] = oa->Allocate(label);
+            for (unsigned i = 0; i < objects; i++)
+                oa->Free(ptrs[i]);
+            double ms = ElapsedMs(start);
+            if (pass && ms < best)
+                best = ms;
+        }
+
+        printf("%-8s %-9s Objects: %8u, Time: %8.2f ms, %6.1f ns/allocate+free\n", names[type],
+               label ? "labelled" : "no label", objects, best, best * 1e6 / objects);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchPageGrowth(unsigned objectsPerPage, unsigned objects, bool lazy)
+{
+    try
+    {
+        OAConfig config(false, objectsPerPage, 0, true, 2, OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+        config.LazyCarving_ = lazy;
+
+        // a fresh allocator for every round; its first page is grown by the constructor
+        double first = 0, total = 0;
+        const int rounds = 20;
+        for (int round = 0; round < rounds; round++)
+        {
+            Clock::time_point start = Clock::now();
+            ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+            oa->Allocate();
+            first += ElapsedMs(start);
+            for (unsigned i = 1; i < objects; i++)
+                oa->Allocate();
+            total += ElapsedMs(start);
+            delete oa;
+        }
+
+        printf("%-5s Objects per page: %6u, Objects: %6u, First: %8.1f us, All: %8.1f us\n",
+               lazy ? "lazy" : "eager", objectsPerPage, objects, first * 1e3 / rounds, total * 1e3 / rounds);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+// Resident set size of the process in KB (0 where /proc is not available)
+size_t ResidentKB()
+{
+    size_t size = 0, resident = 0;
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    if (std::fscanf(statm, "%zu %zu", &size, &resident) != 2)
+        resident = 0;
+    std::fclose(statm);
+    return resident * 4;
+}
+
+void BenchReleasePages(unsigned pages, bool mapped, bool huge)
+{
+    try
+    {
+        OAConfig config(false, 256, 0, false, 0, OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+        config.MappedPages_ = mapped;
+        config.HugePages_ = huge;
+
+        std::vector<void*> ptrs(pages * config.ObjectsPerPage_, nullptr);
+        size_t before = ResidentKB();
+        Clock::time_point start = Clock::now();
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+        for (size_t i = 0; i < ptrs.size(); i++)
+            ptrs[i] = oa->Allocate();
+        double grow = ElapsedMs(start);
+        size_t full = ResidentKB();
+        OAStats stats = oa->GetStats();
+        size_t reserved = stats.ReservedBytes_ / 1024;
+
+        for (size_t i = 0; i < ptrs.size(); i++)
+            oa->Free(ptrs[i]);
+        start = Clock::now();
+        oa->FreeEmptyPages();
+        double release = ElapsedMs(start);
+        size_t empty = ResidentKB();
+        stats = oa->GetStats();
+
+        printf("%-8s Pages: %6u, Grow: %7.2f ms, Release: %6.2f ms, Reserved: %7zu KB, RSS: +%7zu KB full, "
+               "+%7zu KB after release (%zu KB resident by stats)\n",
+               mapped ? (huge ? "huge" : "mapped") : "new[]", pages, grow, release, reserved, full - before,
+               empty > before ? empty - before : 0, stats.ResidentBytes_ / 1024);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchChurn(unsigned peak, unsigned rounds, bool fullestFirst)
+{
+    try
+    {
+        OAConfig config(false, 256, 0, false, 0, OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+        config.MappedPages_ = true;
+        config.FullestPageFirst_ = fullestFirst;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        std::vector<void*> live;
+        live.reserve(peak);
+        size_t before = ResidentKB();
+        Clock::time_point start = Clock::now();
+
+        // every round grows the live set to its peak, shrinks it to a tenth
+        // with random frees, then replaces random blocks for a while
+        printf("%-8s", fullestFirst ? "fullest" : "LIFO");
+        for (unsigned round = 0; round < rounds; round++)
+        {
+            while (live.size() < peak)
+                live.push_back(oa->Allocate());
+
+            while (live.size() > peak / 10)
+            {
+                unsigned victim = static_cast<unsigned>(RandomInt(0, static_cast<int>(live.size()) - 1));
+                oa->Free(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+
+            for (unsigned i = 0; i < peak; i++)
+            {
+                unsigned victim = static_cast<unsigned>(RandomInt(0, static_cast<int>(live.size()) - 1));
+                oa->Free(live[victim]);
+                live[victim] = oa->Allocate();
+            }
+
+            oa->FreeEmptyPages();
+            size_t rss = ResidentKB();
+            printf(" %5u/%6zuK", oa->GetStats().PagesInUse_, rss > before ? rss - before : 0);
+        }
+        double ms = ElapsedMs(start);
+
+        // the fewest pages that could hold the live blocks
+        printf("  (pages/RSS after each round, %zu pages needed), Time: %8.2f ms\n",
+               (live.size() + config.ObjectsPerPage_ - 1) / config.ObjectsPerPage_, ms);
+
+        for (void* object : live)
+            oa->Free(object);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+// Allocates and frees every block of ptrs a few times, returns the best ns per allocate+free
+template <typename Allocator>
+double AllocateFreePasses(Allocator* oa, std::vector<void*>& ptrs)
+{
+    // the first pass grows the pages, the best of the rest is kept
+    double best = 1e9;
+    for (int pass = 0; pass < 6; pass++)
+    {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < ptrs.size(); i++)
+            ptrs[i] = oa->Allocate();
+        for (size_t i = 0; i < ptrs.size(); i++)
+            oa->Free(ptrs[i]);
+        double ms = ElapsedMs(start);
+        if (pass && ms < best)
+            best = ms;
+    }
+    return best * 1e6 / ptrs.size();
+}
+
+void BenchTemplate(unsigned objects, bool debug)
+{
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        typedef OAPolicy<1024, 0> Release;
+        typedef OAPolicy<1024, 0, true, 8, OAConfig::hbBasic> Debug;
+
+        OAConfig config(false, 1024, 0, debug, debug ? 8 : 0,
+                        OAConfig::HeaderBlockInfo(debug ? OAConfig::hbBasic : OAConfig::hbNone));
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+        double runtime = AllocateFreePasses(oa, ptrs);
+        delete oa;
+
+        double compiled;
+        if (debug)
+        {
+            ObjectAllocatorT<sizeof(Student), Debug>* oat = new ObjectAllocatorT<sizeof(Student), Debug>;
+            compiled = AllocateFreePasses(oat, ptrs);
+            delete oat;
+        }
+        else
+        {
+            ObjectAllocatorT<sizeof(Student), Release>* oat = new ObjectAllocatorT<sizeof(Student), Release>;
+            compiled = AllocateFreePasses(oat, ptrs);
+            delete oat;
+        }
+
+        printf("%-8s Objects: %8u, ObjectAllocator: %6.2f ns, ObjectAllocatorT: %6.2f ns (allocate+free)\n",
+               debug ? "debug" : "release", objects, runtime, compiled);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+// Inserts a key in any of the node containers
+template <typename T, typename A>
+void InsertKey(std::list<T, A>& container, int key)
+{
+    container.push_back(key);
+}
+template <typename T, typename C, typename A>
+void InsertKey(std::set<T, C, A>& container, int key)
+{
+    container.insert(key);
+}
+template <typename K, typename V, typename C, typename A>
+void InsertKey(std::map<K, V, C, A>& container, int key)
+{
+    container.emplace(key, key);
+}
+template <typename K, typename V, typename H, typename E, typename A>
+void InsertKey(std::unordered_map<K, V, H, E, A>& container, int key)
+{
+    container.emplace(key, key);
+}
+
+// Bytes taken from the heap (the resident set size where glibc can't tell)
+size_t HeapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return ResidentKB() * 1024;
+#endif
+}
+
+template <typename Container>
+void BenchContainer(const char* name, unsigned elements)
+{
+    std::vector<int> keys(elements);
+    for (unsigned i = 0; i < elements; i++)
+        keys[i] = static_cast<int>(i);
+    Shuffle(keys.data(), elements);
+
+    size_t before = HeapBytes();
+    Clock::time_point start = Clock::now();
+    {
+        Container container;
+        for (unsigned i = 0; i < elements; i++)
+            InsertKey(container, keys[i]);
+        double insert = ElapsedMs(start);
+        size_t full = HeapBytes();
+
+        // erase from the middle, then drop the rest with the container
+        start = Clock::now();
+        auto it = container.begin();
+        for (unsigned i = 0; i < elements / 2; i++)
+            it = container.erase(it);
+        double erase = ElapsedMs(start);
+
+        printf("%-32s Elements: %8u, Insert: %6.1f ns, Erase: %6.1f ns, Memory: %5.1f bytes/element\n", name,
+               elements, insert * 1e6 / elements, erase * 1e6 / (elements / 2),
+               full > before ? static_cast<double>(full - before) / elements : 0.0);
+    }
+}
+
+// Smallest bucket of a latency histogram with at least half of the samples in it or below
+unsigned MedianBucket(const uint64_t* histogram)
+{
+    uint64_t samples = 0;
+    for (unsigned i = 0; i < OA_LATENCY_BUCKETS; i++)
+        samples += histogram[i];
+
+    uint64_t below = 0;
+    for (unsigned i = 0; i < OA_LATENCY_BUCKETS; i++)
+    {
+        below += histogram[i];
+        if (below * 2 >= samples)
+            return i;
+    }
+    return 0;
+}
+
+void BenchProfiling(unsigned objects, bool profiling, unsigned sampleRate)
+{
+    static const char* labels[] = {"Student", "Course", "Enrolment", "Grade"};
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        OAConfig config(false, 1024, 0);
+        config.Profiling_ = profiling;
+        config.ProfileSampleRate_ = sampleRate;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // the first pass grows the pages, the best of the rest is kept
+        double best = 1e9;
+        for (int pass = 0; pass < 6; pass++)
+        {
+            Clock::time_point start = Clock::now();
+            for (unsigned i = 0; i < objects; i++)
+                ptrs[i] = oa->Allocate(labels[(i >> 10) & 3]);
+            for (unsigned i = 0; i < objects; i++)
+                oa->Free(ptrs[i]);
+            double ms = ElapsedMs(start);
+            if (pass && ms < best)
+                best = ms;
+        }
+
+        printf("%-9s 1/%-5u Objects: %8u, Time: %8.2f ms, %6.1f ns/allocate+free", profiling ? "profiled" : "off",
+               sampleRate, objects, best, best * 1e6 / objects);
+
+        if (profiling)
+        {
+            OAProfile profile = oa->GetProfile();
+            unsigned median = MedianBucket(profile.AllocateLatency_);
+            if (sampleRate)
+                printf(", median allocate: %u-%u ns", median ? 1u << median : 0, 2u << median);
+            printf(", %zu labels, %llu pages", profile.Labels_.size(),
+                   static_cast<unsigned long long>(profile.PagesAllocated_));
+        }
+        printf("\n");
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void ValidateCallback(const void*, size_t)
+{
+}
+
+void BenchValidatePages(unsigned pages, unsigned padBytes, unsigned step)
+{
+    try
+    {
+        OAConfig config(false, 1024, 0, true, padBytes, OAConfig::HeaderBlockInfo(OAConfig::hbBasic));
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+        unsigned blocks = pages * config.ObjectsPerPage_;
+        std::vector<void*> ptrs(blocks);
+        for (unsigned i = 0; i < blocks; i++)
+            ptrs[i] = oa->Allocate();
+
+        double ms;
+        unsigned calls = 0;
+        Clock::time_point start = Clock::now();
+        if (step)
+        {
+            // one whole sweep of the pool in bounded steps
+            for (unsigned checked = 0; checked < blocks; checked += step, calls++)
+                oa->ValidatePagesIncremental(ValidateCallback, step);
+            ms = ElapsedMs(start);
+            printf("Pad: %3u, Blocks: %8u, %6u blocks/call: %8.2f us/call, %5.2f ns/block\n", padBytes, blocks, step,
+                   ms * 1e3 / calls, ms * 1e6 / blocks);
+        }
+        else
+        {
+            oa->ValidatePages(ValidateCallback);
+            ms = ElapsedMs(start);
+            printf("Pad: %3u, Blocks: %8u, whole pool:        %8.2f ms/call, %5.2f ns/block\n", padBytes, blocks, ms,
+                   ms * 1e6 / blocks);
+        }
+
+        for (unsigned i = 0; i < blocks; i++)
+            oa->Free(ptrs[i]);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchResetAll(unsigned objects, bool debug, bool reset)
+{
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        OAConfig config(false, 1024, 0, debug, debug ? 8 : 0,
+                        OAConfig::HeaderBlockInfo(debug ? OAConfig::hbBasic : OAConfig::hbNone));
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // the first phase grows the pages, the best teardown of the rest is kept
+        double best = 1e9, fill = 1e9;
+        for (int pass = 0; pass < 6; pass++)
+        {
+            Clock::time_point start = Clock::now();
+            for (unsigned i = 0; i < objects; i++)
+                ptrs[i] = oa->Allocate();
+            double ms = ElapsedMs(start);
+            if (pass && ms < fill)
+                fill = ms;
+
+            start = Clock::now();
+            if (reset)
+                oa->ResetAll();
+            else
+            {
+                for (unsigned i = 0; i < objects; i++)
+                    oa->Free(ptrs[i]);
+            }
+            ms = ElapsedMs(start);
+            if (pass && ms < best)
+                best = ms;
+        }
+
+        printf("%-8s %-8s Objects: %8u, Teardown: %8.3f ms, Next fill: %6.2f ms\n", debug ? "debug" : "release",
+               reset ? "ResetAll" : "Free", objects, best, fill);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchGuardSampling(unsigned rounds, unsigned sampleRate)
+{
+    const unsigned live = 64;
+    void* ptrs[live];
+
+    try
+    {
+        OAConfig config(false, 1024, 0);
+        config.GuardSampleRate_ = sampleRate;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // short-lived objects, so guarded slots are freed and reused all the time
+        double best = 1e9;
+        for (int pass = 0; pass < 6; pass++)
+        {
+            Clock::time_point start = Clock::now();
+            for (unsigned round = 0; round < rounds; round++)
+            {
+                for (unsigned i = 0; i < live; i++)
+                    ptrs[i] = oa->Allocate();
+                for (unsigned i = 0; i < live; i++)
+                    oa->Free(ptrs[i]);
+            }
+            double ms = ElapsedMs(start);
+            if (pass && ms < best)
+                best = ms;
+        }
+
+        unsigned objects = rounds * live;
+        printf("Guards: 1/%-5u Objects: %8u, Time: %8.2f ms, %6.1f ns/allocate+free\n", sampleRate, objects, best,
+               best * 1e6 / objects);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchRampUp(unsigned objectsPerPage, unsigned objects, unsigned growthFactor)
+{
+    try
+    {
+        OAConfig config(false, objectsPerPage, 0);
+        config.GrowthFactor_ = growthFactor;
+        config.MaxObjectsPerPage_ = 65536;
+
+        // a fresh allocator for every round, ramped up from one page
+        double total = 0;
+        unsigned pages = 0;
+        const int rounds = 10;
+        for (int round = 0; round < rounds; round++)
+        {
+            Clock::time_point start = Clock::now();
+            ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+            for (unsigned i = 0; i < objects; i++)
+                oa->Allocate();
+            total += ElapsedMs(start);
+            pages = oa->GetStats().PagesInUse_;
+            delete oa;
+        }
+
+        printf("Growth: x%u Objects per page: %4u, Objects: %8u, Pages: %7u, Time: %8.2f ms\n", growthFactor,
+               objectsPerPage, objects, pages, total / rounds);
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchTryAllocate(unsigned objects, bool tryApi, bool debug)
+{
+    std::vector<void*> ptrs(objects);
+
+    try
+    {
+        OAConfig config(false, 1024, 0, debug, debug ? 8 : 0);
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // the first pass grows the pages, the best of the rest is kept
+        double alloc = 1e9, free = 1e9;
+        for (int pass = 0; pass < 6; pass++)
+        {
+            Clock::time_point start = Clock::now();
+            if (tryApi)
+            {
+                for (unsigned i = 0; i < objects; i++)
+                    ptrs[i] = oa->TryAllocate();
+            }
+            else
+            {
+                for (unsigned i = 0; i < objects; i++)
+                    ptrs[i] = oa->Allocate();
+            }
+            double ms = ElapsedMs(start);
+            if (pass && ms < alloc)
+                alloc = ms;
+
+            start = Clock::now();
+            if (tryApi)
+            {
+                for (unsigned i = 0; i < objects; i++)
+                    oa->TryFree(ptrs[i]);
+            }
+            else
+            {
+                for (unsigned i = 0; i < objects; i++)
+                    oa->Free(ptrs[i]);
+            }
+            ms = ElapsedMs(start);
+            if (pass && ms < free)
+                free = ms;
+        }
+
+        printf("%-7s %-21s Objects: %8u, %5.2f ns/allocate, %5.2f ns/free\n", debug ? "debug" : "release",
+               tryApi ? "TryAllocate/TryFree" : "Allocate/Free", objects, alloc * 1e6 / objects, free * 1e6 / objects);
+
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchReserve(unsigned objects, bool lazy, bool reserve)
+{
+    std::vector<void*> ptrs(objects);
+    std::vector<double> latencies(objects);
+
+    try
+    {
+        OAConfig config(false, 1024, 0);
+        config.LazyCarving_ = lazy;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        Clock::time_point start = Clock::now();
+        if (reserve)
+            oa->Reserve(objects);
+        double reserveMs = ElapsedMs(start);
+
+        // the burst: every allocation is timed on its own
+        Clock::time_point burst = Clock::now();
+        for (unsigned i = 0; i < objects; i++)
+        {
+            Clock::time_point before = Clock::now();
+            ptrs[i] = oa->Allocate();
+            latencies[i] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+        }
+        double burstMs = ElapsedMs(burst);
+
+        std::sort(latencies.begin(), latencies.end());
+        OAStats stats = oa->GetStats();
+        printf("%-5s %-9s Objects: %8u, Reserve: %7.2f ms, Burst: %7.2f ms, p99.9: %6.0f ns, max: %7.0f ns, "
+               "Capacity: %u\n", lazy ? "lazy" : "eager", reserve ? "Reserve" : "on demand", objects, reserveMs,
+               burstMs, latencies[objects - objects / 1000], latencies[objects - 1], stats.Capacity_);
+
+        for (unsigned i = 0; i < objects; i++)
+            oa->Free(ptrs[i]);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchRefill(unsigned bursts, unsigned burst, bool refill)
+{
+    std::vector<void*> ptrs;
+    std::vector<double> latencies;
+    ptrs.reserve(bursts * burst);
+    latencies.reserve(bursts * burst);
+
+    try
+    {
+        OAConfig config(false, 1024, 0);
+        config.BackgroundRefill_ = refill;
+        config.RefillWatermark_ = 2 * burst;
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // the load only grows, with a short pause between bursts
+        for (unsigned b = 0; b < bursts; b++)
+        {
+            for (unsigned i = 0; i < burst; i++)
+            {
+                Clock::time_point before = Clock::now();
+                ptrs.push_back(oa->Allocate());
+                latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        size_t count = latencies.size();
+        printf("%-10s Bursts: %4u x %5u, p50: %4.0f ns, p99.9: %6.0f ns, p99.99: %7.0f ns, max: %8.0f ns, Pages: %u\n",
+               refill ? "background" : "inline", bursts, burst, latencies[count / 2], latencies[count - count / 1000],
+               latencies[count - count / 10000], latencies[count - 1], oa->GetStats().PagesInUse_);
+
+        for (void* p : ptrs)
+            oa->Free(p);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+void BenchCompact(unsigned objects, unsigned keepOneIn, bool compact)
+{
+    try
+    {
+        OAConfig config(false, 256, 0);
+        ObjectAllocator* oa = new ObjectAllocator(sizeof(Student), config);
+
+        // fill the pool, then keep one object in keepOneIn, at random
+        std::vector<void*> live(objects);
+        for (unsigned i = 0; i < objects; i++)
+            live[i] = oa->Allocate();
+
+        size_t kept = 0;
+        for (unsigned i = 0; i < objects; i++)
+        {
+            if (RandomInt(1, static_cast<int>(keepOneIn)) == 1)
+                live[kept++] = live[i];
+            else
+                oa->Free(live[i]);
+        }
+        live.resize(kept);
+
+        unsigned pages = oa->GetStats().PagesInUse_;
+        size_t moved = 0;
+        Clock::time_point start = Clock::now();
+        if (compact)
+        {
+            // the client patches its pointers with the moves recorded
+            OARelocationMap relocations;
+            oa->Compact(ObjectAllocator::RecordRelocation, &relocations);
+            for (void*& object : live)
+            {
+                OARelocationMap::const_iterator it = relocations.find(object);
+                if (it != relocations.end())
+                    object = it->second;
+            }
+            moved = relocations.size();
+        }
+        else
+            oa->FreeEmptyPages();
+        double ms = ElapsedMs(start);
+
+        printf("%-14s Objects: %8u, Live: %7zu, Pages: %5u -> %5u, Moved: %7zu, Time: %7.2f ms\n",
+               compact ? "Compact" : "FreeEmptyPages", objects, live.size(), pages, oa->GetStats().PagesInUse_,
+               moved, ms);
+
+        for (void* object : live)
+            oa->Free(object);
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+//! A BST node linked by pointers
+struct PointerNode
+{
+    PointerNode* Left;
+    PointerNode* Right;
+    int Key;
+};
+
+//! A BST node linked by allocator handles
+struct HandleNode
+{
+    OAHandle Left;
+    OAHandle Right;
+    int Key;
+};
+
+void BenchHandles(unsigned nodes, bool handles)
+{
+    try
+    {
+        std::vector<int> keys(nodes);
+        for (unsigned i = 0; i < nodes; i++)
+            keys[i] = static_cast<int>(i);
+        Shuffle(keys.data(), nodes);
+
+        OAConfig config(false, 1024, 0);
+        config.Handles_ = handles;
+        size_t nodeSize = handles ? sizeof(HandleNode) : sizeof(PointerNode);
+        ObjectAllocator* oa = new ObjectAllocator(nodeSize, config);
+
+        // insert the keys in random order, then look each one up in another order
+        PointerNode* pointerRoot = 0;
+        OAHandle handleRoot = 0;
+        Clock::time_point start = Clock::now();
+        for (int key : keys)
+        {
+            if (handles)
+            {
+                OAHandle* link = &handleRoot;
+                while (*link)
+                {
+                    HandleNode* node = static_cast<HandleNode*>(oa->ToPointer(*link));
+                    link = key < node->Key ? &node->Left : &node->Right;
+                }
+                OAHandle handle = oa->AllocateHandle();
+                HandleNode* node = static_cast<HandleNode*>(oa->ToPointer(handle));
+                node->Left = node->Right = 0;
+                node->Key = key;
+                *link = handle;
+            }
+            else
+            {
+                PointerNode** link = &pointerRoot;
+                while (*link)
+                    link = key < (*link)->Key ? &(*link)->Left : &(*link)->Right;
+                PointerNode* node = static_cast<PointerNode*>(oa->Allocate());
+                node->Left = node->Right = 0;
+                node->Key = key;
+                *link = node;
+            }
+        }
+        double buildMs = ElapsedMs(start);
+
+        Shuffle(keys.data(), nodes);
+        unsigned found = 0;
+        start = Clock::now();
+        for (int key : keys)
+        {
+            if (handles)
+            {
+                OAHandle link = handleRoot;
+                while (link)
+                {
+                    const HandleNode* node = static_cast<const HandleNode*>(oa->ToPointer(link));
+                    if (node->Key == key)
+                    {
+                        ++found;
+                        break;
+                    }
+                    link = key < node->Key ? node->Left : node->Right;
+                }
+            }
+            else
+            {
+                const PointerNode* node = pointerRoot;
+                while (node && node->Key != key)
+                    node = key < node->Key ? node->Left : node->Right;
+                found += node != 0;
+            }
+        }
+        double findMs = ElapsedMs(start);
+
+        OAStats stats = oa->GetStats();
+        printf("%-8s Nodes: %8u, Node: %2zu bytes, Pages: %5u (%6.1f MB), Build: %7.2f ms, Lookups: %7.2f ms%s\n",
+               handles ? "handles" : "pointers", nodes, nodeSize, stats.PagesInUse_,
+               stats.PagesInUse_ * stats.PageSize_ / (1024.0 * 1024.0), buildMs, findMs,
+               found == nodes ? "" : " (keys missing!)");
+        delete oa;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+// Labels, keys and small vectors: mostly short, a few up to 4 KB
+size_t RandomVariableSize()
+{
+    if (RandomInt(0, 7))
+        return static_cast<size_t>(RandomInt(1, 128));
+    return static_cast<size_t>(RandomInt(129, 4096));
+}
+
+void BenchTlsf(unsigned live, unsigned operations, bool tlsf)
+{
+    std::vector<void*> ptrs(live);
+    std::vector<size_t> sizes(operations + live);
+    std::vector<unsigned> victims(operations);
+    std::vector<double> latencies;
+    latencies.reserve(operations);
+
+    for (unsigned i = 0; i < sizes.size(); i++)
+        sizes[i] = RandomVariableSize();
+    for (unsigned i = 0; i < operations; i++)
+        victims[i] = static_cast<unsigned>(RandomInt(0, static_cast<int>(live) - 1));
+
+    try
+    {
+        TlsfAllocator* heap = tlsf ? new TlsfAllocator() : 0;
+
+        Clock::time_point start = Clock::now();
+        for (unsigned i = 0; i < live; i++)
+            ptrs[i] = tlsf ? heap->Allocate(sizes[i]) : new char[sizes[i]];
+
+        // replace a random live block on every step, timing each Free + Allocate pair
+        for (unsigned i = 0; i < operations; i++)
+        {
+            unsigned victim = victims[i];
+            Clock::time_point before = Clock::now();
+            if (tlsf)
+            {
+                heap->Free(ptrs[victim]);
+                ptrs[victim] = heap->Allocate(sizes[live + i]);
+            }
+            else
+            {
+                delete[] static_cast<char*>(ptrs[victim]);
+                ptrs[victim] = new char[sizes[live + i]];
+            }
+            latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+        }
+
+        for (unsigned i = 0; i < live; i++)
+        {
+            if (tlsf)
+                heap->Free(ptrs[i]);
+            else
+                delete[] static_cast<char*>(ptrs[i]);
+        }
+        double ms = ElapsedMs(start);
+
+        std::sort(latencies.begin(), latencies.end());
+        size_t count = latencies.size();
+        printf("%-10s Live: %7u, Operations: %8u, Time: %8.2f ms, p50: %4.0f ns, p99.9: %5.0f ns, max: %7.0f ns",
+               tlsf ? "tlsf" : "new/delete", live, operations, ms, latencies[count / 2],
+               latencies[count - count / 1000], latencies[count - 1]);
+        if (tlsf)
+        {
+            TlsfStats stats = heap->GetStats();
+            printf(", Pages: %u, Most: %5.1f MB", stats.PagesInUse_, stats.MostBytes_ / (1024.0 * 1024.0));
+        }
+        printf("\n");
+
+        delete heap;
+    }
+    catch (const OAException& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int test = 0;
+    if (argc > 1)
+        test = std::atoi(argv[1]);
+
+    switch (test)
+    {
+    case 1:
+        cout << "============================== Debug free with many pages..." << endl;
+        BenchDebugFree(1000);
+        BenchDebugFree(10000);
+        BenchDebugFree(20000);
+        cout << endl;
+        break;
+    case 2:
+        cout << "============================== Free empty pages..." << endl;
+        BenchFreeEmptyPages(1000, false);
+        BenchFreeEmptyPages(1000, true);
+        BenchFreeEmptyPages(10000, false);
+        BenchFreeEmptyPages(10000, true);
+        cout << endl;
+        break;
+    case 3:
+        cout << "============================== Dump memory in use (Stress configuration)..." << endl;
+        BenchDumpMemoryInUse(10, false);
+        BenchDumpMemoryInUse(10, true);
+        BenchDumpMemoryInUse(100, false);
+        BenchDumpMemoryInUse(100, true);
+        cout << endl;
+        break;
+    case 4:
+        cout << "============================== Threads: global mutex vs magazines..." << endl;
+        for (unsigned threads = 1; threads <= 32; threads *= 2)
+        {
+            BenchThreads(threads, false);
+            BenchThreads(threads, true);
+        }
+        cout << endl;
+        break;
+    case 5:
+        cout << "============================== Producer/consumer: global mutex vs remote frees..." << endl;
+        BenchProducerConsumer(1000000, false);
+        BenchProducerConsumer(1000000, true);
+        BenchProducerConsumer(10000000, false);
+        BenchProducerConsumer(10000000, true);
+        cout << endl;
+        break;
+    case 6:
+        cout << "============================== Single calls vs batches..." << endl;
+        BenchBatch(1 << 20, 16, false);
+        BenchBatch(1 << 20, 64, false);
+        BenchBatch(1 << 20, 1024, false);
+        BenchBatch(1 << 20, 64, true);
+        cout << endl;
+        break;
+    case 7:
+        cout << "============================== Mixed sizes: new/delete vs small object heap..." << endl;
+        BenchMixedSizes(10000, 2000000, false);
+        BenchMixedSizes(10000, 2000000, true);
+        BenchMixedSizes(1000000, 2000000, false);
+        BenchMixedSizes(1000000, 2000000, true);
+        cout << endl;
+        break;
+    case 8:
+        cout << "============================== Header blocks: basic vs external..." << endl;
+        BenchHeaders(1 << 20, OAConfig::hbBasic, 0);
+        BenchHeaders(1 << 20, OAConfig::hbExternal, 0);
+        BenchHeaders(1 << 20, OAConfig::hbExternal, "Student");
+        BenchHeaders(1 << 20, OAConfig::hbExternal, "A label longer than the small string buffer");
+        cout << endl;
+        break;
+    case 9:
+        cout << "============================== Page growth: eager vs lazy carving..." << endl;
+        BenchPageGrowth(1024, 100, false);
+        BenchPageGrowth(1024, 100, true);
+        BenchPageGrowth(65536, 100, false);
+        BenchPageGrowth(65536, 100, true);
+        BenchPageGrowth(65536, 65536, false);
+        BenchPageGrowth(65536, 65536, true);
+        cout << endl;
+        break;
+    case 10:
+        cout << "============================== Releasing pages: new[] vs mapped pages..." << endl;
+        BenchReleasePages(10000, false, false);
+        BenchReleasePages(10000, true, false);
+        BenchReleasePages(10000, true, true);
+        cout << endl;
+        break;
+    case 11:
+        cout << "============================== Churn: LIFO vs fullest page first..." << endl;
+        BenchChurn(200000, 8, false);
+        BenchChurn(200000, 8, true);
+        cout << endl;
+        break;
+    case 12:
+        cout << "============================== Runtime vs compile-time configuration..." << endl;
+        BenchTemplate(1 << 20, false);
+        BenchTemplate(1 << 20, true);
+        cout << endl;
+        break;
+    case 13:
+        cout << "============================== Node containers: std::allocator vs OAStlAllocator..." << endl;
+        BenchContainer<std::list<int>>("list<int>", 1000000);
+        BenchContainer<std::list<int, OAStlAllocator<int>>>("list<int> OAStlAllocator", 1000000);
+        BenchContainer<std::set<int>>("set<int>", 1000000);
+        BenchContainer<std::set<int, std::less<int>, OAStlAllocator<int>>>("set<int> OAStlAllocator", 1000000);
+        BenchContainer<std::map<int, int>>("map<int, int>", 1000000);
+        BenchContainer<std::map<int, int, std::less<int>, OAStlAllocator<std::pair<const int, int>>>>(
+            "map<int, int> OAStlAllocator", 1000000);
+        BenchContainer<std::unordered_map<int, int>>("unordered_map<int, int>", 1000000);
+        BenchContainer<std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                          OAStlAllocator<std::pair<const int, int>>>>(
+            "unordered_map<int, int> OAStl...", 1000000);
+        cout << endl;
+        break;
+    case 14:
+        cout << "============================== Allocation profiling: off vs on..." << endl;
+        BenchProfiling(1 << 20, false, 0);
+        BenchProfiling(1 << 20, true, 0);
+        BenchProfiling(1 << 20, true, 64);
+        BenchProfiling(1 << 20, true, 1);
+        cout << endl;
+        break;
+    case 15:
+        cout << "============================== Validating pages: whole sweep vs bounded steps..." << endl;
+        BenchValidatePages(2000, 8, 0);
+        BenchValidatePages(2000, 32, 0);
+        BenchValidatePages(2000, 64, 0);
+        BenchValidatePages(2000, 8, 4096);
+        BenchValidatePages(2000, 64, 4096);
+        cout << endl;
+        break;
+    case 16:
+        cout << "============================== Teardown: one Free per object vs ResetAll..." << endl;
+        BenchResetAll(1 << 20, false, false);
+        BenchResetAll(1 << 20, false, true);
+        BenchResetAll(1 << 20, true, false);
+        BenchResetAll(1 << 20, true, true);
+        cout << endl;
+        break;
+    case 17:
+        cout << "============================== Guard sampling: none vs one in 1000, 100 and 10..." << endl;
+        BenchGuardSampling(1 << 14, 0);
+        BenchGuardSampling(1 << 14, 1000);
+        BenchGuardSampling(1 << 14, 100);
+        BenchGuardSampling(1 << 14, 10);
+        cout << endl;
+        break;
+    case 18:
+        cout << "============================== Ramp-up: fixed vs geometric page growth..." << endl;
+        BenchRampUp(16, 1 << 22, 1);
+        BenchRampUp(16, 1 << 22, 2);
+        BenchRampUp(16, 1 << 22, 4);
+        cout << endl;
+        break;
+    case 19:
+        cout << "============================== Fast path: Allocate/Free vs TryAllocate/TryFree..." << endl;
+        BenchTryAllocate(1 << 20, false, false);
+        BenchTryAllocate(1 << 20, true, false);
+        BenchTryAllocate(1 << 20, false, true);
+        BenchTryAllocate(1 << 20, true, true);
+        cout << endl;
+        break;
+    case 20:
+        cout << "============================== Burst: growing on demand vs Reserve ahead of time..." << endl;
+        BenchReserve(1 << 20, false, false);
+        BenchReserve(1 << 20, false, true);
+        BenchReserve(1 << 20, true, false);
+        BenchReserve(1 << 20, true, true);
+        cout << endl;
+        break;
+    case 21:
+        cout << "============================== Bursts: growing inline vs background refill..." << endl;
+        BenchRefill(500, 4096, false);
+        BenchRefill(500, 4096, true);
+        cout << endl;
+        break;
+    case 22:
+        cout << "============================== Fragmented pool: FreeEmptyPages vs Compact..." << endl;
+        BenchCompact(1 << 20, 10, false);
+        BenchCompact(1 << 20, 10, true);
+        BenchCompact(1 << 20, 100, false);
+        BenchCompact(1 << 20, 100, true);
+        cout << endl;
+        break;
+    case 23:
+        cout << "============================== BST links: pointers vs 32-bit handles..." << endl;
+        BenchHandles(1 << 20, false);
+        BenchHandles(1 << 20, true);
+        BenchHandles(1 << 22, false);
+        BenchHandles(1 << 22, true);
+        cout << endl;
+        break;
+    case 24:
+        cout << "============================== Variable sizes: new/delete vs TLSF..." << endl;
+        BenchTlsf(1 << 14, 1 << 22, false);
+        BenchTlsf(1 << 14, 1 << 22, true);
+        BenchTlsf(1 << 18, 1 << 22, false);
+        BenchTlsf(1 << 18, 1 << 22, true);
+        cout << endl;
+        break;
+    default:
+        cout << "============================== Debug free with many pages..." << endl;
+        BenchDebugFree(1000);
+        BenchDebugFree(10000);
+        BenchDebugFree(20000);
+        cout << endl;
+        cout << "============================== Free empty pages..." << endl;
+        BenchFreeEmptyPages(1000, false);
+        BenchFreeEmptyPages(1000, true);
+        BenchFreeEmptyPages(10000, false);
+        BenchFreeEmptyPages(10000, true);
+        cout << endl;
+        cout << "============================== Dump memory in use (Stress configuration)..." << endl;
+        BenchDumpMemoryInUse(10, false);
+        BenchDumpMemoryInUse(10, true);
+        BenchDumpMemoryInUse(100, false);
+        BenchDumpMemoryInUse(100, true);
+        cout << endl;
+        cout << "============================== Threads: global mutex vs magazines..." << endl;
+        for (unsigned threads = 1; threads <= 32; threads *= 2)
+        {
+            BenchThreads(threads, false);
+            BenchThreads(threads, true);
+        }
+        cout << endl;
+        cout << "============================== Producer/consumer: global mutex vs remote frees..." << endl;
+        BenchProducerConsumer(1000000, false);
+        BenchProducerConsumer(1000000, true);
+        BenchProducerConsumer(10000000, false);
+        BenchProducerConsumer(10000000, true);
+        cout << endl;
+        cout << "============================== Single calls vs batches..." << endl;
+        BenchBatch(1 << 20, 16, false);
+        BenchBatch(1 << 20, 64, false);
+        BenchBatch(1 << 20, 1024, false);
+        BenchBatch(1 << 20, 64, true);
+        cout << endl;
+        cout << "============================== Mixed sizes: new/delete vs small object heap..." << endl;
+        BenchMixedSizes(10000, 2000000, false);
+        BenchMixedSizes(10000, 2000000, true);
+        BenchMixedSizes(1000000, 2000000, false);
+        BenchMixedSizes(1000000, 2000000, true);
+        cout << endl;
+        cout << "============================== Header blocks: basic vs external..." << endl;
+        BenchHeaders(1 << 20, OAConfig::hbBasic, 0);
+        BenchHeaders(1 << 20, OAConfig::hbExternal, 0);
+        BenchHeaders(1 << 20, OAConfig::hbExternal, "Student");
+        BenchHeaders(1 << 20, OAConfig::hbExternal, "A label longer than the small string buffer");
+        cout << endl;
+        cout << "============================== Page growth: eager vs lazy carving..." << endl;
+        BenchPageGrowth(1024, 100, false);
+        BenchPageGrowth(1024, 100, true);
+        BenchPageGrowth(65536, 100, false);
+        BenchPageGrowth(65536, 100, true);
+        BenchPageGrowth(65536, 65536, false);
+        BenchPageGrowth(65536, 65536, true);
+        cout << endl;
+        cout << "============================== Releasing pages: new[] vs mapped pages..." << endl;
+        BenchReleasePages(10000, false, false);
+        BenchReleasePages(10000, true, false);
+        BenchReleasePages(10000, true, true);
+        cout << endl;
+        cout << "============================== Churn: LIFO vs fullest page first..." << endl;
+        BenchChurn(200000, 8, false);
+        BenchChurn(200000, 8, true);
+        cout << endl;
+        cout << "============================== Runtime vs compile-time configuration..." << endl;
+        BenchTemplate(1 << 20, false);
+        BenchTemplate(1 << 20, true);
+        cout << endl;
+        cout << "============================== Node containers: std::allocator vs OAStlAllocator..." << endl;
+        BenchContainer<std::list<int>>("list<int>", 1000000);
+        BenchContainer<std::list<int, OAStlAllocator<int>>>("list<int> OAStlAllocator", 1000000);
+        BenchContainer<std::set<int>>("set<int>", 1000000);
+        BenchContainer<std::set<int, std::less<int>, OAStlAllocator<int>>>("set<int> OAStlAllocator", 1000000);
+        BenchContainer<std::map<int, int>>("map<int, int>", 1000000);
+        BenchContainer<std::map<int, int, std::less<int>, OAStlAllocator<std::pair<const int, int>>>>(
+            "map<int, int> OAStlAllocator", 1000000);
+        BenchContainer<std::unordered_map<int, int>>("unordered_map<int, int>", 1000000);
+        BenchContainer<std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                          OAStlAllocator<std::pair<const int, int>>>>(
+            "unordered_map<int, int> OAStl...", 1000000);
+        cout << endl;
+        cout << "============================== Allocation profiling: off vs on..." << endl;
+        BenchProfiling(1 << 20, false, 0);
+        BenchProfiling(1 << 20, true, 0);
+        BenchProfiling(1 << 20, true, 64);
+        BenchProfiling(1 << 20, true, 1);
+        cout << endl;
+        cout << "============================== Validating pages: whole sweep vs bounded steps..." << endl;
+        BenchValidatePages(2000, 8, 0);
+        BenchValidatePages(2000, 32, 0);
+        BenchValidatePages(2000, 64, 0);
+        BenchValidatePages(2000, 8, 4096);
+        BenchValidatePages(2000, 64, 4096);
+        cout << endl;
+        cout << "============================== Teardown: one Free per object vs ResetAll..." << endl;
+        BenchResetAll(1 << 20, false, false);
+        BenchResetAll(1 << 20, false, true);
+        BenchResetAll(1 << 20, true, false);
+        BenchResetAll(1 << 20, true, true);
+        cout << endl;
+        cout << "============================== Guard sampling: none vs one in 1000, 100 and 10..." << endl;
+        BenchGuardSampling(1 << 14, 0);
+        BenchGuardSampling(1 << 14, 1000);
+        BenchGuardSampling(1 << 14, 100);
+        BenchGuardSampling(1 << 14, 10);
+        cout << endl;
+        cout << "============================== Ramp-up: fixed vs geometric page growth..." << endl;
+        BenchRampUp(16, 1 << 22, 1);
+        BenchRampUp(16, 1 << 22, 2);
+        BenchRampUp(16, 1 << 22, 4);
+        cout << endl;
+        cout << "============================== Fast path: Allocate/Free vs TryAllocate/TryFree..." << endl;
+        BenchTryAllocate(1 << 20, false, false);
+        BenchTryAllocate(1 << 20, true, false);
+        BenchTryAllocate(1 << 20, false, true);
+        BenchTryAllocate(1 << 20, true, true);
+        cout << endl;
+        cout << "============================== Burst: growing on demand vs Reserve ahead of time..." << endl;
+        BenchReserve(1 << 20, false, false);
+        BenchReserve(1 << 20, false, true);
+        BenchReserve(1 << 20, true, false);
+        BenchReserve(1 << 20, true, true);
+        cout << endl;
+        cout << "============================== Bursts: growing inline vs background refill..." << endl;
+        BenchRefill(500, 4096, false);
+        BenchRefill(500, 4096, true);
+        cout << endl;
+        cout << "============================== Fragmented pool: FreeEmptyPages vs Compact..." << endl;
+        BenchCompact(1 << 20, 10, false);
+        BenchCompact(1 << 20, 10, true);
+        BenchCompact(1 << 20, 100, false);
+        BenchCompact(1 << 20, 100, true);
+        cout << endl;
+        cout << "============================== BST links: pointers vs 32-bit handles..." << endl;
+        BenchHandles(1 << 20, false);
+        BenchHandles(1 << 20, true);
+        BenchHandles(1 << 22, false);
+        BenchHandles(1 << 22, true);
+        cout << endl;
+        cout << "============================== Variable sizes: new/delete vs TLSF..." << endl;
+        BenchTlsf(1 << 14, 1 << 22, false);
+        BenchTlsf(1 << 14, 1 << 22, true);
+        BenchTlsf(1 << 18, 1 << 22, false);
+        BenchTlsf(1 << 18, 1 << 22, true);
+        cout << endl;
+        break;
+    }
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <thread>
 
 using std::cout;
 using std::endl;
@@ -13,6 +14,10 @@ int SHOWREAL = 0;
 int SHOW_EXCEPTIONS = 0;
 
 #include "ObjectAllocator.h"
+#include "ObjectAllocatorT.h"
+#include "ConcurrentObjectAllocator.h"
+#include "SmallObjectHeap.h"
+#include "TlsfAllocator.h"
 #include "PRNG.h"
 
 struct Student
@@ -57,6 +62,14 @@ void TestFreeEmptyPages2(void);       // debug, padding=2, header, align=16
 void TestFreeEmptyPages3(void);       // debug, padding=6
 void StressFreeChecking(void);        //
 void Stress(bool UseNewDelete);       // 
+void TestHeapRefill(void);            // small object heap, background refill
+void TestCompact(void);               // debug, padding=2, extended header
+void TestTlsf(void);                  // TLSF allocator, debug, padding=4
+void TestThreadChurn(void);           // concurrent allocator, short-lived threads
+void TestTemplatePolicies(void);      // allocator template, debug, padding=8, header
+void TestRemoteFrees(void);           // debug, padding=2, remote frees
+void TestGuardSampling(void);         // guard sampling, 2 slots
+void TestBatches(void);               // debug, padding=2, batches
 
 struct Person
 {
@@ -1715,6 +1728,709 @@ void TestAlignment(void)
         delete oa;
 }
 
+//****************************************************************************************************
+//****************************************************************************************************
+// Pools with background refill adopt several pages in one Allocate; the
+// heap must find the size class of blocks on every one of them.
+//
+// Expected output:
+//   Allocated: 2000, Freed: 2000, Exceptions: 0
+//   Objects in use: 0, Allocs: 2000, Frees: 2000
+void TestHeapRefill(void)
+{
+    const int total = 2000;
+    void* ptrs[total];
+    try
+    {
+        OAConfig config(false, 4, 0);
+        config.BackgroundRefill_ = true;
+        config.RefillWatermark_ = 16;
+        SmallObjectHeap heap(config);
+
+        for (int i = 0; i < total; i++)
+            ptrs[i] = heap.Allocate(8 + (i % 4) * 8);
+
+        int freed = 0;
+        int exceptions = 0;
+        for (int i = 0; i < total; i++)
+        {
+            try
+            {
+                heap.Free(ptrs[i]);
+                freed++;
+            }
+            catch (const OAException& e)
+            {
+                if (SHOW_EXCEPTIONS)
+                    cout << e.what() << endl;
+                exceptions++;
+            }
+        }
+
+        OAStats stats = heap.GetStats();
+        cout << "Allocated: " << total << ", Freed: " << freed << ", Exceptions: " << exceptions << endl;
+        cout << "Objects in use: " << stats.ObjectsInUse_;
+        cout << ", Allocs: " << stats.Allocations_;
+        cout << ", Frees: " << stats.Deallocations_ << endl;
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestHeapRefill." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+// Compact moves the survivors of a churned pool onto as few pages as hold
+// them. The list is patched from the relocation map, then every survivor is
+// checked for its contents, its allocation number (kept by the move) and
+// its use count (that of the block it moved to, plus one).
+//
+// Expected output:
+//   Pages in use: 4, Objects in use: 6, Available objects: 10, Allocs: 32, Frees: 26
+//   Pages freed: 2, Objects moved: 2
+//   Pages in use: 2, Objects in use: 6, Available objects: 2, Allocs: 32, Frees: 26
+//   Faith      Ian       80000 10  alloc #17 uses 2
+//   Shrimpton  Mick      50000  4  alloc #20 uses 2
+//   St.Hubbins David     90000 12  alloc #23 uses 3  (moved)
+//   Upham      Denny     60000  5  alloc #26 uses 3  (moved)
+//   Schindler  Danny     60000  3  alloc #29 uses 2
+//   Fufkin     Artie     45000  1  alloc #32 uses 2
+//   List intact: yes, Corrupted blocks: 0
+//   Pages in use: 2, Objects in use: 0, Available objects: 8, Allocs: 32, Frees: 32
+void TestCompact(void)
+{
+    const unsigned count = 16;
+    ObjectAllocator* oa = 0;
+    try
+    {
+        OAConfig::HeaderBlockInfo header(OAConfig::hbExtended, 2);
+        OAConfig config(false, 4, 0, true, 2, header, 8);
+        oa = new ObjectAllocator(sizeof(Employee), config);
+
+        // every block is used twice, so a move shows in the use counts
+        Employee* employees[count];
+        for (unsigned i = 0; i < count; i++)
+            employees[i] = static_cast<Employee*>(oa->Allocate());
+        for (unsigned i = 0; i < count; i++)
+            oa->Free(employees[i]);
+        for (unsigned i = 0; i < count; i++)
+            employees[i] = static_cast<Employee*>(oa->Allocate());
+
+        // keep every third employee, linked in order
+        Employee* head = 0;
+        Employee** tail = &head;
+        for (unsigned i = 0; i < count; i++)
+        {
+            if (i % 3)
+            {
+                oa->Free(employees[i]);
+                continue;
+            }
+            std::strcpy(employees[i]->lastName, PEOPLE[i].lastName);
+            std::strcpy(employees[i]->firstName, PEOPLE[i].firstName);
+            employees[i]->salary = PEOPLE[i].salary;
+            employees[i]->years = PEOPLE[i].years;
+            *tail = employees[i];
+            tail = &employees[i]->Next;
+        }
+        *tail = 0;
+        PrintCounts(oa);
+
+        // the allocation number of each survivor before the move
+        const size_t headerSize = oa->GetConfig().HBlockInfo_.size_;
+        const size_t headerOffset = headerSize + oa->GetConfig().PadBytes_;
+        unsigned allocNums[count];
+        for (unsigned i = 0; i < count; i += 3)
+            std::memcpy(&allocNums[i], reinterpret_cast<unsigned char*>(employees[i]) - headerOffset + 4, sizeof(unsigned));
+
+        OARelocationMap moved;
+        unsigned freed = oa->Compact(ObjectAllocator::RecordRelocation, &moved);
+        cout << "Pages freed: " << freed << ", Objects moved: " << moved.size() << endl;
+        PrintCounts(oa);
+
+        if (moved.count(head))
+            head = static_cast<Employee*>(moved[head]);
+        for (Employee* e = head; e; e = e->Next)
+            if (moved.count(e->Next))
+                e->Next = static_cast<Employee*>(moved[e->Next]);
+
+        bool intact = true;
+        unsigned i = 0;
+        for (Employee* e = head; e; e = e->Next, i += 3)
+        {
+            const unsigned char* header = reinterpret_cast<unsigned char*>(e) - headerOffset;
+            unsigned short uses;
+            unsigned allocNum;
+            std::memcpy(&uses, header + 2, sizeof(uses));
+            std::memcpy(&allocNum, header + 4, sizeof(allocNum));
+            bool wasMoved = moved.count(employees[i]) != 0;
+            printf("%-10s %-8s %6.0f %2i  alloc #%-2u uses %u%s\n", e->lastName, e->firstName, e->salary, e->years,
+                   allocNum, uses, wasMoved ? "  (moved)" : "");
+
+            intact = intact && i < count && !std::strcmp(e->lastName, PEOPLE[i].lastName) &&
+                     !std::strcmp(e->firstName, PEOPLE[i].firstName) && e->salary == PEOPLE[i].salary &&
+                     e->years == PEOPLE[i].years && allocNum == allocNums[i] && uses == (wasMoved ? 3 : 2);
+        }
+        intact = intact && i == count + 2;
+        cout << "List intact: " << (intact ? "yes" : "no");
+        cout << ", Corrupted blocks: " << oa->ValidatePages(DumpCallback2) << endl;
+
+        while (head)
+        {
+            Employee* next = head->Next;
+            oa->Free(head);
+            head = next;
+        }
+        PrintCounts(oa);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestCompact." << endl;
+    }
+    delete oa;
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+const char* ExceptionName(OAException::OA_EXCEPTION code)
+{
+    const char* names[] = {"E_NO_MEMORY", "E_NO_PAGES", "E_BAD_BOUNDARY", "E_MULTIPLE_FREE", "E_CORRUPTED_BLOCK"};
+    return names[code];
+}
+
+void PrintTlsfCounts(const TlsfAllocator& tlsf)
+{
+    TlsfStats stats = tlsf.GetStats();
+    cout << "Pages in use: " << stats.PagesInUse_;
+    cout << ", Blocks in use: " << stats.ObjectsInUse_;
+    cout << ", Free blocks: " << stats.FreeObjects_;
+    cout << ", Free bytes: " << stats.FreeBytes_;
+    cout << ", Allocs: " << stats.Allocations_;
+    cout << ", Frees: " << stats.Deallocations_ << endl;
+}
+
+// Frees a block, printing the code of the exception thrown (if any)
+template <typename Allocator>
+void TryFree(Allocator& allocator, void* block, const char* what)
+{
+    cout << "Free " << what << ": ";
+    try
+    {
+        allocator.Free(block);
+        cout << "ok" << endl;
+    }
+    catch (const OAException& e)
+    {
+        cout << ExceptionName(e.code()) << endl;
+    }
+}
+
+// The TLSF allocator splits a free block to allocate, merges the blocks
+// freed next to each other, rejects bad frees with the codes of
+// ObjectAllocator, and gives back pages with nothing in use.
+//
+// Expected output:
+//   Pages in use: 1, Blocks in use: 0, Free blocks: 1, Free bytes: 4064, Allocs: 0, Frees: 0
+//   Allocate 24, 100 and 40 bytes (split)
+//   Pages in use: 1, Blocks in use: 3, Free blocks: 1, Free bytes: 3776, Allocs: 3, Frees: 0
+//   Requested bytes: 164, Room for 100: yes
+//   Free the 100 (a hole): ok
+//   Pages in use: 1, Blocks in use: 2, Free blocks: 2, Free bytes: 3904, Allocs: 3, Frees: 1
+//   Free the 24 (merged with the hole): ok
+//   Pages in use: 1, Blocks in use: 1, Free blocks: 2, Free bytes: 3968, Allocs: 3, Frees: 2
+//   Free the 40 (merged into one block): ok
+//   Pages in use: 1, Blocks in use: 0, Free blocks: 1, Free bytes: 4064, Allocs: 3, Frees: 3
+//   Free inside a block: E_BAD_BOUNDARY
+//   Free off every page: E_BAD_BOUNDARY
+//   Free the 32: ok
+//   Free the 32 again: E_MULTIPLE_FREE
+//   Overwrite the right pad, corrupted blocks: 1
+//   Free the corrupted block: E_CORRUPTED_BLOCK
+//   Free the repaired block: ok
+//   Allocate 8000 bytes (a page of its own)
+//   Pages in use: 2, Blocks in use: 1, Free blocks: 1, Free bytes: 4064, Allocs: 6, Frees: 5
+//   Free the 8000: ok
+//   Pages freed: 2
+//   Pages in use: 0, Blocks in use: 0, Free blocks: 0, Free bytes: 0, Allocs: 6, Frees: 6
+void TestTlsf(void)
+{
+    try
+    {
+        TlsfAllocator tlsf(OAConfig(false, 1, 0, true, 4), 4096);
+        PrintTlsfCounts(tlsf);
+
+        cout << "Allocate 24, 100 and 40 bytes (split)" << endl;
+        unsigned char* a = static_cast<unsigned char*>(tlsf.Allocate(24));
+        unsigned char* b = static_cast<unsigned char*>(tlsf.Allocate(100));
+        unsigned char* c = static_cast<unsigned char*>(tlsf.Allocate(40));
+        PrintTlsfCounts(tlsf);
+        cout << "Requested bytes: " << tlsf.GetStats().RequestedBytes_;
+        cout << ", Room for 100: " << (tlsf.GetUsableSize(b) >= 100 ? "yes" : "no") << endl;
+
+        TryFree(tlsf, b, "the 100 (a hole)");
+        PrintTlsfCounts(tlsf);
+        TryFree(tlsf, a, "the 24 (merged with the hole)");
+        PrintTlsfCounts(tlsf);
+        TryFree(tlsf, c, "the 40 (merged into one block)");
+        PrintTlsfCounts(tlsf);
+
+        unsigned char* d = static_cast<unsigned char*>(tlsf.Allocate(32));
+        TryFree(tlsf, d + 1, "inside a block");
+        int local;
+        TryFree(tlsf, &local, "off every page");
+        TryFree(tlsf, d, "the 32");
+        TryFree(tlsf, d, "the 32 again");
+
+        unsigned char* e = static_cast<unsigned char*>(tlsf.Allocate(32));
+        size_t usable = tlsf.GetUsableSize(e);
+        e[usable] = 0;
+        cout << "Overwrite the right pad, corrupted blocks: " << tlsf.ValidatePages(DumpCallback2) << endl;
+        TryFree(tlsf, e, "the corrupted block");
+        e[usable] = ObjectAllocator::PAD_PATTERN;
+        TryFree(tlsf, e, "the repaired block");
+
+        cout << "Allocate 8000 bytes (a page of its own)" << endl;
+        void* big = tlsf.Allocate(8000);
+        PrintTlsfCounts(tlsf);
+        TryFree(tlsf, big, "the 8000");
+        cout << "Pages freed: " << tlsf.FreeEmptyPages() << endl;
+        PrintTlsfCounts(tlsf);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestTlsf." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+// Every thread that uses a concurrent allocator gets magazines of its own.
+// They are emptied when the thread exits, so threads that come and go
+// reuse the same pages instead of stranding blocks in dead magazines.
+//
+// Expected output:
+//   After 1 thread: Pages in use: 2, Objects in use: 0, Available objects: 128
+//   After 500 threads: Pages in use: 2, Objects in use: 0, Available objects: 128
+//   Allocs: 50000, Frees: 50000
+void TestThreadChurn(void)
+{
+    try
+    {
+        ConcurrentObjectAllocator oa(sizeof(Student), OAConfig(false, 64, 0));
+        auto work = [&oa]() {
+            void* blocks[100];
+            for (int i = 0; i < 100; i++)
+                blocks[i] = oa.Allocate();
+            for (int i = 0; i < 100; i++)
+                oa.Free(blocks[i]);
+        };
+
+        const int threads = 500;
+        for (int i = 0; i < threads; i++)
+        {
+            std::thread thread(work);
+            thread.join();
+
+            if (i == 0 || i == threads - 1)
+            {
+                OAStats stats = oa.GetStats();
+                cout << "After " << i + 1 << (i ? " threads: " : " thread: ");
+                cout << "Pages in use: " << stats.PagesInUse_;
+                cout << ", Objects in use: " << stats.ObjectsInUse_;
+                cout << ", Available objects: " << stats.FreeObjects_ << endl;
+            }
+        }
+        OAStats stats = oa.GetStats();
+        cout << "Allocs: " << stats.Allocations_ << ", Frees: " << stats.Deallocations_ << endl;
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestThreadChurn." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+template <typename Allocator>
+void PrintTemplateCounts(const Allocator& oa)
+{
+    OAStats stats = oa.GetStats();
+    cout << "Pages in use: " << stats.PagesInUse_;
+    cout << ", Objects in use: " << stats.ObjectsInUse_;
+    cout << ", Available objects: " << stats.FreeObjects_;
+    cout << ", Allocs: " << stats.Allocations_;
+    cout << ", Frees: " << stats.Deallocations_ << endl;
+}
+
+// A debug policy compiles in the checks of a debug ObjectAllocator: frees
+// off a block boundary, double frees (found by the header flag, or by the
+// freed pattern without headers), corrupted padding and running out of
+// pages are reported, and leave the blocks and pages as they were.
+//
+// Expected output:
+//   Pages in use: 1, Objects in use: 2, Available objects: 2, Allocs: 2, Frees: 0
+//   Free inside a block: E_BAD_BOUNDARY
+//   Free off every page: E_BAD_BOUNDARY
+//   Free a block: ok
+//   Free it again (basic header): E_MULTIPLE_FREE
+//   Overwrite the left pad, corrupted blocks: 1
+//   Free the corrupted block: E_CORRUPTED_BLOCK
+//   Repair the left pad, corrupted blocks: 0
+//   Free the repaired block: ok
+//   Pages in use: 1, Objects in use: 0, Available objects: 4, Allocs: 2, Frees: 6
+//   Allocate every block of MaxPages pages
+//   Pages in use: 2, Objects in use: 8, Available objects: 0, Allocs: 10, Frees: 6
+//   Allocate one more: E_NO_PAGES
+//   Pages in use: 2, Objects in use: 8, Available objects: 0, Allocs: 10, Frees: 6
+//   Pages in use: 2, Objects in use: 0, Available objects: 8, Allocs: 10, Frees: 14
+//   Free a block: ok
+//   Free it again (no header): E_MULTIPLE_FREE
+//   Pages in use: 1, Objects in use: 0, Available objects: 4, Allocs: 1, Frees: 2
+void TestTemplatePolicies(void)
+{
+    try
+    {
+        typedef ObjectAllocatorT<sizeof(Student), OADebugPolicy<4, 2, 8> > BasicOA;
+        typedef ObjectAllocatorT<sizeof(Student), OAPolicy<4, 2, true, 8> > PlainOA;
+
+        BasicOA oa;
+        unsigned char* a = static_cast<unsigned char*>(oa.Allocate());
+        unsigned char* b = static_cast<unsigned char*>(oa.Allocate());
+        PrintTemplateCounts(oa);
+
+        TryFree(oa, a + 1, "inside a block");
+        int local;
+        TryFree(oa, &local, "off every page");
+        TryFree(oa, a, "a block");
+        TryFree(oa, a, "it again (basic header)");
+
+        b[-1] = 0;
+        cout << "Overwrite the left pad, corrupted blocks: " << oa.ValidatePages(DumpCallback2) << endl;
+        TryFree(oa, b, "the corrupted block");
+        b[-1] = ObjectAllocator::PAD_PATTERN;
+        cout << "Repair the left pad, corrupted blocks: " << oa.ValidatePages(DumpCallback2) << endl;
+        TryFree(oa, b, "the repaired block");
+        PrintTemplateCounts(oa);
+
+        cout << "Allocate every block of MaxPages pages" << endl;
+        void* blocks[8];
+        for (int i = 0; i < 8; i++)
+            blocks[i] = oa.Allocate();
+        PrintTemplateCounts(oa);
+        cout << "Allocate one more: ";
+        try
+        {
+            oa.Allocate();
+            cout << "ok" << endl;
+        }
+        catch (const OAException& e)
+        {
+            cout << ExceptionName(e.code()) << endl;
+        }
+        PrintTemplateCounts(oa);
+        for (int i = 0; i < 8; i++)
+            oa.Free(blocks[i]);
+        PrintTemplateCounts(oa);
+
+        PlainOA plain;
+        void* c = plain.Allocate();
+        TryFree(plain, c, "a block");
+        TryFree(plain, c, "it again (no header)");
+        PrintTemplateCounts(plain);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestTemplatePolicies." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+// With remote frees, threads other than the owner hand the blocks they free
+// to the owner, which frees them the next time it runs out of blocks (or
+// frees empty pages). The statistics only count them then. A bad block in a
+// chain is reported by the owner, and the rest of the chain is kept for the
+// next collection.
+//
+// Expected output:
+//   Pages in use: 2, Objects in use: 8, Available objects: 0, Allocs: 8, Frees: 0
+//   Free 5 blocks on another thread
+//   Pages in use: 2, Objects in use: 8, Available objects: 0, Allocs: 8, Frees: 0
+//   Allocate (collects them)
+//   Pages in use: 2, Objects in use: 4, Available objects: 4, Allocs: 9, Frees: 5
+//   Free 2 blocks and one off every page on another thread
+//   Free empty pages (collects them): E_BAD_BOUNDARY
+//   Pages in use: 2, Objects in use: 3, Available objects: 5, Allocs: 9, Frees: 7
+//   Free empty pages again, pages freed: 0
+//   Pages in use: 2, Objects in use: 2, Available objects: 6, Allocs: 9, Frees: 8
+//   Pages in use: 2, Objects in use: 0, Available objects: 8, Allocs: 9, Frees: 10
+void TestRemoteFrees(void)
+{
+    try
+    {
+        OAConfig config(false, 4, 0, true, 2);
+        config.RemoteFrees_ = true;
+        ObjectAllocator oa(sizeof(Student), config);
+
+        void* blocks[8];
+        for (int i = 0; i < 8; i++)
+            blocks[i] = oa.Allocate();
+        PrintCounts(&oa);
+
+        std::thread([&oa, &blocks]() {
+            for (int i = 0; i < 5; i++)
+                oa.Free(blocks[i]);
+        }).join();
+        cout << "Free 5 blocks on another thread" << endl;
+        PrintCounts(&oa);
+        void* extra = oa.Allocate();
+        cout << "Allocate (collects them)" << endl;
+        PrintCounts(&oa);
+
+        alignas(Student) unsigned char local[sizeof(Student)];
+        std::thread([&oa, &blocks, &local]() {
+            oa.Free(blocks[5]);
+            oa.Free(local);
+            oa.Free(blocks[6]);
+        }).join();
+        cout << "Free 2 blocks and one off every page on another thread" << endl;
+        cout << "Free empty pages (collects them): ";
+        try
+        {
+            oa.FreeEmptyPages();
+            cout << "ok" << endl;
+        }
+        catch (const OAException& e)
+        {
+            cout << ExceptionName(e.code()) << endl;
+        }
+        PrintCounts(&oa);
+        cout << "Free empty pages again, pages freed: " << oa.FreeEmptyPages() << endl;
+        PrintCounts(&oa);
+
+        oa.Free(blocks[7]);
+        oa.Free(extra);
+        PrintCounts(&oa);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestRemoteFrees." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+const void* DumpedBlocks[64];
+unsigned DumpedCount = 0;
+
+void RecordCallback(const void* block, size_t)
+{
+    if (DumpedCount < sizeof(DumpedBlocks) / sizeof(*DumpedBlocks))
+        DumpedBlocks[DumpedCount++] = block;
+}
+
+// Checks if a block is on one of the pages of an allocator
+bool OnPage(const ObjectAllocator* oa, const void* block)
+{
+    size_t pageSize = oa->GetStats().PageSize_;
+    const char* address = static_cast<const char*>(block);
+    for (const GenericObject* page = static_cast<const GenericObject*>(oa->GetPageList()); page; page = page->Next)
+    {
+        const char* start = reinterpret_cast<const char*>(page);
+        if (address >= start && address < start + pageSize)
+            return true;
+    }
+    return false;
+}
+
+// Guard sampling (POSIX only) puts one in every GuardSampleRate_
+// allocations between guard pages, off the pages of the allocator, if a
+// guard slot is free (the 12th block finds none). The guarded blocks are in use like any other, and
+// a double free of one is caught, even without debugging.
+//
+// Expected output:
+//   Allocate 12 blocks, guarded: 4 8
+//   Pages in use: 2, Objects in use: 12, Available objects: 6, Allocs: 12, Frees: 0
+//   Blocks in use: 12, guarded blocks among them: 2
+//   Free a guarded block: ok
+//   Free it again: E_MULTIPLE_FREE
+//   Pages in use: 2, Objects in use: 11, Available objects: 6, Allocs: 12, Frees: 2
+//   Allocate 4 more blocks (a slot is free), guarded: 16
+//   Pages in use: 2, Objects in use: 15, Available objects: 3, Allocs: 16, Frees: 2
+//   Pages in use: 2, Objects in use: 0, Available objects: 16, Allocs: 16, Frees: 17
+void TestGuardSampling(void)
+{
+    try
+    {
+        OAConfig config(false, 8, 0);
+        config.GuardSampleRate_ = 4;
+        config.GuardSlots_ = 2;
+        ObjectAllocator oa(sizeof(Student), config);
+
+        void* blocks[12];
+        cout << "Allocate 12 blocks, guarded:";
+        for (int i = 0; i < 12; i++)
+        {
+            blocks[i] = oa.Allocate();
+            if (!OnPage(&oa, blocks[i]))
+                cout << " " << i + 1;
+        }
+        cout << endl;
+        PrintCounts(&oa);
+
+        DumpedCount = 0;
+        unsigned inUse = oa.DumpMemoryInUse(RecordCallback);
+        unsigned guarded = 0;
+        for (unsigned i = 0; i < DumpedCount; i++)
+        {
+            if (DumpedBlocks[i] == blocks[3] || DumpedBlocks[i] == blocks[7])
+                guarded++;
+        }
+        cout << "Blocks in use: " << inUse << ", guarded blocks among them: " << guarded << endl;
+
+        TryFree(oa, blocks[3], "a guarded block");
+        TryFree(oa, blocks[3], "it again");
+        PrintCounts(&oa);
+
+        void* more[4];
+        cout << "Allocate 4 more blocks (a slot is free), guarded:";
+        for (int i = 0; i < 4; i++)
+        {
+            more[i] = oa.Allocate();
+            if (!OnPage(&oa, more[i]))
+                cout << " " << i + 13;
+        }
+        cout << endl;
+        PrintCounts(&oa);
+
+        for (int i = 0; i < 4; i++)
+            oa.Free(more[i]);
+        for (int i = 0; i < 12; i++)
+        {
+            if (i != 3)
+                oa.Free(blocks[i]);
+        }
+        PrintCounts(&oa);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestGuardSampling." << endl;
+    }
+}
+
+//****************************************************************************************************
+//****************************************************************************************************
+// Copies the free list of an allocator (up to max blocks); returns its length
+unsigned CopyFreeList(const ObjectAllocator* oa, const void** list, unsigned max)
+{
+    unsigned count = 0;
+    for (const GenericObject* block = static_cast<const GenericObject*>(oa->GetFreeList()); block; block = block->Next)
+    {
+        if (count < max)
+            list[count] = block;
+        count++;
+    }
+    return count;
+}
+
+// A batch takes every block it asks for or none: asking for more blocks
+// than MaxPages_ leaves room for throws E_NO_PAGES and leaves the
+// statistics and the free list as they were. A batch of frees stops at
+// the first bad block; the blocks before it stay freed.
+//
+// Expected output:
+//   Allocate a batch of 6
+//   Pages in use: 2, Objects in use: 6, Available objects: 2, Allocs: 6, Frees: 0
+//   Allocate a batch of 3 (2 left): E_NO_PAGES
+//   Pages in use: 2, Objects in use: 6, Available objects: 2, Allocs: 6, Frees: 0
+//   Free list unchanged: yes
+//   Allocate a batch of 2
+//   Pages in use: 2, Objects in use: 8, Available objects: 0, Allocs: 8, Frees: 0
+//   Free a batch of 3, the 2nd off a block boundary: E_BAD_BOUNDARY
+//   Pages in use: 2, Objects in use: 7, Available objects: 1, Allocs: 8, Frees: 2
+//   Free a batch of the 7 left
+//   Pages in use: 2, Objects in use: 0, Available objects: 8, Allocs: 8, Frees: 9
+void TestBatches(void)
+{
+    try
+    {
+        OAConfig config(false, 4, 2, true, 2);
+        ObjectAllocator oa(sizeof(Student), config);
+
+        void* blocks[8];
+        cout << "Allocate a batch of 6" << endl;
+        oa.AllocateBatch(6, blocks);
+        PrintCounts(&oa);
+
+        const void* before[8];
+        const void* after[8];
+        unsigned beforeCount = CopyFreeList(&oa, before, 8);
+        cout << "Allocate a batch of 3 (2 left): ";
+        try
+        {
+            oa.AllocateBatch(3, blocks + 6);
+            cout << "ok" << endl;
+        }
+        catch (const OAException& e)
+        {
+            cout << ExceptionName(e.code()) << endl;
+        }
+        PrintCounts(&oa);
+        unsigned afterCount = CopyFreeList(&oa, after, 8);
+        bool same = beforeCount == afterCount && std::memcmp(before, after, beforeCount * sizeof(*before)) == 0;
+        cout << "Free list unchanged: " << (same ? "yes" : "no") << endl;
+
+        cout << "Allocate a batch of 2" << endl;
+        oa.AllocateBatch(2, blocks + 6);
+        PrintCounts(&oa);
+
+        void* batch[3] = {blocks[0], static_cast<char*>(blocks[1]) + 1, blocks[2]};
+        cout << "Free a batch of 3, the 2nd off a block boundary: ";
+        try
+        {
+            oa.FreeBatch(batch, 3);
+            cout << "ok" << endl;
+        }
+        catch (const OAException& e)
+        {
+            cout << ExceptionName(e.code()) << endl;
+        }
+        PrintCounts(&oa);
+
+        cout << "Free a batch of the 7 left" << endl;
+        oa.FreeBatch(blocks + 1, 7);
+        PrintCounts(&oa);
+    }
+    catch (const OAException& e)
+    {
+        if (SHOW_EXCEPTIONS)
+            cout << e.what() << endl;
+        else
+            cout << "Exception thrown during TestBatches." << endl;
+    }
+}
 
 void PrintCounts(const ObjectAllocator* nm)
 {
@@ -2215,6 +2931,46 @@ int main(int argc, char** argv)
         cout << endl;
         break;
 #endif
+    case 22:
+        cout << "============================== Test small object heap with background refill..." << endl;
+        TestHeapRefill();
+        cout << endl;
+        break;
+    case 23:
+        cout << "============================== Test compact..." << endl;
+        TestCompact();
+        cout << endl;
+        break;
+    case 24:
+        cout << "============================== Test TLSF allocator..." << endl;
+        TestTlsf();
+        cout << endl;
+        break;
+    case 25:
+        cout << "============================== Test thread churn..." << endl;
+        TestThreadChurn();
+        cout << endl;
+        break;
+    case 26:
+        cout << "============================== Test allocator template policies..." << endl;
+        TestTemplatePolicies();
+        cout << endl;
+        break;
+    case 27:
+        cout << "============================== Test remote frees..." << endl;
+        TestRemoteFrees();
+        cout << endl;
+        break;
+    case 28:
+        cout << "============================== Test guard sampling..." << endl;
+        TestGuardSampling();
+        cout << endl;
+        break;
+    case 29:
+        cout << "============================== Test batches..." << endl;
+        TestBatches();
+        cout << endl;
+        break;
     default:
         cout << "============================== Students..." << endl;
         DoStudents(0, false);
@@ -2279,6 +3035,30 @@ int main(int argc, char** argv)
         cout << "============================== Test free empty pages 3..." << endl;
         TestFreeEmptyPages3(); 
         cout << endl;
+        cout << "============================== Test small object heap with background refill..." << endl;
+        TestHeapRefill();
+        cout << endl;
+        cout << "============================== Test compact..." << endl;
+        TestCompact();
+        cout << endl;
+        cout << "============================== Test TLSF allocator..." << endl;
+        TestTlsf();
+        cout << endl;
+        cout << "============================== Test thread churn..." << endl;
+        TestThreadChurn();
+        cout << endl;
+        cout << "============================== Test allocator template policies..." << endl;
+        TestTemplatePolicies();
+        cout << endl;
+        cout << "============================== Test remote frees..." << endl;
+        TestRemoteFrees();
+        cout << endl;
+        cout << "============================== Test guard sampling..." << endl;
+        TestGuardSampling();
+        cout << endl;
+        cout << "============================== Test batches..." << endl;
+        TestBatches();
+        cout << endl;
         break;
     }
 
@@ -31,7 +31,7 @@ BSTree<T>::BSTree(ObjectAllocator *oa, bool ShareOA)
   }
   else
   {
-    OAConfig config(true);
+    OAConfig config(false, BST_NODES_PER_PAGE, 0, false, 0, OAConfig::HeaderBlockInfo(), alignof(BinTreeNode));
     OA = new ObjectAllocator(sizeof(BinTreeNode), config);
     free_OA = true;
   }
@@ -56,7 +56,7 @@ BSTree<T>::BSTree(const BSTree &rhs)
   }
   else
   {
-    OAConfig config(true);
+    OAConfig config(false, BST_NODES_PER_PAGE, 0, false, 0, OAConfig::HeaderBlockInfo(), alignof(BinTreeNode));
     OA = new ObjectAllocator(sizeof(BinTreeNode), config);
     free_OA = true;
     share_OA = false;
@@ -170,7 +170,9 @@ void BSTree<T>::remove(const T &value)
 /******************************************************************************/
 /*!
 \brief
-  This function clears the BST.
+  This function clears the BST. A tree that is alone on an allocator of its
+  own drops every node at once with ResetAll, as long as its nodes need no
+  destructor; otherwise each node is freed.
 */
 /******************************************************************************/
 template <typename T>
@@ -178,7 +180,9 @@ void BSTree<T>::clear()
 {
   if (root_node)
   {
-    FreeTree(root_node);
+    bool dropped = free_OA && !share_OA && std::is_trivially_destructible<T>::value && OA->ResetAll();
+    if (!dropped)
+      FreeTree(root_node);
 
     root_node = nullptr;
     size_ = 0;
@@ -186,6 +190,43 @@ void BSTree<T>::clear()
   }
 }
 
+/******************************************************************************/
+/*!
+\brief
+  This function patches the links of the BST after ObjectAllocator::Compact
+  moved some of its nodes. The moves are recorded with
+  ObjectAllocator::RecordRelocation; only the new nodes are read.
+\param moved, the old and new address of every node moved.
+*/
+/******************************************************************************/
+template <typename T>
+void BSTree<T>::relocate(const OARelocationMap &moved)
+{
+  if (!moved.empty())
+    RelocateTree(root_node, moved);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function compacts the allocator of a BST that is alone on an
+  allocator of its own, and patches the links of the nodes moved. Nodes
+  are moved byte by byte, so this is only done when T allows it.
+\return the number of pages freed.
+*/
+/******************************************************************************/
+template <typename T>
+unsigned BSTree<T>::compact()
+{
+  if (!free_OA || share_OA || !std::is_trivially_copyable<T>::value)
+    return 0;
+
+  OARelocationMap moved;
+  unsigned freed = OA->Compact(ObjectAllocator::RecordRelocation, &moved);
+  relocate(moved);
+  return freed;
+}
+
 /******************************************************************************/
 /*!
 \brief
@@ -278,10 +319,7 @@ typename BSTree<T>::BinTree BSTree<T>::make_node(const T &value) const
 {
   try
   {
-    BinTree alloc = reinterpret_cast<BinTree>(OA->Allocate());
-
-    BinTree node = new (alloc) BinTreeNode(value);
-    return node;
+    return ObjectPool<BinTreeNode>(OA).emplace(value);
   }
   catch (const OAException &except)
   {
@@ -299,8 +337,7 @@ typename BSTree<T>::BinTree BSTree<T>::make_node(const T &value) const
 template <typename T>
 void BSTree<T>::free_node(BinTree node)
 {
-  node->~BinTreeNode();
-  OA->Free(node);
+  ObjectPool<BinTreeNode>(OA).destroy(node);
 }
 
 /******************************************************************************/
@@ -385,6 +422,29 @@ void BSTree<T>::FreeTree(BinTree tree)
   free_node(tree);
 }
 
+/******************************************************************************/
+/*!
+\brief
+  This function points a link, and the links below it, at the new address
+  of every node that was moved.
+\param tree, the link to patch.
+\param moved, the old and new address of every node moved.
+*/
+/******************************************************************************/
+template <typename T>
+void BSTree<T>::RelocateTree(BinTree &tree, const OARelocationMap &moved)
+{
+  if (tree == nullptr)
+    return;
+
+  auto it = moved.find(tree);
+  if (it != moved.end())
+    tree = static_cast<BinTree>(it->second);
+
+  RelocateTree(tree->left, moved);
+  RelocateTree(tree->right, moved);
+}
+
 /******************************************************************************/
 /*!
 \brief
@@ -14,10 +14,15 @@
 #ifndef BSTREE_H
 #define BSTREE_H
 //---------------------------------------------------------------------------
-#include <string>    // std::string
-#include <stdexcept> // std::exception
+#include <string>      // std::string
+#include <stdexcept>   // std::exception
+#include <type_traits> // std::is_trivially_destructible, std::is_trivially_copyable
 
 #include "ObjectAllocator.h"
+#include "ObjectPool.h"
+
+//! Nodes per page of the allocator a tree creates for itself
+static const unsigned BST_NODES_PER_PAGE = 256;
 
 /*!
   The exception class for the AVL/BST classes
@@ -103,6 +108,8 @@ class BSTree
     virtual void insert(const T& value);
     virtual void remove(const T& value);
     void clear();
+    void relocate(const OARelocationMap& moved);
+    unsigned compact();
     bool find(const T& value, unsigned &compares) const;
     bool empty() const;
     unsigned int size() const;
@@ -127,6 +134,7 @@ class BSTree
     // private stuff...
     void DeepCopyTree(const BinTree& source, BinTree& dest);
     void FreeTree(BinTree tree);
+    void RelocateTree(BinTree& tree, const OARelocationMap& moved);
     void InsertNode(BinTree& node, const T& value, int depth);
     void DeleteNode(BinTree& node, const T& value);
     bool FindNode(BinTree node, const T& value, unsigned& compares) const;
@@ -0,0 +1,528 @@
+/******************************************************************************/
+/*!
+\file   HandleBSTree.cpp
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 3
+\date   17 October 2026
+\brief
+  This file contains the implmentation for the HandleBSTree.
+*/
+/******************************************************************************/
+#include "HandleBSTree.h"
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor for a HandleBSTree.
+\param oa, the object allocator(OA) to use; it must hand out handles.
+\param ShareOA, this boolean decides whether this BST will share it's OA.
+*/
+/******************************************************************************/
+template <typename T>
+HandleBSTree<T>::HandleBSTree(ObjectAllocator *oa, bool ShareOA)
+    : root_node{0}, size_{0}
+{
+  if (oa)
+  {
+    OA = oa;
+    free_OA = false;
+  }
+  else
+  {
+    OA = MakeAllocator();
+    free_OA = true;
+  }
+  share_OA = ShareOA;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the copy constructor for a HandleBSTree.
+\param rhs, the other BST to copy.
+*/
+/******************************************************************************/
+template <typename T>
+HandleBSTree<T>::HandleBSTree(const HandleBSTree &rhs)
+{
+  if (rhs.share_OA)
+  {
+    OA = rhs.OA;
+    free_OA = false;
+    share_OA = true;
+  }
+  else
+  {
+    OA = MakeAllocator();
+    free_OA = true;
+    share_OA = false;
+  }
+
+  DeepCopyTree(rhs, rhs.root_node, root_node);
+  size_ = rhs.size_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor for a HandleBSTree.
+*/
+/******************************************************************************/
+template <typename T>
+HandleBSTree<T>::~HandleBSTree()
+{
+  clear();
+  if (free_OA)
+    delete OA;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the copy assignment operator for a HandleBSTree.
+\param rhs, the other BST to copy from.
+\return a reference to this BST.
+*/
+/******************************************************************************/
+template <typename T>
+HandleBSTree<T> &HandleBSTree<T>::operator=(const HandleBSTree &rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  if (rhs.share_OA)
+  {
+    if (free_OA)
+    {
+      clear();
+      delete OA;
+    }
+
+    OA = rhs.OA;
+    free_OA = false;
+    share_OA = true;
+  }
+
+  clear();
+  DeepCopyTree(rhs, rhs.root_node, root_node);
+  size_ = rhs.size_;
+
+  return *this;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This subcript operator returns the node at the given index.
+\param index, the index of the node to return.
+\return the node if given valid index, else returns nullptr.
+*/
+/******************************************************************************/
+template <typename T>
+const typename HandleBSTree<T>::BinTreeNode *HandleBSTree<T>::operator[](int index) const
+{
+  if (static_cast<unsigned>(index) >= size_)
+    return nullptr;
+  else
+    return get(FindNodeAtIndex(root_node, index));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function inserts a value into the BST.
+\param value, the data to insert.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::insert(const T &value)
+{
+  InsertNode(root_node, value);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function removes a value from the BST.
+\param value, the data to remove.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::remove(const T &value)
+{
+  DeleteNode(root_node, value);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function clears the BST. A tree that is alone on an allocator of its
+  own drops every node at once with ResetAll, as long as its nodes need no
+  destructor; otherwise each node is freed.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::clear()
+{
+  if (root_node)
+  {
+    bool dropped = free_OA && !share_OA && std::is_trivially_destructible<T>::value && OA->ResetAll();
+    if (!dropped)
+      FreeTree(root_node);
+
+    root_node = 0;
+    size_ = 0;
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds a value in the BST.
+\param value, the data to find.
+\param compares, the number of comparisons needed to find the value.
+*/
+/******************************************************************************/
+template <typename T>
+bool HandleBSTree<T>::find(const T &value, unsigned &compares) const
+{
+  return FindNode(root_node, value, compares);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns true if BST is empty.
+\return true if BST is empty, else false.
+*/
+/******************************************************************************/
+template <typename T>
+bool HandleBSTree<T>::empty() const
+{
+  return size_ == 0;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns size of BST.
+\return size of BST.
+*/
+/******************************************************************************/
+template <typename T>
+unsigned int HandleBSTree<T>::size() const
+{
+  return size_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns height of BST.
+\return height of BST.
+*/
+/******************************************************************************/
+template <typename T>
+int HandleBSTree<T>::height() const
+{
+  return tree_height(root_node);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the handle of the root node of BST.
+\return root node of BST (0 when empty).
+*/
+/******************************************************************************/
+template <typename T>
+typename HandleBSTree<T>::BinTree HandleBSTree<T>::root() const
+{
+  return root_node;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the node named by a handle of this BST, e.g. to
+  walk the tree from root().
+\param tree, the handle of the node.
+\return the node, or nullptr for handle 0.
+*/
+/******************************************************************************/
+template <typename T>
+const typename HandleBSTree<T>::BinTreeNode *HandleBSTree<T>::node(BinTree tree) const
+{
+  return get(tree);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function turns a handle into its node.
+\param tree, the handle of the node.
+\return the node, or nullptr for handle 0.
+*/
+/******************************************************************************/
+template <typename T>
+typename HandleBSTree<T>::BinTreeNode *HandleBSTree<T>::get(BinTree tree) const
+{
+  return static_cast<BinTreeNode *>(OA->ToPointer(tree));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  Given a value, this function creates a new node and returns it.
+\param value, to insert.
+\return new node of BST.
+*/
+/******************************************************************************/
+template <typename T>
+typename HandleBSTree<T>::BinTree HandleBSTree<T>::make_node(const T &value) const
+{
+  BinTree tree;
+  try
+  {
+    tree = OA->AllocateHandle();
+  }
+  catch (const OAException &except)
+  {
+    throw(BSTException(BSTException::E_NO_MEMORY, except.what()));
+  }
+
+  try
+  {
+    new (OA->ToPointer(tree)) BinTreeNode(value);
+  }
+  catch (...)
+  {
+    OA->FreeHandle(tree);
+    throw;
+  }
+  return tree;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  Given a node, this function frees it.
+\param tree, to free.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::free_node(BinTree tree)
+{
+  get(tree)->~BinTreeNode();
+  OA->FreeHandle(tree);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds the height of a tree.
+\param tree, to find the height of.
+\return the height.
+*/
+/******************************************************************************/
+template <typename T>
+int HandleBSTree<T>::tree_height(BinTree tree) const
+{
+  if (tree == 0)
+    return -1;
+
+  BinTreeNode *node = get(tree);
+  return std::max(tree_height(node->left), tree_height(node->right)) + 1;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function creates the allocator of a tree that is given none: pages
+  of BST_NODES_PER_PAGE nodes, with handles.
+\return the new allocator.
+*/
+/******************************************************************************/
+template <typename T>
+ObjectAllocator *HandleBSTree<T>::MakeAllocator() const
+{
+  // free blocks hold a pointer to the next one, so align them for it too
+  OAConfig config(false, BST_NODES_PER_PAGE, 0, false, 0, OAConfig::HeaderBlockInfo(),
+                  std::max(alignof(BinTreeNode), alignof(void *)));
+  config.Handles_ = true;
+  return new ObjectAllocator(sizeof(BinTreeNode), config);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function performs per node copying. The handles of the source tree
+  are turned into nodes by its own allocator, which may not be this one.
+\param from, the BST that owns the source tree.
+\param source, source tree.
+\param dest, destination tree.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::DeepCopyTree(const HandleBSTree &from, BinTree source, BinTree &dest)
+{
+  if (source == 0)
+    dest = 0;
+
+  else
+  {
+    const BinTreeNode *node = from.get(source);
+    dest = make_node(node->data);
+    get(dest)->count = node->count;
+    DeepCopyTree(from, node->left, get(dest)->left);
+    DeepCopyTree(from, node->right, get(dest)->right);
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function recursively frees a tree.
+\param tree to free.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::FreeTree(BinTree tree)
+{
+  if (tree == 0)
+    return;
+
+  FreeTree(get(tree)->left);
+  FreeTree(get(tree)->right);
+
+  free_node(tree);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function inserts a node. The counts on the way down are only raised
+  once the node is in, so a failed insert leaves the tree as it was.
+\param tree, link to insert at.
+\param value, value of the node.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::InsertNode(BinTree &tree, const T &value)
+{
+  if (tree == 0)
+  {
+    tree = make_node(value);
+    ++size_;
+    return;
+  }
+
+  BinTreeNode *node = get(tree);
+  if (value < node->data)
+    InsertNode(node->left, value);
+  else
+    InsertNode(node->right, value);
+  ++node->count;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function deletes a node.
+\param tree, link to the node to delete.
+\param value, value of the node.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleBSTree<T>::DeleteNode(BinTree &tree, const T &value)
+{
+  if (tree == 0)
+    return;
+
+  BinTreeNode *node = get(tree);
+  unsigned before = size_;
+  if (value < node->data)
+    DeleteNode(node->left, value);
+  else if (node->data < value)
+    DeleteNode(node->right, value);
+  else if (node->left == 0)
+  {
+    BinTree tmp = tree;
+    tree = node->right;
+    free_node(tmp);
+    --size_;
+    return;
+  }
+  else if (node->right == 0)
+  {
+    BinTree tmp = tree;
+    tree = node->left;
+    free_node(tmp);
+    --size_;
+    return;
+  }
+  else
+  {
+    BinTreeNode *pred = get(node->left);
+    while (pred->right)
+      pred = get(pred->right);
+    node->data = pred->data;
+    DeleteNode(node->left, node->data);
+  }
+
+  if (size_ != before)
+    --node->count;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds a node.
+\param tree, node to start from.
+\param value, value of the node to find.
+\param compares, number of comparisons needed to find this node.
+*/
+/******************************************************************************/
+template <typename T>
+bool HandleBSTree<T>::FindNode(BinTree tree, const T &value, unsigned &compares) const
+{
+  ++compares;
+
+  if (tree == 0)
+    return false;
+
+  BinTreeNode *node = get(tree);
+  if (value == node->data)
+    return true;
+  else if (value < node->data)
+    return FindNode(node->left, value, compares);
+  else
+    return FindNode(node->right, value, compares);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds a node at a given index.
+\param tree, node to find.
+\param index, index of the node.
+*/
+/******************************************************************************/
+template <typename T>
+typename HandleBSTree<T>::BinTree HandleBSTree<T>::FindNodeAtIndex(BinTree tree, unsigned index) const
+{
+  if (tree == 0)
+    return 0;
+
+  BinTreeNode *node = get(tree);
+  unsigned int left_count = node->left ? get(node->left)->count : 0;
+
+  if (left_count > index)
+    return FindNodeAtIndex(node->left, index);
+  else if (left_count < index)
+    return FindNodeAtIndex(node->right, index - left_count - 1);
+  else
+    return tree;
+}
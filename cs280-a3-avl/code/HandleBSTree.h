@@ -0,0 +1,86 @@
+/******************************************************************************/
+/*!
+\file   HandleBSTree.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 3
+\date   17 October 2026
+\brief
+  This file contains the declarations for the HandleBSTree, a BSTree whose
+  nodes link to each other by 32-bit allocator handles.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef HANDLEBSTREE_H
+#define HANDLEBSTREE_H
+//---------------------------------------------------------------------------
+#include <new> // placement new
+
+#include "BSTree.h"
+
+/*!
+  The definition of the BST with handle links. It works like BSTree, but a
+  link is an OAHandle of the allocator instead of a pointer, so on 64-bit
+  builds a node of ints takes 16 bytes instead of 32. The allocator must
+  hand out handles (OAConfig::Handles_); the one a tree creates for itself
+  does.
+*/
+template <typename T>
+class HandleBSTree
+{
+  public:
+    //! The node structure
+    struct BinTreeNode
+    {
+      OAHandle left;  //!< The left child (0 for none)
+      OAHandle right; //!< The right child (0 for none)
+      unsigned count; //!< nodes in this subtree for efficient indexing
+      T data;         //!< The data
+
+      //! Conversion constructor
+      BinTreeNode(const T& value) : left(0), right(0), count(1), data(value) {};
+    };
+
+    //! shorthand
+    using BinTree = OAHandle;
+
+    HandleBSTree(ObjectAllocator *oa = 0, bool ShareOA = false);
+    HandleBSTree(const HandleBSTree& rhs);
+    ~HandleBSTree();
+    HandleBSTree& operator=(const HandleBSTree& rhs);
+    const BinTreeNode* operator[](int index) const;
+    void insert(const T& value);
+    void remove(const T& value);
+    void clear();
+    bool find(const T& value, unsigned &compares) const;
+    bool empty() const;
+    unsigned int size() const;
+    int height() const;
+    BinTree root() const;
+    const BinTreeNode* node(BinTree tree) const;
+
+  private:
+    BinTreeNode* get(BinTree tree) const;
+    BinTree make_node(const T& value) const;
+    void free_node(BinTree tree);
+    int tree_height(BinTree tree) const;
+    ObjectAllocator* MakeAllocator() const;
+    void DeepCopyTree(const HandleBSTree& from, BinTree source, BinTree& dest);
+    void FreeTree(BinTree tree);
+    void InsertNode(BinTree& tree, const T& value);
+    void DeleteNode(BinTree& tree, const T& value);
+    bool FindNode(BinTree tree, const T& value, unsigned& compares) const;
+    BinTree FindNodeAtIndex(BinTree tree, unsigned index) const;
+
+    BinTree root_node;
+    unsigned int size_;
+    ObjectAllocator* OA;
+    bool free_OA;
+    bool share_OA;
+};
+
+#include "HandleBSTree.cpp"
+
+#endif
+//---------------------------------------------------------------------------
@@ -1,6 +1,6 @@
 #include "ObjectAllocator.h"
 
-ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig& config) : Config_(config)
+ObjectAllocator::ObjectAllocator(size_t ObjectSize, const OAConfig& config) : Config_(config), Blocks_(1)
 {
 	ObjectSize_ = ObjectSize;
 }
@@ -15,3 +15,56 @@ void ObjectAllocator::Free(void *anObject) throw(OAException)
 	// Defer to C++ heap manager
 	delete [] reinterpret_cast<char *>(anObject);
 }
+
+bool ObjectAllocator::ResetAll(bool)
+{
+	// Objects come from the C++ heap, so they can only be freed one at a time
+	return false;
+}
+
+unsigned ObjectAllocator::Compact(RELOCATECALLBACK, void *)
+{
+	// Objects come from the C++ heap, which can't move them
+	return 0;
+}
+
+void ObjectAllocator::RecordRelocation(const void *OldAddress, void *NewAddress, void *Map)
+{
+	(*static_cast<OARelocationMap *>(Map))[OldAddress] = NewAddress;
+}
+
+OAHandle ObjectAllocator::AllocateHandle() throw(OAException)
+{
+	// Objects come from the C++ heap, so a handle indexes a table of them
+	void *object = Allocate();
+	if (FreeHandles_.empty())
+	{
+		try
+		{
+			Blocks_.push_back(object);
+		}
+		catch (std::bad_alloc &)
+		{
+			Free(object);
+			throw OAException(OAException::E_NO_MEMORY, "AllocateHandle: No system memory available!");
+		}
+		return static_cast<OAHandle>(Blocks_.size() - 1);
+	}
+
+	OAHandle handle = FreeHandles_.back();
+	FreeHandles_.pop_back();
+	Blocks_[handle] = object;
+	return handle;
+}
+
+void ObjectAllocator::FreeHandle(OAHandle Handle) throw(OAException)
+{
+	Free(Blocks_[Handle]);
+	Blocks_[Handle] = 0;
+	FreeHandles_.push_back(Handle);
+}
+
+void *ObjectAllocator::ToPointer(OAHandle Handle) const
+{
+	return Blocks_[Handle];
+}
@@ -9,6 +9,7 @@
 #include <cstring>
 #include "BSTree.h"
 #include "AVLTree.h"
+#include "HandleBSTree.h"
 #include "PRNG.h"
 #include "ObjectAllocator.h"
 
@@ -776,6 +777,239 @@ void TestStrings(void)
   }
 }
 
+// The values of a tree in order, by subscript
+template <typename T>
+std::string InOrder(const T &tree)
+{
+  std::stringstream values;
+  for (unsigned i = 0; i < tree.size(); i++)
+    values << (i ? " " : "") << tree[i]->data;
+  return values.str();
+}
+
+// Do both trees have the same shape and values? (compares every find from low to high)
+template <typename T, typename U>
+bool SameTree(const T &tree1, const U &tree2, int low, int high)
+{
+  if (tree1.size() != tree2.size() || tree1.height() != tree2.height())
+    return false;
+  for (unsigned i = 0; i < tree1.size(); i++)
+    if (tree1[i]->data != tree2[i]->data)
+      return false;
+  for (int value = low; value <= high; value++)
+  {
+    unsigned compares1 = 0, compares2 = 0;
+    if (tree1.find(value, compares1) != tree2.find(value, compares2) || compares1 != compares2)
+      return false;
+  }
+  return true;
+}
+
+/*
+  Expected output:
+
+  ====================== TestHandleTree - insert/remove/find/clear/grow ======================
+  height: 5, nodes: 10, in order: 0 1 2 3 4 5 6 7 8 9
+  Value 3 found with 3 compares
+  Value 50 NOT found with 4 compares
+  same as BSTree: yes
+  removed odd values
+  height: 3, nodes: 5, in order: 0 2 4 6 8
+  same as BSTree: yes
+  cleared
+  tree is empty
+  grown to 1000 nodes, more than the 256 of a page
+  height: 25, in order: yes
+  same as BSTree: yes
+  copy same as original: yes
+  removed all values
+  tree is empty
+*/
+void TestHandleTree(void)
+{
+  const char *test = "TestHandleTree - insert/remove/find/clear/grow";
+  std::cout << "\n====================== " << test << " ======================\n";
+
+  try
+  {
+    HandleBSTree<int> tree;
+    BSTree<int> reference;
+    const int size = 10;
+    int vals[size];
+    GetValues(vals, size);
+    for (int i = 0; i < size; i++)
+    {
+      tree.insert(vals[i]);
+      reference.insert(vals[i]);
+    }
+    std::cout << "height: " << tree.height() << ", nodes: " << tree.size();
+    std::cout << ", in order: " << InOrder(tree) << std::endl;
+
+    int values[] = {3, 50};
+    for (int value : values)
+    {
+      unsigned compares = 0;
+      if (tree.find(value, compares))
+        std::cout << "Value " << value << " found with " << compares << " compares\n";
+      else
+        std::cout << "Value " << value << " NOT found with " << compares << " compares\n";
+    }
+    std::cout << "same as BSTree: " << (SameTree(tree, reference, -1, size) ? "yes" : "no") << std::endl;
+
+    for (int i = 0; i < size; i++)
+      if (vals[i] % 2)
+      {
+        tree.remove(vals[i]);
+        reference.remove(vals[i]);
+      }
+    std::cout << "removed odd values\n";
+    std::cout << "height: " << tree.height() << ", nodes: " << tree.size();
+    std::cout << ", in order: " << InOrder(tree) << std::endl;
+    std::cout << "same as BSTree: " << (SameTree(tree, reference, -1, size) ? "yes" : "no") << std::endl;
+
+    tree.clear();
+    reference.clear();
+    std::cout << "cleared\n";
+    std::cout << (tree.empty() && tree.root() == 0 ? "tree is empty\n" : "tree is NOT empty\n");
+
+    // more nodes than a page holds, so the allocator has to grow
+    const int grown = 1000;
+    std::vector<int> many(grown);
+    GetValues(&many[0], grown);
+    for (int value : many)
+    {
+      tree.insert(value);
+      reference.insert(value);
+    }
+    std::cout << "grown to " << tree.size() << " nodes, more than the " << BST_NODES_PER_PAGE << " of a page\n";
+    bool ordered = true;
+    for (int i = 0; i < grown; i++)
+      ordered = ordered && tree[i]->data == i;
+    std::cout << "height: " << tree.height() << ", in order: " << (ordered ? "yes" : "no") << std::endl;
+    std::cout << "same as BSTree: " << (SameTree(tree, reference, -1, grown) ? "yes" : "no") << std::endl;
+
+    HandleBSTree<int> copy(tree);
+    std::cout << "copy same as original: " << (SameTree(copy, tree, -1, grown) ? "yes" : "no") << std::endl;
+
+    for (int value : many)
+      tree.remove(value);
+    std::cout << "removed all values\n";
+    std::cout << (tree.empty() && tree.root() == 0 ? "tree is empty\n" : "tree is NOT empty\n");
+  }
+  catch (const BSTException &e)
+  {
+    std::cout << "Caught BSTException in " << test;
+    int value = e.code();
+    if (value == BSTException::E_NO_MEMORY)
+      std::cout << "E_NO_MEMORY" << std::endl;
+    else
+      std::cout << "Unknown error code." << std::endl;
+  }
+  catch (...)
+  {
+    std::cout << "Caught unknown exception in " << test << std::endl;
+  }
+}
+
+/*
+  The allocator of this driver can't move nodes, so the moves Compact would
+  make are made here: every node is copied to a new block, the old block is
+  wiped, and relocate must leave no link to it.
+
+  Expected output (BSTree; AVLTree prints the same lines, and its own
+  balanced tree):
+
+  ====================== TestRelocate - move every node/relocate ======================
+  BSTree
+  compact: 0 pages freed, same as before: yes
+  moved 10 nodes
+  links to old nodes: 0
+  same as before: yes
+              2
+
+    0                                       8
+
+         1         3                             9
+
+                             5
+
+                        4         6
+
+                                       7
+*/
+template <typename T>
+void TestRelocate(void)
+{
+  const char *test = "TestRelocate - move every node/relocate";
+  std::cout << "\n====================== " << test << " ======================\n";
+  std::cout << ReadableType(typeid(T).name()) << std::endl;
+
+  typedef typename T::BinTreeNode Node;
+  try
+  {
+    const int size = 10;
+    int vals[size];
+    GetValues(vals, size);
+    T reference;
+    T owner;
+    for (int i = 0; i < size; i++)
+    {
+      reference.insert(vals[i]);
+      owner.insert(vals[i]);
+    }
+    unsigned freed = owner.compact();
+    std::cout << "compact: " << freed << " pages freed, same as before: "
+              << (SameTree(owner, reference, -1, size) ? "yes" : "no") << std::endl;
+
+    ObjectAllocator oa(sizeof(Node), OAConfig());
+    T tree(&oa);
+    for (int i = 0; i < size; i++)
+      tree.insert(vals[i]);
+
+    OARelocationMap moved;
+    std::vector<Node *> old;
+    for (unsigned i = 0; i < tree.size(); i++)
+    {
+      Node *from = const_cast<Node *>(tree[i]);
+      void *to = oa.Allocate();
+      std::memcpy(to, from, sizeof(Node));
+      ObjectAllocator::RecordRelocation(from, to, &moved);
+      old.push_back(from);
+    }
+    tree.relocate(moved);
+    for (Node *node : old)
+    {
+      std::memset(static_cast<void *>(node), 0xCC, sizeof(Node));
+      oa.Free(node);
+    }
+    std::cout << "moved " << moved.size() << " nodes\n";
+
+    unsigned stale = 0;
+    for (unsigned i = 0; i < tree.size(); i++)
+    {
+      std::vector<const Node *> links = {tree[i], tree[i]->left, tree[i]->right};
+      for (const Node *link : links)
+        stale += link && std::find(old.begin(), old.end(), link) != old.end();
+    }
+    std::cout << "links to old nodes: " << stale << std::endl;
+    std::cout << "same as before: " << (SameTree(tree, reference, -1, size) ? "yes" : "no") << std::endl;
+    PrintBST(tree);
+  }
+  catch (const BSTException &e)
+  {
+    std::cout << "Caught BSTException in " << test;
+    int value = e.code();
+    if (value == BSTException::E_NO_MEMORY)
+      std::cout << "E_NO_MEMORY" << std::endl;
+    else
+      std::cout << "Unknown error code." << std::endl;
+  }
+  catch (...)
+  {
+    std::cout << "Caught unknown exception in " << test << std::endl;
+  }
+}
+
 //***********************************************************************
 //***********************************************************************
 //***********************************************************************
@@ -895,6 +1129,9 @@ int main(int argc, char **argv)
                        {TestStrings<BSTree<U> >,   1000,  500}, // 19 random insert strings/select
                        {TestStrings<AVLTree<U> >,  1000,  500}, // 20 random insert strings/select
                        {AVLStress,                10000, 3000}, // 21 stress avl only
+                       {TestHandleTree,            1000,  500}, // 22 handle links: insert/remove/find/clear/grow
+                       {TestRelocate<BSTree<T> >,  1000,  500}, // 23 move every node/relocate
+                       {TestRelocate<AVLTree<T> >, 1000,  500}, // 24 move every node/relocate
                       // {AVLStress<true>,                10000, 3000}, // 22 stress avl with balance factor
 
                       };
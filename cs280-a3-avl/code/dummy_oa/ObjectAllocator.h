@@ -7,7 +7,10 @@
 #pragma warning( disable : 4290 ) // suppress warning: C++ Exception Specification ignored
 #endif
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // If the client doesn't specify these:
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;  
@@ -83,6 +86,7 @@ struct OAConfig
 		HBlockInfo_ = HBInfo;
 		LeftAlignSize_ = 0;  
 		InterAlignSize_ = 0;
+		Handles_ = false;
 	}
 
 	bool UseCPPMemManager_;   // by-pass the functionality of the OA and use new/delete
@@ -95,8 +99,15 @@ struct OAConfig
 
 	unsigned LeftAlignSize_;  // number of alignment bytes required to align first block
 	unsigned InterAlignSize_; // number of alignment bytes required between remaining blocks
+	bool Handles_;            // name blocks by 32-bit handles (see AllocateHandle)
 };
 
+// Old address -> new address of the blocks moved by ObjectAllocator::Compact
+typedef std::unordered_map<const void *, void *> OARelocationMap;
+
+// A block named by a 32-bit number; 0 names no block
+typedef uint32_t OAHandle;
+
 struct MemBlockInfo
 {
 	bool in_use;        // Is the block free or in use?
@@ -107,12 +118,22 @@ struct MemBlockInfo
 class ObjectAllocator
 {
   public:
+    typedef void (*RELOCATECALLBACK)(const void *, void *, void *);
+
     ObjectAllocator(size_t ObjectSize, const OAConfig& config);
     void *Allocate() throw(OAException);
     void Free(void *Object) throw(OAException);
+    bool ResetAll(bool KeepPages = true);
+    OAHandle AllocateHandle() throw(OAException);
+    void FreeHandle(OAHandle Handle) throw(OAException);
+    void *ToPointer(OAHandle Handle) const;
+    unsigned Compact(RELOCATECALLBACK fn, void *Context = 0);
+    static void RecordRelocation(const void *OldAddress, void *NewAddress, void *Map);
   private:
   	OAConfig Config_;
 		size_t ObjectSize_;
+		std::vector<void *> Blocks_;        // Block of each handle; entry 0 is always null
+		std::vector<OAHandle> FreeHandles_; // Handles of freed blocks, reused first
 };
 
 #endif
@@ -189,6 +189,36 @@ void ChHashTable<T>::clear()
   stats.Count_ = 0;
 }
 
+/******************************************************************************/
+/*!
+\brief
+  This function points the chains at the new address of every node that
+  ObjectAllocator::Compact moved. Each link is patched before it is
+  followed, so only the new nodes are read.
+\param moved, the old and new address of every node moved.
+*/
+/******************************************************************************/
+template <typename T>
+void ChHashTable<T>::relocate(const OARelocationMap &moved)
+{
+  if (moved.empty())
+    return;
+
+  for (unsigned i = 0; i < stats.TableSize_; ++i)
+  {
+    ChHTNode **link = &head[i].Nodes;
+
+    while (*link)
+    {
+      auto it = moved.find(*link);
+      if (it != moved.end())
+        *link = static_cast<ChHTNode *>(it->second);
+
+      link = &(*link)->Next;
+    }
+  }
+}
+
 /******************************************************************************/
 /*!
 \brief
@@ -228,15 +258,7 @@ typename ChHashTable<T>::ChHTNode *ChHashTable<T>::make_node(const T &data)
 {
   try
   {
-    if (oa)
-    {
-      ChHTNode *alloc = reinterpret_cast<ChHTNode *>(oa->Allocate());
-      ChHTNode *node = new (alloc) ChHTNode(data);
-      return node;
-    }
-
-    ChHTNode *node = new ChHTNode(data);
-    return node;
+    return ObjectPool<ChHTNode>(oa).emplace(data);
   }
   catch (std::bad_alloc &e)
   {
@@ -248,7 +270,7 @@ typename ChHashTable<T>::ChHTNode *ChHashTable<T>::make_node(const T &data)
 /******************************************************************************/
 /*!
 \brief
-  This function frees a given node.
+  This function destroys a given node and frees it.
 \param ChHTNode*, the node to free.
 */
 /******************************************************************************/
@@ -259,10 +281,7 @@ void ChHashTable<T>::remove_node(ChHTNode *&node)
   if (config.FreeProc_)
     config.FreeProc_(node->Data);
 
-  if (oa)
-    oa->Free(node);
-  else
-    delete node;
+  ObjectPool<ChHTNode>(oa).destroy(node);
 }
 
 /******************************************************************************/
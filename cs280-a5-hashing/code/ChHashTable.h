@@ -17,6 +17,7 @@
 
 #include <string>
 #include "ObjectAllocator.h"
+#include "ObjectPool.h"
 #include "support.h"
 
 // client-provided hash function: takes a key and table size,
@@ -141,6 +142,10 @@ public:
   // Removes all items from the table (Doesn't deallocate table)
   void clear();
 
+  // Patches the chains after ObjectAllocator::Compact moved nodes of the table.
+  // The moves are recorded by ObjectAllocator::RecordRelocation.
+  void relocate(const OARelocationMap &moved);
+
   // Allow the client to peer into the data. Returns a struct that contains
   // information on the status of the table for debugging and testing.
   // The struct is defined in the header file.
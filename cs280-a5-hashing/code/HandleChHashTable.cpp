@@ -0,0 +1,353 @@
+/******************************************************************************/
+/*!
+\file   HandleChHashTable.cpp
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 4
+\date   17 October 2026
+\brief
+  This file contains the implementations for the HandleChHashTable.
+*/
+/******************************************************************************/
+#include "HandleChHashTable.h"
+#include <algorithm>
+#include <cmath>
+
+/******************************************************************************/
+/*!
+\brief
+  This is the constructor for a HandleChHashTable. Without an allocator,
+  the table makes one of its own that hands out handles.
+\param Config, hash table configuration settings.
+\param allocator, client object allocator; it must hand out handles.
+*/
+/******************************************************************************/
+template <typename T>
+HandleChHashTable<T>::HandleChHashTable(const HTConfig &Config, ObjectAllocator *allocator)
+    : oa{allocator}, free_oa{false}, config{Config}, head{nullptr}, stats{}
+{
+  if (!oa)
+  {
+    // free blocks hold a pointer to the next one, so align them for it too
+    OAConfig oaConfig(false, HT_NODES_PER_PAGE, 0, false, 0, OAConfig::HeaderBlockInfo(),
+                      std::max(alignof(ChHTNode), alignof(void *)));
+    oaConfig.Handles_ = true;
+    oa = new ObjectAllocator(sizeof(ChHTNode), oaConfig);
+    free_oa = true;
+  }
+
+  try
+  {
+    head = new ChHTHeadNode[config.InitialTableSize_];
+  }
+  catch (std::bad_alloc &)
+  {
+    if (free_oa)
+      delete oa;
+    throw(HashTableException(HashTableException::E_NO_MEMORY,
+                             "Unable to allocate memory!"));
+  }
+
+  stats.HashFunc_ = config.HashFunc_;
+  stats.Allocator_ = oa;
+  stats.TableSize_ = config.InitialTableSize_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This is the destructor for a HandleChHashTable.
+*/
+/******************************************************************************/
+template <typename T>
+HandleChHashTable<T>::~HandleChHashTable()
+{
+  clear();
+  delete[] head;
+  if (free_oa)
+    delete oa;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function inserts a data into the hash table with a key.
+\param Key, the key for the data.
+\param Data, the data to insert.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleChHashTable<T>::insert(const char *Key, const T &Data)
+{
+  const auto current_load_factor =
+      ((stats.Count_ + 1) / static_cast<double>(stats.TableSize_));
+
+  if (current_load_factor > config.MaxLoadFactor_)
+    grow_table();
+
+  unsigned index = config.HashFunc_(Key, stats.TableSize_);
+  ChHTHeadNode *table_head = &head[index];
+
+  ++stats.Probes_;
+
+  for (OAHandle list = table_head->Nodes; list; list = get(list)->Next)
+  {
+    ++stats.Probes_;
+
+    if (strncmp(Key, get(list)->Key, MAX_KEYLEN) == 0)
+      throw(HashTableException(HashTableException::E_DUPLICATE,
+                               "Trying to insert duplicate item!"));
+  }
+
+  OAHandle new_node = make_node(Key, Data);
+  get(new_node)->Next = table_head->Nodes;
+  table_head->Nodes = new_node;
+
+  ++table_head->Count;
+  ++stats.Count_;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function removes the data from the hash table with a given key.
+\param Key, the key for the data to remove.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleChHashTable<T>::remove(const char *Key)
+{
+  unsigned index = stats.HashFunc_(Key, stats.TableSize_);
+  ChHTHeadNode *table_head = &head[index];
+
+  for (OAHandle *link = &table_head->Nodes; *link; link = &get(*link)->Next)
+  {
+    ++stats.Probes_;
+
+    ChHTNode *current = get(*link);
+    if (strncmp(Key, current->Key, MAX_KEYLEN) == 0)
+    {
+      OAHandle node = *link;
+      *link = current->Next;
+      remove_node(node);
+
+      --table_head->Count;
+      --stats.Count_;
+      return;
+    }
+  }
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function finds a data from the hash table with a key.
+\returns the data if key is found, else a
+  HashTableException::E_ITEM_NOT_FOUND will be thrown.
+*/
+/******************************************************************************/
+template <typename T>
+const T &HandleChHashTable<T>::find(const char *Key) const
+{
+  unsigned index = stats.HashFunc_(Key, stats.TableSize_);
+
+  for (OAHandle list = head[index].Nodes; list;)
+  {
+    ++stats.Probes_;
+
+    const ChHTNode *current = get(list);
+    if (strncmp(Key, current->Key, MAX_KEYLEN) == 0)
+      return current->Data;
+
+    list = current->Next;
+  }
+
+  throw(HashTableException(HashTableException::E_ITEM_NOT_FOUND,
+                           "Key not found!"));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function clears the hash table.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleChHashTable<T>::clear()
+{
+  for (unsigned i = 0; i < stats.TableSize_; ++i)
+  {
+    OAHandle list = head[i].Nodes;
+
+    while (list)
+    {
+      OAHandle temp = get(list)->Next;
+      remove_node(list);
+      list = temp;
+    }
+
+    head[i].Nodes = 0;
+    head[i].Count = 0;
+  }
+
+  stats.Count_ = 0;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the Hash table's statistics.
+\returns HTStats, the stats of this Hash table.
+*/
+/******************************************************************************/
+template <typename T>
+HTStats HandleChHashTable<T>::GetStats() const
+{
+  return stats;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the table node.
+\returns ChHTHeadNode*, the head node of the table.
+*/
+/******************************************************************************/
+template <typename T>
+const typename HandleChHashTable<T>::ChHTHeadNode *HandleChHashTable<T>::GetTable() const
+{
+  return head;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function returns the node named by a handle of this table.
+\param Handle, the handle of the node (e.g. ChHTHeadNode::Nodes).
+\returns ChHTNode*, the node, or nullptr for handle 0.
+*/
+/******************************************************************************/
+template <typename T>
+const typename HandleChHashTable<T>::ChHTNode *HandleChHashTable<T>::node(OAHandle Handle) const
+{
+  return get(Handle);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function turns a handle into its node.
+\param handle, the handle of the node.
+\return ChHTNode*, the node, or nullptr for handle 0.
+*/
+/******************************************************************************/
+template <typename T>
+typename HandleChHashTable<T>::ChHTNode *HandleChHashTable<T>::get(OAHandle handle) const
+{
+  return static_cast<ChHTNode *>(oa->ToPointer(handle));
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function creates a new node with given key and data.
+\param Key, the key of the node.
+\param data, the data of the node.
+\return OAHandle, the handle of the new node.
+*/
+/******************************************************************************/
+template <typename T>
+OAHandle HandleChHashTable<T>::make_node(const char *Key, const T &data)
+{
+  OAHandle handle;
+  try
+  {
+    handle = oa->AllocateHandle();
+  }
+  catch (OAException &)
+  {
+    throw(HashTableException(HashTableException::E_NO_MEMORY,
+                             "Unable to allocate memory!"));
+  }
+
+  try
+  {
+    ChHTNode *node = new (oa->ToPointer(handle)) ChHTNode(data);
+    strncpy(node->Key, Key, MAX_KEYLEN);
+  }
+  catch (...)
+  {
+    oa->FreeHandle(handle);
+    throw;
+  }
+  return handle;
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function destroys a given node and frees it.
+\param node, the handle of the node to free.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleChHashTable<T>::remove_node(OAHandle node)
+{
+  ChHTNode *current = get(node);
+
+  if (config.FreeProc_)
+    config.FreeProc_(current->Data);
+
+  current->~ChHTNode();
+  oa->FreeHandle(node);
+}
+
+/******************************************************************************/
+/*!
+\brief
+  This function grows the size of the table. The nodes stay where they
+  are; only their links are rewritten.
+*/
+/******************************************************************************/
+template <typename T>
+void HandleChHashTable<T>::grow_table()
+{
+  unsigned old_table_size = stats.TableSize_;
+  double factor = std::ceil(stats.TableSize_ * config.GrowthFactor_);
+  unsigned new_table_size = GetClosestPrime(static_cast<unsigned>(factor));
+
+  ChHTHeadNode *new_table;
+  try
+  {
+    new_table = new ChHTHeadNode[new_table_size];
+  }
+  catch (std::bad_alloc &)
+  {
+    throw(HashTableException(HashTableException::E_NO_MEMORY,
+                             "Unable to allocate memory!"));
+  }
+
+  for (unsigned i = 0; i < old_table_size; ++i)
+  {
+    OAHandle list = head[i].Nodes;
+    while (list)
+    {
+      ++stats.Probes_;
+      ChHTNode *current = get(list);
+      OAHandle temp = current->Next;
+      unsigned index = stats.HashFunc_(current->Key, new_table_size);
+
+      current->Next = new_table[index].Nodes;
+      new_table[index].Nodes = list;
+      ++new_table[index].Count;
+
+      list = temp;
+    }
+  }
+
+  delete[] head;
+  head = new_table;
+  stats.TableSize_ = new_table_size;
+  ++stats.Expansions_;
+}
@@ -0,0 +1,101 @@
+/******************************************************************************/
+/*!
+\file   HandleChHashTable.h
+\author Ng Tian Kiat
+\par    email: tiankiat.ng\@digipen.edu
+\par    Course: CS280
+\par    Assignment 4
+\date   17 October 2026
+\brief
+  This file contains the declarations for the HandleChHashTable, a
+  ChHashTable whose chains link by 32-bit allocator handles.
+*/
+/******************************************************************************/
+//---------------------------------------------------------------------------
+#ifndef HANDLECHHASHTABLEH
+#define HANDLECHHASHTABLEH
+//---------------------------------------------------------------------------
+
+#include <cstring> // strncmp, strncpy
+#include <new>     // placement new
+#include "ChHashTable.h"
+
+// Nodes per page of the allocator a table creates for itself
+const unsigned HT_NODES_PER_PAGE = 256;
+
+// A ChHashTable whose chains link by OAHandle instead of by pointer, so on
+// 64-bit builds a node of ints takes 20 bytes instead of 24, and the slots
+// of the table take 8 bytes instead of 16. The allocator must hand out
+// handles (OAConfig::Handles_); the one a table creates for itself does.
+template <typename T>
+class HandleChHashTable
+{
+public:
+  typedef typename ChHashTable<T>::FREEPROC FREEPROC; // client-provided free proc (we own the data)
+  typedef typename ChHashTable<T>::HTConfig HTConfig; // same settings as ChHashTable
+
+  // Nodes that will hold the key/data pairs
+  struct ChHTNode
+  {
+    OAHandle Next;        // Next node of the chain (0 for none)
+    char Key[MAX_KEYLEN]; // Key is a string
+    T Data;               // Client data
+    ChHTNode(const T &data) : Next(0), Data(data){}; // constructor
+  };
+
+  // Each list has a special head handle
+  struct ChHTHeadNode
+  {
+    OAHandle Nodes;
+    ChHTHeadNode() : Nodes(0), Count(0){};
+    int Count; // For testing
+  };
+
+  // ObjectAllocator: must hand out handles (0: the table makes its own).
+  // Config: the configuration for the hash table.
+  HandleChHashTable(const HTConfig &Config, ObjectAllocator *allocator = 0);
+  ~HandleChHashTable();
+
+  // Nodes are named by handles of one allocator, so tables are not copied
+  HandleChHashTable(const HandleChHashTable &rhs) = delete;
+  HandleChHashTable &operator=(const HandleChHashTable &rhs) = delete;
+
+  // Insert a key/data pair into table. Throws an exception if the
+  // insertion is unsuccessful.(E_DUPLICATE, E_NO_MEMORY)
+  void insert(const char *Key, const T &Data);
+
+  // Delete an item by key.
+  void remove(const char *Key);
+
+  // Find and return data by key. throws exception if key doesn't exist.
+  // (E_ITEM_NOT_FOUND)
+  const T &find(const char *Key) const;
+
+  // Removes all items from the table (Doesn't deallocate table)
+  void clear();
+
+  // Allow the client to peer into the data, like ChHashTable. The chains
+  // are followed with node().
+  HTStats GetStats() const;
+  const ChHTHeadNode *GetTable() const;
+  const ChHTNode *node(OAHandle Handle) const;
+
+private:
+  // Private fields and methods...
+  ChHTNode *get(OAHandle handle) const;
+  OAHandle make_node(const char *Key, const T &data);
+  void remove_node(OAHandle node);
+  void grow_table();
+
+  ObjectAllocator *oa;
+  bool free_oa;
+  HTConfig config;
+
+  ChHTHeadNode *head;
+
+  mutable HTStats stats;
+};
+
+#include "HandleChHashTable.cpp"
+
+#endif
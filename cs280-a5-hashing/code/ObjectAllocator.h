@@ -3,7 +3,10 @@
 #define OBJECTALLOCATORH
 //---------------------------------------------------------------------------
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // If the client doesn't specify these:
 static const int DEFAULT_OBJECTS_PER_PAGE = 4;  
@@ -79,6 +82,7 @@ struct OAConfig
     HBlockInfo_ = HBInfo;
     LeftAlignSize_ = 0;  
     InterAlignSize_ = 0;
+    Handles_ = false;
   }
 
   bool UseCPPMemManager_;   // by-pass the functionality of the OA and use new/delete
@@ -91,8 +95,15 @@ struct OAConfig
 
   unsigned LeftAlignSize_;  // number of alignment bytes required to align first block
   unsigned InterAlignSize_; // number of alignment bytes required between remaining blocks
+  bool Handles_;            // name blocks by 32-bit handles (see AllocateHandle)
 };
 
+// Old address -> new address of the blocks moved by ObjectAllocator::Compact
+typedef std::unordered_map<const void *, void *> OARelocationMap;
+
+// A block named by a 32-bit number; 0 names no block
+typedef uint32_t OAHandle;
+
 struct MemBlockInfo
 {
   bool in_use;        // Is the block free or in use?
@@ -103,12 +114,21 @@ struct MemBlockInfo
 class ObjectAllocator
 {
   public:
+    typedef void (*RELOCATECALLBACK)(const void *, void *, void *);
+
     ObjectAllocator(size_t ObjectSize, const OAConfig& config);
     void *Allocate(const char *label = 0);
     void Free(void *Object);
+    OAHandle AllocateHandle(const char *label = 0);
+    void FreeHandle(OAHandle Handle);
+    void *ToPointer(OAHandle Handle) const;
+    unsigned Compact(RELOCATECALLBACK fn, void *Context = 0);
+    static void RecordRelocation(const void *OldAddress, void *NewAddress, void *Map);
   private:
     OAConfig Config_;
     size_t ObjectSize_;
+    std::vector<void *> Blocks_;        // Block of each handle; entry 0 is always null
+    std::vector<OAHandle> FreeHandles_; // Handles of freed blocks, reused first
 };
 
 #endif
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "ChHashTable.h"
+#include "HandleChHashTable.h"
 
 using std::cout;
 using std::endl;
@@ -813,6 +814,405 @@ void Test8(HashData *phd)
   delete oa;
 }
 
+template <typename T>
+void DumpTable(const HandleChHashTable<T> &ht)
+{
+  char buffer[80];
+  const typename HandleChHashTable<T>::ChHTHeadNode *head = ht.GetTable();
+
+  for (unsigned i = 0; i < ht.GetStats().TableSize_; i++)
+  {
+    const typename HandleChHashTable<T>::ChHTNode *start = ht.node(head[i].Nodes);
+    sprintf(buffer, "Slot: %3d ", i);
+    cout << buffer;
+    while (start)
+    {
+      sprintf(buffer, "--> %s ", start->Key);
+      cout << buffer;
+      start = ht.node(start->Next);
+    }
+    cout << endl;
+  }
+}
+
+template <typename T>
+void DumpStats(const HandleChHashTable<T> &ht, ostream &os = cout)
+{
+  os << "Number of probes: " << ht.GetStats().Probes_ << endl;
+  os << "Number of expansions: " << ht.GetStats().Expansions_ << endl;
+  os << "Items: " << ht.GetStats().Count_ << ", TableSize: " << ht.GetStats().TableSize_ << endl;
+  os << "Load factor: " << setprecision(3) << (double) ht.GetStats().Count_ / (double) ht.GetStats().TableSize_ << endl;
+}
+
+// Do both tables hold the same chains in the same order? (ChHashTable
+// counts probes differently while growing, so those aren't compared)
+template <typename T>
+bool SameTable(const ChHashTable<T> &ht, const HandleChHashTable<T> &hht)
+{
+  HTStats stats = ht.GetStats(), hstats = hht.GetStats();
+  if (stats.Count_ != hstats.Count_ || stats.TableSize_ != hstats.TableSize_ ||
+      stats.Expansions_ != hstats.Expansions_)
+    return false;
+
+  for (unsigned i = 0; i < stats.TableSize_; i++)
+  {
+    const typename ChHashTable<T>::ChHTNode *node = ht.GetTable()[i].Nodes;
+    const typename HandleChHashTable<T>::ChHTNode *hnode = hht.node(hht.GetTable()[i].Nodes);
+    int length = 0;
+    for (; node && hnode; node = node->Next, hnode = hht.node(hnode->Next), length++)
+      if (strcmp(node->Key, hnode->Key) || node->Data != hnode->Data)
+        return false;
+    if (node || hnode || hht.GetTable()[i].Count != length)
+      return false;
+  }
+  return true;
+}
+
+/*
+  Handle links: insert/grow/find/remove/clear
+
+  Expected output:
+
+  ==================== Test9 ====================
+
+  Creating tables:
+  Hash function: Universal Hash
+  Initial size: 3
+  Max load factor: 2
+  Growth factor: 2
+
+  Inserting 23 items...
+  Slot:   0 --> 105001
+  Slot:   1 --> 108001 --> 111001
+  Slot:   2 --> 114001
+  Slot:   3 --> 120001 --> 117001
+  Slot:   4 --> 123001
+  Slot:   5 --> 103001
+  Slot:   6 --> 106001
+  Slot:   7 --> 109001 --> 112001
+  Slot:   8 --> 115001
+  Slot:   9 --> 121001 --> 118001
+  Slot:  10 --> 101001
+  Slot:  11 --> 104001
+  Slot:  12 --> 107001 --> 110001
+  Slot:  13 --> 113001
+  Slot:  14 --> 116001
+  Slot:  15 --> 122001 --> 119001
+  Slot:  16 --> 102001
+  Number of probes: 56
+  Number of expansions: 2
+  Items: 23, TableSize: 17
+  Load factor: 1.35
+  Same as ChHashTable: yes
+
+  Finding 107001:
+  Key:   107001, Name:   St.Hubbins,        David
+  Salary:  90000, Years: 12
+  Finding 999001: E_ITEM_NOT_FOUND
+  Inserting 107001 again: E_DUPLICATE
+
+  Removing 10 items...
+  Slot:   0
+  Slot:   1 --> 108001
+  Slot:   2 --> 114001
+  Slot:   3 --> 120001
+  Slot:   4 --> 123001
+  Slot:   5
+  Slot:   6 --> 106001
+  Slot:   7 --> 112001
+  Slot:   8
+  Slot:   9 --> 121001 --> 118001
+  Slot:  10
+  Slot:  11 --> 104001
+  Slot:  12 --> 110001
+  Slot:  13
+  Slot:  14 --> 116001
+  Slot:  15 --> 122001
+  Slot:  16 --> 102001
+  Number of probes: 74
+  Number of expansions: 2
+  Items: 13, TableSize: 17
+  Load factor: 0.765
+  Same as ChHashTable: yes
+
+  Inserting 1000 more items (more than the 256 nodes of a page)...
+  Items: 1013, expansions: 7
+  Same as ChHashTable: yes
+
+  Clearing...
+  Items: 0, empty slots: yes
+  Same as ChHashTable: yes
+*/
+void Test9(HashData *phd)
+{
+  const char *test = "Test9";
+  cout << endl << "==================== " << test << " ====================" << endl;
+
+  HASHFUNC phf = phd->Fn;
+
+  unsigned initial_size = 3;
+  double max_load_factor = 2.0;
+  double growth_factor = 2.0;
+
+  cout << endl << "Creating tables:" << endl;
+  cout << "Hash function: " << phd->Name << endl;
+  cout << "Initial size: " << initial_size << endl;
+  cout << "Max load factor: " << max_load_factor << endl;
+  cout << "Growth factor: " << growth_factor << endl;
+
+  typedef Person * T;
+  ChHashTable<T> ht(ChHashTable<T>::HTConfig(initial_size, phf, max_load_factor, growth_factor, 0));
+  HandleChHashTable<T> hht(HandleChHashTable<T>::HTConfig(initial_size, phf, max_load_factor, growth_factor, 0));
+  try
+  {
+    unsigned count = sizeof(PEOPLE) / sizeof(*PEOPLE);
+    cout << "\nInserting " << count << " items...\n";
+    for (unsigned i = 0; i < count; i++)
+    {
+      ht.insert(PersonRecs[i]->ID, PersonRecs[i]);
+      hht.insert(PersonRecs[i]->ID, PersonRecs[i]);
+    }
+    DumpTable<T>(hht);
+    DumpStats<T>(hht);
+    cout << "Same as ChHashTable: " << (SameTable(ht, hht) ? "yes" : "no") << endl;
+
+    // the same calls are made on both tables, so their probes stay equal
+    cout << endl;
+    const char *keys[] = {"107001", "999001"};
+    for (const char *key : keys)
+    {
+      cout << "Finding " << key << ":";
+      try
+      {
+        ht.find(key);
+      }
+      catch (HashTableException &)
+      {
+      }
+      try
+      {
+        T person = hht.find(key);
+        cout << endl << *person << endl;
+      }
+      catch (HashTableException &e)
+      {
+        cout << (e.code() == HashTableException::E_ITEM_NOT_FOUND ? " E_ITEM_NOT_FOUND" : " Unknown error code.") << endl;
+      }
+    }
+    cout << "Inserting 107001 again:";
+    try
+    {
+      ht.insert("107001", 0);
+    }
+    catch (HashTableException &)
+    {
+    }
+    try
+    {
+      hht.insert("107001", 0);
+      cout << " inserted" << endl;
+    }
+    catch (HashTableException &e)
+    {
+      cout << (e.code() == HashTableException::E_DUPLICATE ? " E_DUPLICATE" : " Unknown error code.") << endl;
+    }
+
+    cout << "\nRemoving 10 items...\n";
+    for (unsigned i = 0; i < count; i += 2)
+      if (i < 20)
+      {
+        ht.remove(PersonRecs[i]->ID);
+        hht.remove(PersonRecs[i]->ID);
+      }
+    DumpTable<T>(hht);
+    DumpStats<T>(hht);
+    cout << "Same as ChHashTable: " << (SameTable(ht, hht) ? "yes" : "no") << endl;
+
+    char buf[10];
+    unsigned more = 1000;
+    cout << "\nInserting " << more << " more items (more than the " << HT_NODES_PER_PAGE << " nodes of a page)...\n";
+    for (unsigned i = 1; i <= more; i++)
+    {
+      sprintf(buf, "%09i", i);
+      ht.insert(buf, 0);
+      hht.insert(buf, 0);
+    }
+    cout << "Items: " << hht.GetStats().Count_ << ", expansions: " << hht.GetStats().Expansions_ << endl;
+    cout << "Same as ChHashTable: " << (SameTable(ht, hht) ? "yes" : "no") << endl;
+
+    cout << "\nClearing...\n";
+    ht.clear();
+    hht.clear();
+    bool empty = true;
+    for (unsigned i = 0; i < hht.GetStats().TableSize_; i++)
+      empty = empty && hht.GetTable()[i].Nodes == 0 && hht.GetTable()[i].Count == 0;
+    cout << "Items: " << hht.GetStats().Count_ << ", empty slots: " << (empty ? "yes" : "no") << endl;
+    cout << "Same as ChHashTable: " << (SameTable(ht, hht) ? "yes" : "no") << endl;
+  }
+  catch (HashTableException &e)
+  {
+    std::cout << "Caught HashTableException in " << test << ": ";
+    int value = e.code();
+    if (value == HashTableException::E_DUPLICATE)
+      std::cout << "E_DUPLICATE" << std::endl;
+    else if (value == HashTableException::E_NO_MEMORY)
+      std::cout << "E_NO_MEMORY" << std::endl;
+    else if (value == HashTableException::E_ITEM_NOT_FOUND)
+      std::cout << "E_ITEM_NOT_FOUND" << std::endl;
+    else
+      std::cout << "Unknown error code." << std::endl;
+  }
+  catch (...) 
+  {
+    cout << endl << "**** Something bad happened inserting in " << test << endl << endl;
+  }
+}
+
+/*
+  Relocate: the allocator of this driver can't move nodes, so the moves
+  Compact would make are made here. Every node is copied to a new block,
+  the old block is wiped, and relocate must leave no link to it.
+
+  Expected output:
+
+  ==================== Test10 ====================
+
+  Creating table:
+  Hash function: Universal Hash
+  Initial size: 7
+  Max load factor: 2
+  Growth factor: 2
+
+  Inserting 23 items...
+  Slot:   0 --> 105001
+  Slot:   1 --> 108001 --> 111001
+  Slot:   2 --> 114001
+  Slot:   3 --> 120001 --> 117001
+  Slot:   4 --> 123001
+  Slot:   5 --> 103001
+  Slot:   6 --> 106001
+  Slot:   7 --> 109001 --> 112001
+  Slot:   8 --> 115001
+  Slot:   9 --> 121001 --> 118001
+  Slot:  10 --> 101001
+  Slot:  11 --> 104001
+  Slot:  12 --> 107001 --> 110001
+  Slot:  13 --> 113001
+  Slot:  14 --> 116001
+  Slot:  15 --> 122001 --> 119001
+  Slot:  16 --> 102001
+
+  Moved 23 nodes
+  Links to old nodes: 0
+  Keys found with their data: 23 of 23
+  Slot:   0 --> 105001
+  Slot:   1 --> 108001 --> 111001
+  Slot:   2 --> 114001
+  Slot:   3 --> 120001 --> 117001
+  Slot:   4 --> 123001
+  Slot:   5 --> 103001
+  Slot:   6 --> 106001
+  Slot:   7 --> 109001 --> 112001
+  Slot:   8 --> 115001
+  Slot:   9 --> 121001 --> 118001
+  Slot:  10 --> 101001
+  Slot:  11 --> 104001
+  Slot:  12 --> 107001 --> 110001
+  Slot:  13 --> 113001
+  Slot:  14 --> 116001
+  Slot:  15 --> 122001 --> 119001
+  Slot:  16 --> 102001
+  Number of probes: 79
+  Number of expansions: 1
+  Items: 23, TableSize: 17
+  Load factor: 1.35
+*/
+void Test10(HashData *phd)
+{
+  const char *test = "Test10";
+  cout << endl << "==================== " << test << " ====================" << endl;
+
+  HASHFUNC phf = phd->Fn;
+
+  unsigned initial_size = 7;
+  double max_load_factor = 2.0;
+  double growth_factor = 2.0;
+
+  cout << endl << "Creating table:" << endl;
+  cout << "Hash function: " << phd->Name << endl;
+  cout << "Initial size: " << initial_size << endl;
+  cout << "Max load factor: " << max_load_factor << endl;
+  cout << "Growth factor: " << growth_factor << endl;
+
+  typedef Person * T;
+  typedef ChHashTable<T>::ChHTNode Node;
+
+  OAConfig config(true);
+  ObjectAllocator *oa = new ObjectAllocator(sizeof(Node), config);
+  ChHashTable<T> *ht = new ChHashTable<T>(ChHashTable<T>::HTConfig(initial_size, phf, max_load_factor, growth_factor, 0), oa);
+  try
+  {
+    unsigned count = sizeof(PEOPLE) / sizeof(*PEOPLE);
+    cout << "\nInserting " << count << " items...\n";
+    for (unsigned i = 0; i < count; i++)
+      ht->insert(PersonRecs[i]->ID, PersonRecs[i]);
+    DumpTable<T>(*ht);
+
+    OARelocationMap moved;
+    Node *old[sizeof(PEOPLE) / sizeof(*PEOPLE)];
+    unsigned nodes = 0;
+    for (unsigned i = 0; i < ht->GetStats().TableSize_; i++)
+      for (const Node *node = ht->GetTable()[i].Nodes; node; node = node->Next)
+      {
+        void *to = oa->Allocate();
+        memcpy(to, node, sizeof(Node));
+        ObjectAllocator::RecordRelocation(node, to, &moved);
+        old[nodes++] = const_cast<Node *>(node);
+      }
+    ht->relocate(moved);
+    for (unsigned i = 0; i < nodes; i++)
+    {
+      memset(static_cast<void *>(old[i]), 0xCC, sizeof(Node));
+      oa->Free(old[i]);
+    }
+    cout << "\nMoved " << moved.size() << " nodes\n";
+
+    unsigned stale = 0;
+    for (unsigned i = 0; i < ht->GetStats().TableSize_; i++)
+      for (const Node *node = ht->GetTable()[i].Nodes; node; node = node->Next)
+        for (unsigned j = 0; j < nodes; j++)
+          stale += node == old[j];
+    cout << "Links to old nodes: " << stale << endl;
+
+    unsigned found = 0;
+    for (unsigned i = 0; i < count; i++)
+      found += ht->find(PersonRecs[i]->ID) == PersonRecs[i];
+    cout << "Keys found with their data: " << found << " of " << count << endl;
+    DumpTable<T>(*ht);
+    DumpStats<T>(*ht);
+  }
+  catch (HashTableException &e)
+  {
+    std::cout << "Caught HashTableException in " << test << ": ";
+    int value = e.code();
+    if (value == HashTableException::E_DUPLICATE)
+      std::cout << "E_DUPLICATE" << std::endl;
+    else if (value == HashTableException::E_NO_MEMORY)
+      std::cout << "E_NO_MEMORY" << std::endl;
+    else if (value == HashTableException::E_ITEM_NOT_FOUND)
+      std::cout << "E_ITEM_NOT_FOUND" << std::endl;
+    else
+      std::cout << "Unknown error code." << std::endl;
+  }
+  catch (...) 
+  {
+    cout << endl << "**** Something bad happened inserting in " << test << endl << endl;
+  }
+
+  delete ht;
+  delete oa;
+}
+
 int main(int argc, char **argv)
 {
   FillPersonRecs();
@@ -860,6 +1260,14 @@ int main(int argc, char **argv)
       Test8(&HashingFuncs[hf]); // stress
       break;
 
+    case 9:
+      Test9(&HashingFuncs[hf]); // handle links: insert/grow/find/remove/clear
+      break;
+
+    case 10:
+      Test10(&HashingFuncs[hf]); // move every node/relocate
+      break;
+
     default:
       Test1(&HashingFuncs[hf]); // insert
       Test2(&HashingFuncs[hf]); // insert/delete
@@ -869,6 +1277,8 @@ int main(int argc, char **argv)
       Test6(&HashingFuncs[hf]); // insert clear
       Test7(&HashingFuncs[hf]); // small stress with allocator
       Test8(&HashingFuncs[hf]); // stress
+      Test9(&HashingFuncs[hf]); // handle links: insert/grow/find/remove/clear
+      Test10(&HashingFuncs[hf]); // move every node/relocate
       break;
   }
 